@@ -0,0 +1,186 @@
+/**
+  ******************************************************************************
+  * @file    dma_memory_copier.cpp
+  * @brief   This file provides the DMA backend of the weight streaming
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dma_memory_copier.h"
+#include "stm32f7xx_hal.h"
+
+
+/* Private variables ---------------------------------------------------------*/
+namespace
+{
+    constexpr uint32_t kCacheLineSize = 32;
+
+    // The NDTR register of a stream counts 16 bits.
+    constexpr size_t kMaxChunkTransfers = 65535;
+
+    DMA_HandleTypeDef dma_handle;
+    DmaMemoryCopier* active_copier = nullptr;
+
+    void transfer_complete(DMA_HandleTypeDef* handle)
+    {
+        active_copier->OnTransferDone(false);
+    }
+
+    void transfer_error(DMA_HandleTypeDef* handle)
+    {
+        active_copier->OnTransferDone(true);
+    }
+
+    // Writes the cached source data to memory before the DMA reads it, e.g. a
+    // model the CPU copied to SDRAM.
+    void clean_dcache(const void* address, size_t bytes)
+    {
+        const uint32_t start = reinterpret_cast<uint32_t>(address) & ~(kCacheLineSize - 1);
+        const uint32_t end = reinterpret_cast<uint32_t>(address) + bytes;
+        SCB_CleanDCache_by_Addr(reinterpret_cast<uint32_t*>(start), end - start);
+    }
+} // namespace
+
+
+extern "C" void DMA2_Stream0_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&dma_handle);
+}
+
+
+/* Public functions ----------------------------------------------------------*/
+TfLiteStatus DmaMemoryCopier::Init()
+{
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    // Memory to memory transfers only work on DMA2. The burst size stays
+    // single, so a transfer never crosses a 1 KB boundary in a burst.
+    dma_handle.Instance = DMA2_Stream0;
+    dma_handle.Init.Channel = DMA_CHANNEL_0;
+    dma_handle.Init.Direction = DMA_MEMORY_TO_MEMORY;
+    dma_handle.Init.PeriphInc = DMA_PINC_ENABLE;
+    dma_handle.Init.MemInc = DMA_MINC_ENABLE;
+    dma_handle.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    dma_handle.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    dma_handle.Init.Mode = DMA_NORMAL;
+    dma_handle.Init.Priority = DMA_PRIORITY_LOW;
+    dma_handle.Init.FIFOMode = DMA_FIFOMODE_ENABLE;
+    dma_handle.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+    dma_handle.Init.MemBurst = DMA_MBURST_SINGLE;
+    dma_handle.Init.PeriphBurst = DMA_PBURST_SINGLE;
+    if (HAL_DMA_Init(&dma_handle) != HAL_OK)
+    {
+        return kTfLiteError;
+    }
+    dma_handle.XferCpltCallback = transfer_complete;
+    dma_handle.XferErrorCallback = transfer_error;
+    active_copier = this;
+
+    HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+    return kTfLiteOk;
+}
+
+TfLiteStatus DmaMemoryCopier::StartCopy(void* destination, const void* source, size_t bytes)
+{
+    if (bytes == 0)
+    {
+        return kTfLiteOk;
+    }
+    if (count_ == kMaxCopies)
+    {
+        TF_LITE_ENSURE_STATUS(Wait());
+    }
+
+    clean_dcache(source, bytes);
+    // No dirty line of the destination may be evicted over the copied data.
+    SCB_CleanInvalidateDCache_by_Addr(static_cast<uint32_t*>(destination), bytes);
+
+    __disable_irq();
+    Copy& copy = copies_[(first_ + count_) % kMaxCopies];
+    copy.destination = static_cast<uint8_t*>(destination);
+    copy.source = static_cast<const uint8_t*>(source);
+    copy.bytes = bytes;
+    copy.copied = 0;
+    count_ = count_ + 1;
+    const bool start = !busy_;
+    busy_ = true;
+    __enable_irq();
+
+    if (start)
+    {
+        StartChunk();
+    }
+    return kTfLiteOk;
+}
+
+TfLiteStatus DmaMemoryCopier::Wait()
+{
+    while (busy_)
+    {
+    }
+    if (failed_)
+    {
+        failed_ = false;
+        return kTfLiteError;
+    }
+    return kTfLiteOk;
+}
+
+void DmaMemoryCopier::OnTransferDone(bool failed)
+{
+    if (failed)
+    {
+        failed_ = true;
+        count_ = 0;
+        busy_ = false;
+        return;
+    }
+
+    Copy& copy = copies_[first_];
+    copy.copied += chunk_bytes_;
+    if (copy.copied == copy.bytes)
+    {
+        // Drops the lines the CPU may have fetched speculatively meanwhile.
+        SCB_InvalidateDCache_by_Addr(reinterpret_cast<uint32_t*>(copy.destination), copy.bytes);
+        first_ = (first_ + 1) % kMaxCopies;
+        count_ = count_ - 1;
+    }
+    if (count_ > 0)
+    {
+        StartChunk();
+    }
+    else
+    {
+        busy_ = false;
+    }
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+void DmaMemoryCopier::StartChunk()
+{
+    const Copy& copy = copies_[first_];
+    const uint32_t source = reinterpret_cast<uint32_t>(copy.source + copy.copied);
+    const uint32_t destination = reinterpret_cast<uint32_t>(copy.destination + copy.copied);
+    const size_t remaining = copy.bytes - copy.copied;
+
+    // Words when everything is word aligned, bytes otherwise. The stream is
+    // disabled between transfers, so its data size can be changed.
+    const bool words = ((source | destination | remaining) & 3) == 0;
+    const size_t transfer_size = words ? 4 : 1;
+    MODIFY_REG(dma_handle.Instance->CR, DMA_SxCR_PSIZE | DMA_SxCR_MSIZE,
+               words ? (DMA_PDATAALIGN_WORD | DMA_MDATAALIGN_WORD)
+                     : (DMA_PDATAALIGN_BYTE | DMA_MDATAALIGN_BYTE));
+    size_t transfers = remaining / transfer_size;
+    if (transfers > kMaxChunkTransfers)
+    {
+        transfers = kMaxChunkTransfers;
+    }
+    chunk_bytes_ = transfers * transfer_size;
+
+    if (HAL_DMA_Start_IT(&dma_handle, source, destination, transfers) != HAL_OK)
+    {
+        OnTransferDone(true);
+    }
+}
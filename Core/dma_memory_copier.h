@@ -0,0 +1,59 @@
+/**
+  ******************************************************************************
+  * @file    dma_memory_copier.h
+  * @brief   Header file for the DMA backend of the weight streaming
+  ******************************************************************************
+  */
+
+#ifndef DMA_MEMORY_COPIER_H_
+#define DMA_MEMORY_COPIER_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <cstddef>
+#include <cstdint>
+#include "tensorflow/lite/micro/micro_weight_streamer.h"
+
+// Copies memory with DMA2 stream 0 for
+// MicroInterpreter::EnableWeightStreaming(), e.g. the weights of a model in
+// QSPI flash or SDRAM into the tensor arena. The copies run back to back from
+// the transfer complete interrupt while the CPU runs the kernels. The data
+// cache is cleaned for the sources and invalidated for the destinations, which
+// must start at a 32 bytes cache line and own the rest of their last line, as
+// the staging buffers of MicroWeightStreamer do. Only one instance can be
+// initialized.
+class DmaMemoryCopier : public tflite::MicroMemoryCopier
+{
+public:
+    // Sets up the DMA stream and its interrupt.
+    TfLiteStatus Init();
+
+    TfLiteStatus StartCopy(void* destination, const void* source, size_t bytes) override;
+    TfLiteStatus Wait() override;
+
+    // Called from the DMA interrupt when a chunk is done.
+    void OnTransferDone(bool failed);
+
+private:
+    struct Copy
+    {
+        uint8_t* destination;
+        const uint8_t* source;
+        size_t bytes;
+        size_t copied;
+    };
+
+    // Copies queued before the oldest one is done.
+    static constexpr int kMaxCopies = 16;
+
+    // Starts the next chunk of the oldest copy, at most 65535 transfers.
+    void StartChunk();
+
+    Copy copies_[kMaxCopies];
+    volatile int first_ = 0;
+    volatile int count_ = 0;
+    volatile bool busy_ = false;
+    volatile bool failed_ = false;
+    size_t chunk_bytes_ = 0;
+};
+
+#endif  // DMA_MEMORY_COPIER_H_
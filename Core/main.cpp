@@ -7,12 +7,21 @@
   */
 
 /* Includes ------------------------------------------------------------------*/
+#include <cmath>
 #include "stm32746g_discovery.h"
+#include "dma_memory_copier.h"
 #include "lcd.h"
 #include "sine_model.h"
+#include "sine_model_arena.h"
+#include "sine_model_compiled.h"
+#include "sine_model_int8.h"
+#include "sine_model_int8_arena.h"
+#include "snapshot_flash.h"
 #include "tensorflow/lite/micro/kernels/all_ops_resolver.h"
 #include "tensorflow/lite/micro/micro_error_reporter.h"
 #include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_snapshot.h"
+#include "tensorflow/lite/micro/micro_time.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/version.h"
 
@@ -25,13 +34,52 @@ namespace
     tflite::ErrorReporter* error_reporter = nullptr;
     const tflite::Model* model = nullptr;
     tflite::MicroInterpreter* interpreter = nullptr;
+    SineModelCompiled* compiled_model = nullptr;
     TfLiteTensor* model_input = nullptr;
     TfLiteTensor* model_output = nullptr;
 
+    // Set to true to interpret sine_model_int8.cpp, an int8 version of
+    // sine_model generated by tensorflow/lite/micro/tools/quantize_model.cc,
+    // instead of the float model. The x values are quantized with the scale
+    // and zero point of the input tensor and the y values dequantized with
+    // those of the output tensor. The time and the largest difference to
+    // sin(x) per cycle are logged for both, so the two can be compared.
+    constexpr bool kUseInt8Model = false;
+
     // Create an area of memory to use for input, output, and intermediate arrays.
-    // Finding the minimum value for your model may require some trial and error.
-    constexpr uint32_t kTensorArenaSize = 2 * 1024;
-    uint8_t tensor_arena[kTensorArenaSize];
+    // The size is a host-computed upper bound from tensorflow/lite/micro/tools/arena_size.cc,
+    // see sine_model_arena.h. The checked-in value comes from a 64-bit build of
+    // the tool, a 32-bit build gives the exact size.
+    constexpr uint32_t kTensorArenaSize = kUseInt8Model ? kSineModelInt8ArenaSize : kSineModelArenaSize;
+    alignas(16) uint8_t tensor_arena[kTensorArenaSize];
+
+    // Set to true to run sine_model_compiled.cpp, the ahead-of-time compiled
+    // version of sine_model generated by tensorflow/lite/micro/tools/model_compiler.cc,
+    // instead of interpreting the model. The results are identical, the compiled
+    // version just skips the interpreter overhead. The time per cycle is logged
+    // for both, so the two can be compared.
+    constexpr bool kUseCompiledModel = false;
+
+    // Set to true to stream the constant tensors of the interpreted model into
+    // the tensor arena with DMA, one node ahead of the computation, see
+    // MicroInterpreter::EnableWeightStreaming(). This is meant for models too
+    // large for the internal flash, placed in QSPI flash or SDRAM instead. The
+    // arena needs room for the staging buffers, so regenerate the arena size
+    // header with the --stream_weights flag of arena_size.cc.
+    constexpr bool kStreamWeights = false;
+    DmaMemoryCopier dma_copier;
+
+    // Set to true to restore the prepared interpreter from a snapshot in the
+    // last flash sector instead of preparing the model at every reset, see
+    // MicroInterpreter::RestoreSnapshot(). The first boot after flashing a
+    // new firmware prepares the model as usual and saves the snapshot. It
+    // needs the sector, so also link with
+    // -Wl,--defsym=SNAPSHOT_FLASH_SIZE=256K, see STM32F746NGHX_FLASH.ld. It
+    // can't be combined with kStreamWeights.
+    //
+    // The snapshot holds pointers into the firmware, so it's keyed by the
+    // model and the GNU build id of the image, see firmware_build_id().
+    constexpr bool kWarmBoot = false;
 } // namespace
 
 
@@ -50,6 +98,18 @@ extern const float INPUT_RANGE = 2.f * 3.14159265359f;
 // A larger number than the default to make the animation smoother
 const uint16_t INFERENCE_PER_CYCLE = 70;
 
+namespace
+{
+    // Input and output of the batched inference, one value per x of a cycle,
+    // bound to the interpreter with BindInput() and BindOutput().
+    alignas(16) float x_values[INFERENCE_PER_CYCLE + 1];
+    alignas(16) float y_values[INFERENCE_PER_CYCLE + 1];
+
+    // The same for the int8 model, see kUseInt8Model.
+    alignas(16) int8_t x_quantized[INFERENCE_PER_CYCLE + 1];
+    alignas(16) int8_t y_quantized[INFERENCE_PER_CYCLE + 1];
+} // namespace
+
 // UART handler declaration
 UART_HandleTypeDef DebugUartHandler;
 
@@ -92,7 +152,7 @@ int main(void)
 
   	// Map the model into a usable data structure. This doesn't involve any
   	// copying or parsing, it's a very lightweight operation.
-    model = tflite::GetModel(sine_model);
+    model = tflite::GetModel(kUseInt8Model ? sine_model_int8 : sine_model);
 
   	if(model->version() != TFLITE_SCHEMA_VERSION)
   	{
@@ -110,17 +170,113 @@ int main(void)
   	static tflite::MicroInterpreter static_interpreter(model, resolver, tensor_arena, kTensorArenaSize, error_reporter);
   	interpreter = &static_interpreter;
 
-  	// Allocate memory from the tensor_arena for the model's tensors.
-  	TfLiteStatus allocate_status = interpreter->AllocateTensors();
-  	if (allocate_status != kTfLiteOk)
+  	// All x values of a cycle are evaluated with one batched inference, see
+  	// below. The arena size in sine_model_arena.h accounts for that.
+  	if (interpreter->SetMaxBatchSize(INFERENCE_PER_CYCLE + 1) != kTfLiteOk)
+  	{
+  	    TF_LITE_REPORT_ERROR(error_reporter, "SetMaxBatchSize() failed");
+  	    return 0;
+  	}
+
+  	// The interpreted model reads the x values from, and writes the y values
+  	// to, these arrays directly, so they take no space in the tensor arena and
+  	// the input is never overwritten by intermediate results.
+  	TfLiteStatus bind_status;
+  	if (kUseInt8Model)
   	{
-  	    TF_LITE_REPORT_ERROR(error_reporter, "AllocateTensors() failed");
+  	    bind_status = interpreter->BindInput(0, x_quantized, sizeof(x_quantized));
+  	    if (bind_status == kTfLiteOk)
+  	    {
+  	        bind_status = interpreter->BindOutput(0, y_quantized, sizeof(y_quantized));
+  	    }
+  	}
+  	else
+  	{
+  	    bind_status = interpreter->BindInput(0, x_values, sizeof(x_values));
+  	    if (bind_status == kTfLiteOk)
+  	    {
+  	        bind_status = interpreter->BindOutput(0, y_values, sizeof(y_values));
+  	    }
+  	}
+  	if (bind_status != kTfLiteOk)
+  	{
+  	    TF_LITE_REPORT_ERROR(error_reporter, "Binding input and output failed");
   	    return 0;
   	}
 
+  	if (kStreamWeights)
+  	{
+  	    if (dma_copier.Init() != kTfLiteOk ||
+  	        interpreter->EnableWeightStreaming(&dma_copier) != kTfLiteOk)
+  	    {
+  	        TF_LITE_REPORT_ERROR(error_reporter, "Enabling weight streaming failed");
+  	        return 0;
+  	    }
+  	}
+
+  	// Restore the tensors from the snapshot of a previous boot if there's a
+  	// matching one, see kWarmBoot.
+  	TfLiteStatus allocate_status = kTfLiteError;
+  	uint32_t snapshot_hash = 0;
+  	bool use_snapshot = kWarmBoot && !kStreamWeights;
+  	if (use_snapshot && firmware_build_id_size() == 0)
+  	{
+  	    TF_LITE_REPORT_ERROR(error_reporter, "No build id to key the snapshot, link with -Wl,--build-id");
+  	    use_snapshot = false;
+  	}
+  	if (use_snapshot)
+  	{
+  	    snapshot_hash = kUseInt8Model ? tflite::MicroSnapshotHash(sine_model_int8, sine_model_int8_len)
+  	                                  : tflite::MicroSnapshotHash(sine_model, sine_model_len);
+  	    snapshot_hash = tflite::MicroSnapshotHash(firmware_build_id(), firmware_build_id_size(), snapshot_hash);
+  	    allocate_status = interpreter->RestoreSnapshot(snapshot_hash, snapshot_flash_data(), snapshot_flash_size());
+  	}
+
+  	// Otherwise allocate memory from the tensor_arena for the model's tensors.
+  	if (allocate_status != kTfLiteOk)
+  	{
+  	    allocate_status = interpreter->AllocateTensors();
+  	    if (allocate_status != kTfLiteOk)
+  	    {
+  	        TF_LITE_REPORT_ERROR(error_reporter, "AllocateTensors() failed");
+  	        return 0;
+  	    }
+
+  	    // A snapshot that fails to save is only reported, the next boot
+  	    // prepares the model again.
+  	    if (use_snapshot)
+  	    {
+  	        SnapshotFlashWriter snapshot_writer;
+  	        TfLiteStatus snapshot_status = snapshot_writer.Begin(interpreter->snapshot_bytes());
+  	        if (snapshot_status == kTfLiteOk)
+  	        {
+  	            snapshot_status = interpreter->SaveSnapshot(snapshot_hash, &snapshot_writer);
+  	            if (snapshot_writer.End() != kTfLiteOk)
+  	            {
+  	                snapshot_status = kTfLiteError;
+  	            }
+  	        }
+  	        if (snapshot_status != kTfLiteOk)
+  	        {
+  	            TF_LITE_REPORT_ERROR(error_reporter, "Saving the snapshot failed");
+  	        }
+  	    }
+  	}
+
+  	static SineModelCompiled static_compiled_model;
+  	compiled_model = &static_compiled_model;
+
   	// Obtain pointers to the model's input and output tensors.
-  	model_input = interpreter->input(0);
-  	model_output = interpreter->output(0);
+  	if (kUseCompiledModel)
+  	{
+  	    model_input = compiled_model->input(0);
+  	    model_output = compiled_model->output(0);
+  	}
+  	else
+  	{
+  	    model_input = interpreter->input(0);
+  	    model_output = interpreter->output(0);
+  	}
 
     // We are dividing the whole input range with the number of inference
     // per cycle we want to show to get the unit value. We will then multiply
@@ -129,28 +285,97 @@ int main(void)
  
     while (1)
     {
-	    // Calculate an x value to feed into the model
-        for(uint16_t inferenceCount = 0; inferenceCount <= INFERENCE_PER_CYCLE; inferenceCount++)
-        {
-	        float x_val = static_cast<float>(inferenceCount) * unitValuePerDevision;
+        // Only the inferences are timed, not the output handling.
+        int32_t invoke_ticks = 0;
+        // Largest difference between a predicted y value and sin(x).
+        float max_error = 0.0f;
 
-	        // Place our calculated x value in the model's input tensor
-	        model_input->data.f[0] = x_val;
+        if (kUseCompiledModel)
+        {
+	        // Calculate an x value to feed into the model
+            for(uint16_t inferenceCount = 0; inferenceCount <= INFERENCE_PER_CYCLE; inferenceCount++)
+            {
+	            float x_val = static_cast<float>(inferenceCount) * unitValuePerDevision;
+
+	            // Place our calculated x value in the model's input tensor
+	            model_input->data.f[0] = x_val;
+
+	            // Run inference, and report any error
+	            const int32_t invoke_start_ticks = tflite::GetCurrentTimeTicks();
+	            TfLiteStatus invoke_status = compiled_model->Invoke();
+	            invoke_ticks += tflite::GetCurrentTimeTicks() - invoke_start_ticks;
+	            if (invoke_status != kTfLiteOk)
+	            {
+	                TF_LITE_REPORT_ERROR(error_reporter, "Invoke failed on x_val: %f\n", static_cast<float>(x_val));
+	                return 0;
+	            }
+
+	            // Read the predicted y value from the model's output tensor
+	            float y_val = model_output->data.f[0];
+
+	            // Do something with the results
+	            max_error = fmaxf(max_error, fabsf(y_val - sinf(x_val)));
+	            handle_output(error_reporter, x_val, y_val);
+            }
+        }
+        else
+        {
+	        // Place all x values of the cycle one after the other in the bound
+	        // input buffer, so a single batched inference evaluates all of them.
+            for(uint16_t inferenceCount = 0; inferenceCount <= INFERENCE_PER_CYCLE; inferenceCount++)
+            {
+	            x_values[inferenceCount] = static_cast<float>(inferenceCount) * unitValuePerDevision;
+            }
+
+	        if (kUseInt8Model)
+	        {
+	            // Quantizing is part of the inference, so it's timed.
+	            const int32_t quantize_start_ticks = tflite::GetCurrentTimeTicks();
+	            const float input_scale = model_input->params.scale;
+	            const int32_t input_zero_point = model_input->params.zero_point;
+	            for(uint16_t inferenceCount = 0; inferenceCount <= INFERENCE_PER_CYCLE; inferenceCount++)
+	            {
+	                int32_t quantized = static_cast<int32_t>(roundf(x_values[inferenceCount] / input_scale)) + input_zero_point;
+	                quantized = quantized < -128 ? -128 : (quantized > 127 ? 127 : quantized);
+	                x_quantized[inferenceCount] = static_cast<int8_t>(quantized);
+	            }
+	            invoke_ticks += tflite::GetCurrentTimeTicks() - quantize_start_ticks;
+	        }
 
 	        // Run inference, and report any error
-	        TfLiteStatus invoke_status = interpreter->Invoke();
+	        const int32_t invoke_start_ticks = tflite::GetCurrentTimeTicks();
+	        TfLiteStatus invoke_status = interpreter->InvokeBatch(INFERENCE_PER_CYCLE + 1);
+	        invoke_ticks += tflite::GetCurrentTimeTicks() - invoke_start_ticks;
 	        if (invoke_status != kTfLiteOk)
 	        {
-	            TF_LITE_REPORT_ERROR(error_reporter, "Invoke failed on x_val: %f\n", static_cast<float>(x_val));
+	            TF_LITE_REPORT_ERROR(error_reporter, "InvokeBatch failed\n");
 	            return 0;
 	        }
 
-	        // Read the predicted y value from the model's output tensor
-	        float y_val = model_output->data.f[0];
+	        if (kUseInt8Model)
+	        {
+	            const int32_t dequantize_start_ticks = tflite::GetCurrentTimeTicks();
+	            const float output_scale = model_output->params.scale;
+	            const int32_t output_zero_point = model_output->params.zero_point;
+	            for(uint16_t inferenceCount = 0; inferenceCount <= INFERENCE_PER_CYCLE; inferenceCount++)
+	            {
+	                y_values[inferenceCount] = (y_quantized[inferenceCount] - output_zero_point) * output_scale;
+	            }
+	            invoke_ticks += tflite::GetCurrentTimeTicks() - dequantize_start_ticks;
+	        }
 
-	        // Do something with the results
-	        handle_output(error_reporter, x_val, y_val);
+	        // The predicted y values are in the same order in the bound output
+	        // buffer.
+            for(uint16_t inferenceCount = 0; inferenceCount <= INFERENCE_PER_CYCLE; inferenceCount++)
+            {
+	            max_error = fmaxf(max_error, fabsf(y_values[inferenceCount] - sinf(x_values[inferenceCount])));
+	            handle_output(error_reporter, x_values[inferenceCount], y_values[inferenceCount]);
+            }
         }
+
+        TF_LITE_REPORT_ERROR(error_reporter, "%s inferences took %d ticks per cycle, max error %f\n",
+                             kUseCompiledModel ? "Compiled float" : (kUseInt8Model ? "Interpreted int8" : "Interpreted float"),
+                             invoke_ticks, max_error);
     }
 }
 
@@ -0,0 +1,12 @@
+// Generated by tensorflow/lite/micro/tools/arena_size.cc from
+// sine_model.tflite with --max_batch_size=71 --bind_inputs_outputs.
+// Do not edit.
+// The size is a host-computed upper bound for a 16 bytes aligned
+// tensor arena. Only a build of the tool with the pointer size of
+// the target gives the exact size.
+
+#pragma once
+
+#include <stdint.h>
+
+constexpr uint32_t kSineModelArenaSize = 11824;
@@ -0,0 +1,210 @@
+// Generated by tensorflow/lite/micro/tools/model_compiler.cc from
+// sine_model.tflite. Do not edit.
+
+#include "sine_model_compiled.h"
+
+#include <string.h>
+
+#include "tensorflow/lite/kernels/internal/reference/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/reference/quantize.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace {
+
+// Tensor 0: dense_3_input
+constexpr int32_t kTensor0Shape[] = {1, 1};
+constexpr size_t kTensor0Offset = 64;
+
+// Tensor 1: sequential_1/dense_3/BiasAdd/ReadVariableOp
+constexpr int32_t kTensor1Shape[] = {16};
+alignas(16) const float kTensor1Data[16] = {
+    0.0f, 0.744514942f, 0.0f, 0.962268889f,
+    0.0f, 0.0f, 0.0f, 0.362781674f,
+    0.0f, 0.0f, -0.352458447f, 0.0f,
+    0.0f, 0.0f, -0.0259083416f, 0.0f,
+};
+
+// Tensor 2: sequential_1/dense_4/BiasAdd/ReadVariableOp
+constexpr int32_t kTensor2Shape[] = {16};
+alignas(16) const float kTensor2Data[16] = {
+    -0.377166331f, -0.124301895f, 0.13291432f, 0.100219272f,
+    0.0f, -0.161465481f, 0.487674266f, 0.334982753f,
+    -0.0284774229f, 0.142049864f, -0.0412531085f, -0.104448885f,
+    0.604273915f, 0.23923865f, 0.151980177f, 0.248742163f,
+};
+
+// Tensor 3: sequential_1/dense_5/BiasAdd/ReadVariableOp
+constexpr int32_t kTensor3Shape[] = {1};
+alignas(16) const float kTensor3Data[1] = {
+    -0.136608958f,
+};
+
+// Tensor 4: sequential_1/dense_3/MatMul
+constexpr int32_t kTensor4Shape[] = {16, 1};
+alignas(16) const float kTensor4Data[16] = {
+    -0.372108459f, -0.0577100515f, -0.56668812f, -0.152988419f,
+    -0.0982427299f, -0.337049156f, -0.490773797f, 0.198752761f,
+    -0.458751559f, -0.0038651228f, 0.600097239f, -0.59322226f,
+    -0.256399184f, -0.0477464199f, 0.358320355f, -0.215624481f,
+};
+
+// Tensor 5: sequential_1/dense_4/MatMul
+constexpr int32_t kTensor5Shape[] = {16, 16};
+alignas(16) const float kTensor5Data[256] = {
+    -0.373796552f, -0.571659565f, 0.166237146f, -1.65894151f,
+    -0.220259368f, -0.0635455251f, 0.0625578463f, 0.198778197f,
+    -0.01942873f, 0.352304548f, -0.0345555879f, -0.206889287f,
+    -0.29121989f, 0.0388170779f, 0.415697664f, 0.181826442f,
+    0.00731939077f, 0.053288281f, -0.323258132f, -0.243229046f,
+    0.105164498f, -0.232178435f, 0.181902438f, -0.267365456f,
+    0.0629250705f, -0.255669177f, 0.25872153f, -0.292222142f,
+    0.281551808f, 0.0195899904f, 0.296668231f, 0.273614973f,
+    -0.377086669f, 0.000781593262f, 0.159374505f, 0.76535964f,
+    -0.0797202885f, 0.00441250205f, -0.353134036f, 0.00113933557f,
+    -0.36155498f, 0.417336196f, 0.255470574f, -0.357795984f,
+    -0.330008686f, 0.378787607f, -0.0125892172f, 0.344063133f,
+    -0.345075071f, 0.0408210531f, 0.388462692f, 0.854661167f,
+    -0.362035662f, 0.0315723419f, -0.0414533615f, 0.286189526f,
+    0.28914699f, 0.146199971f, 0.107418172f, -0.235881284f,
+    -0.0832948983f, -0.303907752f, -0.421631992f, -0.380547225f,
+    0.22953406f, 0.274823159f, -0.178870112f, -0.207639411f,
+    -0.320631862f, 0.109910995f, -0.390348852f, -0.309720695f,
+    0.127454072f, -0.364476323f, 0.0480729043f, -0.0401619673f,
+    0.215034276f, -0.00163188577f, -0.207789525f, -0.150171727f,
+    -0.178354323f, -0.537277699f, 0.185991913f, -1.17531168f,
+    -0.0458075404f, 0.066360116f, -0.0722790658f, -0.405627996f,
+    -0.363499463f, 0.0254152119f, 0.388516665f, 0.163121313f,
+    -0.0163308382f, -0.371199399f, -0.0123684313f, -0.287641227f,
+    0.299457043f, 0.00060137792f, 0.122501105f, 0.960091949f,
+    -0.383133441f, -0.0769555569f, -0.375811577f, 0.413661093f,
+    -0.00925943255f, 0.327343255f, -0.484873742f, -0.367547244f,
+    0.232661813f, -0.256238222f, -0.060071107f, 0.391809911f,
+    0.308710724f, 0.186292171f, 0.311750263f, 0.606505811f,
+    -0.169935048f, -0.282802641f, 0.342455477f, -0.0428653508f,
+    -0.164272219f, -0.0897676349f, -0.155135334f, -0.427041918f,
+    0.132889003f, -0.300477147f, -0.777438104f, 0.180774778f,
+    -0.267882258f, -0.319380581f, -0.000494301319f, 0.217938542f,
+    0.255550236f, 0.41723749f, -0.411579609f, -0.112625666f,
+    0.265248209f, -0.187338755f, -0.235865384f, -0.199802712f,
+    -0.0853006244f, -0.139712453f, -0.357320964f, -0.192127049f,
+    0.123779505f, -0.044256825f, 0.23249808f, 1.12364554f,
+    -0.285449803f, -0.238896966f, -0.303012371f, 0.372182131f,
+    0.0502385199f, 0.139836043f, 0.403667152f, 0.415973932f,
+    -0.109278649f, 0.0315746069f, -0.279218763f, -0.308618426f,
+    -0.408593535f, -0.0526750609f, 0.178186446f, 0.0757400766f,
+    -0.347568572f, 0.336341828f, -0.388657391f, 0.0541709885f,
+    -0.301814914f, -0.017190814f, 0.201098248f, -0.394921392f,
+    -0.108070135f, 0.109600216f, 0.171175003f, -0.422819555f,
+    0.018889606f, 0.134711176f, 0.0966308415f, -0.150101215f,
+    -0.117631853f, -0.0233658254f, 0.339748174f, -0.119287662f,
+    -0.147270322f, -0.0847619176f, 0.141979858f, 0.072884649f,
+    0.386866659f, 0.0375912189f, 0.255782485f, 0.151079684f,
+    0.091786474f, 0.658989429f, 0.407858878f, 0.881416738f,
+    0.249232858f, -0.109938651f, -0.0594724715f, -0.13729322f,
+    0.0284425616f, 0.0312627256f, -0.456040353f, -0.342586815f,
+    0.21239838f, -0.165121049f, -0.0972746685f, 0.377120703f,
+    -0.338166773f, 0.214743018f, -0.429633409f, 0.607948661f,
+    -0.208480194f, -0.0988031626f, -0.38210085f, -0.140655994f,
+    -0.253243387f, -0.39658764f, -0.683982909f, -0.089722842f,
+    0.247109681f, 0.0200469196f, -0.112124786f, -0.0407254398f,
+    0.215622634f, 0.568186462f, -0.0503365993f, 0.848023415f,
+    -0.356014192f, -0.186346322f, -0.373120755f, 0.246089771f,
+    0.27480343f, 0.292254001f, 0.356311262f, -0.13659817f,
+    0.0511123538f, 0.0878424346f, -0.351590902f, 0.0414091945f,
+    -0.172969937f, 0.106863879f, 0.389381438f, 0.646032572f,
+    0.309494823f, -0.132572502f, 0.127235979f, -0.438330561f,
+    -0.261767983f, 0.136118501f, -0.299354792f, 0.424374014f,
+    -0.0196213722f, -0.406312913f, -0.888748527f, -0.318035424f,
+};
+
+// Tensor 6: sequential_1/dense_5/MatMul
+constexpr int32_t kTensor6Shape[] = {1, 16};
+alignas(16) const float kTensor6Data[16] = {
+    0.882007539f, 0.54344219f, -0.381741375f, -0.171429813f,
+    -0.543268502f, 0.828916371f, 1.42827034f, -0.950091004f,
+    0.194879308f, -0.173635632f, 0.0104434192f, 0.144668847f,
+    1.07970095f, -0.700273097f, -0.50796634f, -1.17761123f,
+};
+
+// Tensor 7: sequential_1/dense_3/Relu
+constexpr int32_t kTensor7Shape[] = {1, 16};
+constexpr size_t kTensor7Offset = 0;
+
+// Tensor 8: sequential_1/dense_4/Relu
+constexpr int32_t kTensor8Shape[] = {1, 16};
+constexpr size_t kTensor8Offset = 64;
+
+// Tensor 9: Identity
+constexpr int32_t kTensor9Shape[] = {1, 1};
+constexpr size_t kTensor9Offset = 0;
+
+int kInputDims0[] = {2, 1, 1};
+int kOutputDims0[] = {2, 1, 1};
+
+void InitTensor(TfLiteType type, uint8_t* data, int* dims, size_t bytes,
+                float scale, int32_t zero_point, TfLiteTensor* tensor) {
+  memset(tensor, 0, sizeof(*tensor));
+  tensor->type = type;
+  tensor->data.raw = reinterpret_cast<char*>(data);
+  tensor->dims = reinterpret_cast<TfLiteIntArray*>(dims);
+  tensor->params.scale = scale;
+  tensor->params.zero_point = zero_point;
+  tensor->allocation_type = kTfLiteArenaRw;
+  tensor->bytes = bytes;
+}
+
+}  // namespace
+
+SineModelCompiled::SineModelCompiled() {
+  InitTensor(kTfLiteFloat32, &arena_[kTensor0Offset], kInputDims0, 4, 0.0f, 0,
+             &inputs_[0]);
+  InitTensor(kTfLiteFloat32, &arena_[kTensor9Offset], kOutputDims0, 4, 0.0f, 0,
+             &outputs_[0]);
+}
+
+TfLiteStatus SineModelCompiled::Invoke() {
+  // Node 0: FULLY_CONNECTED
+  {
+    tflite::FullyConnectedParams op_params;
+    op_params.float_activation_min = 0.0f;
+    op_params.float_activation_max = 3.40282347e+38f;
+    tflite::reference_ops::FullyConnected(
+        op_params,
+        tflite::RuntimeShape(2, kTensor0Shape),
+        reinterpret_cast<const float*>(&arena_[kTensor0Offset]),
+        tflite::RuntimeShape(2, kTensor4Shape), kTensor4Data,
+        tflite::RuntimeShape(1, kTensor1Shape), kTensor1Data,
+        tflite::RuntimeShape(2, kTensor7Shape),
+        reinterpret_cast<float*>(&arena_[kTensor7Offset]));
+  }
+  // Node 1: FULLY_CONNECTED
+  {
+    tflite::FullyConnectedParams op_params;
+    op_params.float_activation_min = 0.0f;
+    op_params.float_activation_max = 3.40282347e+38f;
+    tflite::reference_ops::FullyConnected(
+        op_params,
+        tflite::RuntimeShape(2, kTensor7Shape),
+        reinterpret_cast<const float*>(&arena_[kTensor7Offset]),
+        tflite::RuntimeShape(2, kTensor5Shape), kTensor5Data,
+        tflite::RuntimeShape(1, kTensor2Shape), kTensor2Data,
+        tflite::RuntimeShape(2, kTensor8Shape),
+        reinterpret_cast<float*>(&arena_[kTensor8Offset]));
+  }
+  // Node 2: FULLY_CONNECTED
+  {
+    tflite::FullyConnectedParams op_params;
+    op_params.float_activation_min = -3.40282347e+38f;
+    op_params.float_activation_max = 3.40282347e+38f;
+    tflite::reference_ops::FullyConnected(
+        op_params,
+        tflite::RuntimeShape(2, kTensor8Shape),
+        reinterpret_cast<const float*>(&arena_[kTensor8Offset]),
+        tflite::RuntimeShape(2, kTensor6Shape), kTensor6Data,
+        tflite::RuntimeShape(1, kTensor3Shape), kTensor3Data,
+        tflite::RuntimeShape(2, kTensor9Shape),
+        reinterpret_cast<float*>(&arena_[kTensor9Offset]));
+  }
+  return kTfLiteOk;
+}
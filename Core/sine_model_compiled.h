@@ -0,0 +1,41 @@
+// Generated by tensorflow/lite/micro/tools/model_compiler.cc from
+// sine_model.tflite. Do not edit.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tensorflow/lite/c/common.h"
+
+// Runs the model without the interpreter. The API matches the
+// subset of tflite::MicroInterpreter needed to run inference. It
+// calls the reference kernels, which give the same results as the
+// optimized kernels of the interpreter, bit for bit.
+class SineModelCompiled {
+ public:
+  SineModelCompiled();
+
+  TfLiteTensor* input(size_t index) {
+    return index < kInputCount ? &inputs_[index] : nullptr;
+  }
+  size_t inputs_size() const { return kInputCount; }
+  TfLiteTensor* output(size_t index) {
+    return index < kOutputCount ? &outputs_[index] : nullptr;
+  }
+  size_t outputs_size() const { return kOutputCount; }
+
+  TfLiteStatus Invoke();
+
+  // Bytes of RAM used for the input, output and intermediate
+  // tensors.
+  static constexpr size_t kArenaSize = 128;
+
+ private:
+  static constexpr size_t kInputCount = 1;
+  static constexpr size_t kOutputCount = 1;
+
+  alignas(16) uint8_t arena_[kArenaSize];
+  TfLiteTensor inputs_[kInputCount];
+  TfLiteTensor outputs_[kOutputCount];
+};
@@ -0,0 +1,7 @@
+// Generated by tensorflow/lite/micro/tools/quantize_model.cc from
+// sine_model.tflite. Do not edit.
+
+#pragma once
+
+extern const unsigned char sine_model_int8[];
+extern const int sine_model_int8_len;
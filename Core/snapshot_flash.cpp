@@ -0,0 +1,134 @@
+/**
+  ******************************************************************************
+  * @file    snapshot_flash.cpp
+  * @brief   This file provides the flash storage of the interpreter snapshot
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "snapshot_flash.h"
+#include "stm32f7xx_hal.h"
+
+
+/* Private variables ---------------------------------------------------------*/
+// Defined by the linker script.
+extern "C" const uint8_t _ssnapshot[];
+extern "C" const uint8_t _esnapshot[];
+extern "C" const uint8_t _sbuild_id[];
+extern "C" const uint8_t _ebuild_id[];
+
+namespace
+{
+    // Sector 7 in single bank mode, see STM32F746NGHX_FLASH.ld.
+    constexpr uint32_t kSnapshotSector = FLASH_SECTOR_7;
+    constexpr uint32_t kSnapshotAddress = 0x080C0000;
+    constexpr uint32_t kSnapshotSize = 256 * 1024;
+} // namespace
+
+
+/* Public functions ----------------------------------------------------------*/
+const uint8_t* snapshot_flash_data()
+{
+    return _ssnapshot;
+}
+
+size_t snapshot_flash_size()
+{
+    return _esnapshot - _ssnapshot;
+}
+
+const uint8_t* firmware_build_id()
+{
+    return _sbuild_id;
+}
+
+size_t firmware_build_id_size()
+{
+    return _ebuild_id - _sbuild_id;
+}
+
+TfLiteStatus SnapshotFlashWriter::Begin(size_t bytes)
+{
+    // Only the sector this code erases may be kept by the linker script.
+    if (reinterpret_cast<uint32_t>(_ssnapshot) != kSnapshotAddress ||
+        snapshot_flash_size() != kSnapshotSize || bytes > kSnapshotSize)
+    {
+        return kTfLiteError;
+    }
+
+    HAL_FLASH_Unlock();
+
+    FLASH_EraseInitTypeDef erase = {0};
+    erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+    erase.Sector = kSnapshotSector;
+    erase.NbSectors = 1;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+    uint32_t sector_error = 0;
+    if (HAL_FLASHEx_Erase(&erase, &sector_error) != HAL_OK)
+    {
+        HAL_FLASH_Lock();
+        return kTfLiteError;
+    }
+
+    address_ = kSnapshotAddress;
+    end_ = kSnapshotAddress + bytes;
+    pending_word_ = 0;
+    pending_bytes_ = 0;
+    return kTfLiteOk;
+}
+
+TfLiteStatus SnapshotFlashWriter::Write(const void* data, size_t bytes)
+{
+    // The pieces of a snapshot don't end on word boundaries, so bytes are
+    // collected into little endian words before they're programmed.
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        pending_word_ |= static_cast<uint32_t>(source[i]) << (8 * pending_bytes_);
+        if (++pending_bytes_ == sizeof(uint32_t))
+        {
+            if (ProgramWord(pending_word_) != kTfLiteOk)
+            {
+                return kTfLiteError;
+            }
+            pending_word_ = 0;
+            pending_bytes_ = 0;
+        }
+    }
+    return kTfLiteOk;
+}
+
+TfLiteStatus SnapshotFlashWriter::End()
+{
+    TfLiteStatus status = kTfLiteOk;
+    if (pending_bytes_ > 0)
+    {
+        // Erased flash reads as ones, so the unused bytes stay erased.
+        pending_word_ |= 0xffffffffu << (8 * pending_bytes_);
+        status = ProgramWord(pending_word_);
+        pending_bytes_ = 0;
+    }
+    HAL_FLASH_Lock();
+
+    // The snapshot is read through the data cache, which may still hold the
+    // erased or previous contents of the sector.
+    SCB_InvalidateDCache_by_Addr(reinterpret_cast<uint32_t*>(kSnapshotAddress), kSnapshotSize);
+    return status;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+TfLiteStatus SnapshotFlashWriter::ProgramWord(uint32_t word)
+{
+    // Only the last word may reach past the size passed to Begin().
+    if (address_ >= end_)
+    {
+        return kTfLiteError;
+    }
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address_, word) != HAL_OK)
+    {
+        return kTfLiteError;
+    }
+    address_ += sizeof(uint32_t);
+    return kTfLiteOk;
+}
@@ -0,0 +1,50 @@
+/**
+  ******************************************************************************
+  * @file    snapshot_flash.h
+  * @brief   Header file for the flash storage of the interpreter snapshot
+  ******************************************************************************
+  */
+
+#ifndef SNAPSHOT_FLASH_H_
+#define SNAPSHOT_FLASH_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <cstddef>
+#include <cstdint>
+#include "tensorflow/lite/micro/micro_snapshot.h"
+
+// The snapshot lives in sector 7, the last 256 KB of the internal flash, when
+// the firmware is linked with -Wl,--defsym=SNAPSHOT_FLASH_SIZE=256K so that
+// the linker script keeps it free. Otherwise the size is 0. Pass these to
+// MicroInterpreter::RestoreSnapshot(), an erased or partly programmed sector
+// is rejected there.
+const uint8_t* snapshot_flash_data();
+size_t snapshot_flash_size();
+
+// The GNU build id note of the firmware, which -Wl,--build-id fills with a
+// hash of the linked image, so it changes with any change to the code. The
+// size is 0 when the firmware was linked without it.
+const uint8_t* firmware_build_id();
+size_t firmware_build_id_size();
+
+// Programs a snapshot into the snapshot sector for
+// MicroInterpreter::SaveSnapshot(). Begin() erases the sector, which takes
+// about a second, and End() programs the bytes of the last partial word and
+// locks the flash again.
+class SnapshotFlashWriter : public tflite::MicroSnapshotWriter
+{
+public:
+    TfLiteStatus Begin(size_t bytes);
+    TfLiteStatus Write(const void* data, size_t bytes) override;
+    TfLiteStatus End();
+
+private:
+    TfLiteStatus ProgramWord(uint32_t word);
+
+    uint32_t address_ = 0;
+    uint32_t end_ = 0;
+    uint32_t pending_word_ = 0;
+    size_t pending_bytes_ = 0;
+};
+
+#endif  // SNAPSHOT_FLASH_H_
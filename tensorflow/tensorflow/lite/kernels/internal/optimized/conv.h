@@ -0,0 +1,185 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_CONV_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_CONV_H_
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/im2col_utils.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+// Float and uint8 convolutions as a tiled matrix multiplication of the patch
+// rows from im2col_utils.h with the filter rows. For each tile of output
+// pixels, four filter rows at a time are multiplied with every patch row of
+// the tile, so the filter rows stay in cache while the tile is reused for
+// all output channels.
+//
+// Every output value is computed with the same operations in the same order
+// as reference_ops::Conv(), padding contributes zero.
+
+namespace tflite {
+namespace optimized_ops {
+
+inline void Conv(const ConvParams& params, const RuntimeShape& input_shape,
+                 const float* input_data, const RuntimeShape& filter_shape,
+                 const float* filter_data, const RuntimeShape& bias_shape,
+                 const float* bias_data, const RuntimeShape& output_shape,
+                 float* output_data, int im2col_tile_pixels,
+                 float* im2col_data) {
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  MatchingDim(input_shape, 0, output_shape, 0);
+  MatchingDim(input_shape, 3, filter_shape, 3);
+  const int output_depth = MatchingDim(filter_shape, 0, output_shape, 3);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+  }
+  const int row_size = Im2colRowSize(filter_shape);
+  const float output_activation_min = params.float_activation_min;
+  const float output_activation_max = params.float_activation_max;
+
+  auto multiply = [&](const float* rows, int first_pixel, int pixel_count) {
+    float* output = output_data + first_pixel * output_depth;
+    int out_c = 0;
+    for (; out_c + 4 <= output_depth; out_c += 4) {
+      const float* filter0 = filter_data + out_c * row_size;
+      const float* filter1 = filter0 + row_size;
+      const float* filter2 = filter1 + row_size;
+      const float* filter3 = filter2 + row_size;
+      for (int p = 0; p < pixel_count; ++p) {
+        const float* row = rows + p * row_size;
+        float total0 = 0.f;
+        float total1 = 0.f;
+        float total2 = 0.f;
+        float total3 = 0.f;
+        for (int i = 0; i < row_size; ++i) {
+          const float input_value = row[i];
+          total0 += input_value * filter0[i];
+          total1 += input_value * filter1[i];
+          total2 += input_value * filter2[i];
+          total3 += input_value * filter3[i];
+        }
+        const float totals[4] = {total0, total1, total2, total3};
+        for (int i = 0; i < 4; ++i) {
+          const float bias_value = bias_data ? bias_data[out_c + i] : 0.0f;
+          output[p * output_depth + out_c + i] = ActivationFunctionWithMinMax(
+              totals[i] + bias_value, output_activation_min,
+              output_activation_max);
+        }
+      }
+    }
+    for (; out_c < output_depth; ++out_c) {
+      const float* filter = filter_data + out_c * row_size;
+      const float bias_value = bias_data ? bias_data[out_c] : 0.0f;
+      for (int p = 0; p < pixel_count; ++p) {
+        const float* row = rows + p * row_size;
+        float total = 0.f;
+        for (int i = 0; i < row_size; ++i) {
+          total += row[i] * filter[i];
+        }
+        output[p * output_depth + out_c] = ActivationFunctionWithMinMax(
+            total + bias_value, output_activation_min, output_activation_max);
+      }
+    }
+  };
+  ForEachIm2colTile(params, input_shape, input_data, filter_shape,
+                    output_shape, 0.0f, im2col_tile_pixels, im2col_data,
+                    multiply);
+}
+
+inline void Conv(const ConvParams& params, const RuntimeShape& input_shape,
+                 const uint8* input_data, const RuntimeShape& filter_shape,
+                 const uint8* filter_data, const RuntimeShape& bias_shape,
+                 const int32* bias_data, const RuntimeShape& output_shape,
+                 uint8* output_data, int im2col_tile_pixels,
+                 uint8* im2col_data) {
+  const int32 input_offset = params.input_offset;
+  const int32 filter_offset = params.weights_offset;
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  MatchingDim(input_shape, 0, output_shape, 0);
+  MatchingDim(input_shape, 3, filter_shape, 3);
+  const int output_depth = MatchingDim(filter_shape, 0, output_shape, 3);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+  }
+  const int row_size = Im2colRowSize(filter_shape);
+
+  auto requantize = [&](int32 acc, int out_c) {
+    if (bias_data) {
+      acc += bias_data[out_c];
+    }
+    acc = MultiplyByQuantizedMultiplier(acc, params.output_multiplier,
+                                        params.output_shift);
+    acc += params.output_offset;
+    acc = std::max(acc, params.quantized_activation_min);
+    acc = std::min(acc, params.quantized_activation_max);
+    return static_cast<uint8>(acc);
+  };
+  auto multiply = [&](const uint8* rows, int first_pixel, int pixel_count) {
+    uint8* output = output_data + first_pixel * output_depth;
+    int out_c = 0;
+    for (; out_c + 4 <= output_depth; out_c += 4) {
+      const uint8* filter0 = filter_data + out_c * row_size;
+      const uint8* filter1 = filter0 + row_size;
+      const uint8* filter2 = filter1 + row_size;
+      const uint8* filter3 = filter2 + row_size;
+      for (int p = 0; p < pixel_count; ++p) {
+        const uint8* row = rows + p * row_size;
+        int32 acc0 = 0;
+        int32 acc1 = 0;
+        int32 acc2 = 0;
+        int32 acc3 = 0;
+        for (int i = 0; i < row_size; ++i) {
+          const int32 input_value = row[i] + input_offset;
+          acc0 += (filter0[i] + filter_offset) * input_value;
+          acc1 += (filter1[i] + filter_offset) * input_value;
+          acc2 += (filter2[i] + filter_offset) * input_value;
+          acc3 += (filter3[i] + filter_offset) * input_value;
+        }
+        uint8* out = output + p * output_depth + out_c;
+        out[0] = requantize(acc0, out_c);
+        out[1] = requantize(acc1, out_c + 1);
+        out[2] = requantize(acc2, out_c + 2);
+        out[3] = requantize(acc3, out_c + 3);
+      }
+    }
+    for (; out_c < output_depth; ++out_c) {
+      const uint8* filter = filter_data + out_c * row_size;
+      for (int p = 0; p < pixel_count; ++p) {
+        const uint8* row = rows + p * row_size;
+        int32 acc = 0;
+        for (int i = 0; i < row_size; ++i) {
+          acc += (filter[i] + filter_offset) * (row[i] + input_offset);
+        }
+        output[p * output_depth + out_c] = requantize(acc, out_c);
+      }
+    }
+  };
+  // Padding with the input zero point makes (input + input_offset) zero.
+  ForEachIm2colTile(params, input_shape, input_data, filter_shape,
+                    output_shape, static_cast<uint8>(-input_offset),
+                    im2col_tile_pixels, im2col_data, multiply);
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_CONV_H_
@@ -0,0 +1,138 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_DEPTHWISE_CONV_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_DEPTHWISE_CONV_H_
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/depthwise_conv_utils.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+// Float depthwise convolution for the filter sizes and strides that
+// HasSpecializedDepthwiseConv() accepts. The filter size and stride are
+// template parameters, so the filter taps of an interior pixel are unrolled
+// into fixed offsets from the window origin, and the loop over the channels
+// reads both the input and the filter contiguously.
+//
+// Every output is summed over the same taps in the same order as
+// reference_ops::DepthwiseConv(), so the results are the same.
+
+namespace tflite {
+namespace optimized_ops {
+namespace depthwise_conv_internal {
+
+template <int kFilterSize, int kStride>
+inline void DepthwiseConv(const DepthwiseParams& params,
+                          const RuntimeShape& input_shape,
+                          const float* input_data,
+                          const RuntimeShape& filter_shape,
+                          const float* filter_data, const float* bias_data,
+                          const RuntimeShape& output_shape,
+                          float* output_data) {
+  const float output_activation_min = params.float_activation_min;
+  const float output_activation_max = params.float_activation_max;
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int depth = MatchingDim(input_shape, 3, output_shape, 3);
+  const int row_stride = input_width * depth;
+
+  auto store = [&](float total, float* output, int c) {
+    const float bias_value = bias_data ? bias_data[c] : 0.0f;
+    output[c] = ActivationFunctionWithMinMax(
+        total + bias_value, output_activation_min, output_activation_max);
+  };
+  auto interior = [&](int batch, int out_y, int out_x, int in_y, int in_x) {
+    const float* input = input_data + Offset(input_shape, batch, in_y, in_x, 0);
+    float* output = output_data + Offset(output_shape, batch, out_y, out_x, 0);
+    for (int c = 0; c < depth; ++c) {
+      float total = 0.f;
+      for (int filter_y = 0; filter_y < kFilterSize; ++filter_y) {
+        for (int filter_x = 0; filter_x < kFilterSize; ++filter_x) {
+          total += input[filter_y * row_stride + filter_x * depth + c] *
+                   filter_data[(filter_y * kFilterSize + filter_x) * depth + c];
+        }
+      }
+      store(total, output, c);
+    }
+  };
+  auto border = [&](int batch, int out_y, int out_x, int in_y, int in_x) {
+    const int y_begin = std::max(0, -in_y);
+    const int y_end = std::min(kFilterSize, input_height - in_y);
+    const int x_begin = std::max(0, -in_x);
+    const int x_end = std::min(kFilterSize, input_width - in_x);
+    float* output = output_data + Offset(output_shape, batch, out_y, out_x, 0);
+    for (int c = 0; c < depth; ++c) {
+      float total = 0.f;
+      for (int filter_y = y_begin; filter_y < y_end; ++filter_y) {
+        for (int filter_x = x_begin; filter_x < x_end; ++filter_x) {
+          total += input_data[Offset(input_shape, batch, in_y + filter_y,
+                                     in_x + filter_x, c)] *
+                   filter_data[(filter_y * kFilterSize + filter_x) * depth + c];
+        }
+      }
+      store(total, output, c);
+    }
+  };
+  ForEachDepthwisePixel<kFilterSize, kStride>(params, input_shape,
+                                              output_shape, interior, border);
+}
+
+}  // namespace depthwise_conv_internal
+
+inline void DepthwiseConv(const DepthwiseParams& params,
+                          const RuntimeShape& input_shape,
+                          const float* input_data,
+                          const RuntimeShape& filter_shape,
+                          const float* filter_data,
+                          const RuntimeShape& bias_shape,
+                          const float* bias_data,
+                          const RuntimeShape& output_shape,
+                          float* output_data) {
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK(HasSpecializedDepthwiseConv(
+      filter_shape.Dims(1), filter_shape.Dims(2), params.stride_height,
+      params.stride_width, params.dilation_height_factor,
+      params.dilation_width_factor, params.depth_multiplier));
+  MatchingDim(filter_shape, 3, output_shape, 3);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_shape.Dims(3));
+  }
+  using depthwise_conv_internal::DepthwiseConv;
+  if (filter_shape.Dims(1) == 3) {
+    if (params.stride_height == 1) {
+      DepthwiseConv<3, 1>(params, input_shape, input_data, filter_shape,
+                          filter_data, bias_data, output_shape, output_data);
+    } else {
+      DepthwiseConv<3, 2>(params, input_shape, input_data, filter_shape,
+                          filter_data, bias_data, output_shape, output_data);
+    }
+  } else {
+    if (params.stride_height == 1) {
+      DepthwiseConv<5, 1>(params, input_shape, input_data, filter_shape,
+                          filter_data, bias_data, output_shape, output_data);
+    } else {
+      DepthwiseConv<5, 2>(params, input_shape, input_data, filter_shape,
+                          filter_data, bias_data, output_shape, output_data);
+    }
+  }
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_DEPTHWISE_CONV_H_
@@ -0,0 +1,103 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_DEPTHWISE_CONV_UTILS_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_DEPTHWISE_CONV_UTILS_H_
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/types.h"
+
+// Helpers for the depthwise convolutions specialized for one filter size and
+// stride. The output pixels whose filter window lies entirely inside the
+// input, the interior, are computed without any bounds checks; only the
+// pixels of the padded border check every filter tap.
+
+namespace tflite {
+namespace optimized_ops {
+
+// True for the depthwise convolutions with a specialized kernel: square 3x3
+// or 5x5 filters with the same stride of 1 or 2 in both directions, no
+// dilation and a depth multiplier of 1.
+inline bool HasSpecializedDepthwiseConv(int filter_height, int filter_width,
+                                        int stride_height, int stride_width,
+                                        int dilation_height_factor,
+                                        int dilation_width_factor,
+                                        int depth_multiplier) {
+  return (filter_height == 3 || filter_height == 5) &&
+         filter_width == filter_height &&
+         (stride_height == 1 || stride_height == 2) &&
+         stride_width == stride_height && dilation_height_factor == 1 &&
+         dilation_width_factor == 1 && depth_multiplier == 1;
+}
+
+// The range [*begin, *end) of the output rows or columns whose filter window
+// starts at or after the first input row or column and ends before the last.
+inline void DepthwiseInteriorRange(int input_size, int output_size, int pad,
+                                   int stride, int filter_size, int* begin,
+                                   int* end) {
+  *begin = std::min((pad + stride - 1) / stride, output_size);
+  const int last_origin = input_size - filter_size + pad;
+  *end = last_origin < 0 ? 0
+                         : std::min(last_origin / stride + 1, output_size);
+  *end = std::max(*end, *begin);
+}
+
+// Calls interior(batch, out_y, out_x, in_y, in_x) for the output pixels
+// whose kFilterSize x kFilterSize window at input (in_y, in_x) lies inside
+// the input, and border() with the same arguments for the windows that reach
+// into the padding. in_y and in_x are negative when the window starts in it.
+template <int kFilterSize, int kStride, typename Interior, typename Border>
+inline void ForEachDepthwisePixel(const DepthwiseParams& params,
+                                  const RuntimeShape& input_shape,
+                                  const RuntimeShape& output_shape,
+                                  const Interior& interior,
+                                  const Border& border) {
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int pad_height = params.padding_values.height;
+  const int pad_width = params.padding_values.width;
+  int y_begin, y_end, x_begin, x_end;
+  DepthwiseInteriorRange(input_height, output_height, pad_height, kStride,
+                         kFilterSize, &y_begin, &y_end);
+  DepthwiseInteriorRange(input_width, output_width, pad_width, kStride,
+                         kFilterSize, &x_begin, &x_end);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y = out_y * kStride - pad_height;
+      const bool interior_row = out_y >= y_begin && out_y < y_end;
+      int out_x = 0;
+      if (interior_row) {
+        for (; out_x < x_begin; ++out_x) {
+          border(batch, out_y, out_x, in_y, out_x * kStride - pad_width);
+        }
+        for (; out_x < x_end; ++out_x) {
+          interior(batch, out_y, out_x, in_y, out_x * kStride - pad_width);
+        }
+      }
+      for (; out_x < output_width; ++out_x) {
+        border(batch, out_y, out_x, in_y, out_x * kStride - pad_width);
+      }
+    }
+  }
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_DEPTHWISE_CONV_UTILS_H_
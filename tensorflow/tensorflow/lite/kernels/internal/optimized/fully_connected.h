@@ -0,0 +1,161 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_FULLY_CONNECTED_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_FULLY_CONNECTED_H_
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define TFLITE_FULLY_CONNECTED_SSE
+#endif
+
+// Float fully connected kernel that computes four outputs at a time. The
+// weights of every four output channels are packed once, with
+// PackFullyConnectedWeights(), so that the four weights of one input are next
+// to each other:
+//
+//   packed[block][d][i] = weights[4 * block + i][d]
+//
+// Each input value is then loaded once per block and multiplied with four
+// contiguous weights, one SSE instruction on x86 hosts and four independent
+// accumulators otherwise, which keep the FPU of e.g. a Cortex-M7 busy instead
+// of waiting on a single sum. The bias and the activation are applied to the
+// four sums before they're stored. Outputs left over after the last full
+// block use the unpacked weights.
+//
+// Every output is summed over the inputs in the same order as
+// reference_ops::FullyConnected(), so the results are the same.
+
+namespace tflite {
+namespace optimized_ops {
+
+// Output channels per block of packed weights.
+constexpr int kFullyConnectedBlockSize = 4;
+
+// The number of floats PackFullyConnectedWeights() writes.
+inline int FullyConnectedPackedSize(const RuntimeShape& weights_shape) {
+  const int weights_dims_count = weights_shape.DimensionsCount();
+  const int output_depth = weights_shape.Dims(weights_dims_count - 2);
+  const int accum_depth = weights_shape.Dims(weights_dims_count - 1);
+  return (output_depth / kFullyConnectedBlockSize) * kFullyConnectedBlockSize *
+         accum_depth;
+}
+
+inline void PackFullyConnectedWeights(const RuntimeShape& weights_shape,
+                                      const float* weights_data,
+                                      float* packed_data) {
+  const int weights_dims_count = weights_shape.DimensionsCount();
+  const int output_depth = weights_shape.Dims(weights_dims_count - 2);
+  const int accum_depth = weights_shape.Dims(weights_dims_count - 1);
+  const int block_count = output_depth / kFullyConnectedBlockSize;
+  for (int block = 0; block < block_count; ++block) {
+    const float* rows =
+        weights_data + block * kFullyConnectedBlockSize * accum_depth;
+    for (int d = 0; d < accum_depth; ++d) {
+      for (int i = 0; i < kFullyConnectedBlockSize; ++i) {
+        *packed_data++ = rows[i * accum_depth + d];
+      }
+    }
+  }
+}
+
+// `packed_weights` are `weights_data` packed with PackFullyConnectedWeights().
+inline void FullyConnected(
+    const FullyConnectedParams& params, const RuntimeShape& input_shape,
+    const float* input_data, const RuntimeShape& weights_shape,
+    const float* weights_data, const float* packed_weights,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data) {
+  const float output_activation_min = params.float_activation_min;
+  const float output_activation_max = params.float_activation_max;
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int weights_dims_count = weights_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
+                                       output_shape, output_dims_count - 1);
+  const int accum_depth = weights_shape.Dims(weights_dims_count - 1);
+  const int block_count = output_depth / kFullyConnectedBlockSize;
+  static const float kZeroBias[kFullyConnectedBlockSize] = {};
+
+#ifdef TFLITE_FULLY_CONNECTED_SSE
+  const __m128 activation_min = _mm_set1_ps(output_activation_min);
+  const __m128 activation_max = _mm_set1_ps(output_activation_max);
+#endif
+
+  for (int b = 0; b < batches; ++b) {
+    const float* input = input_data + b * accum_depth;
+    float* output = output_data + b * output_depth;
+    const float* packed = packed_weights;
+    for (int block = 0; block < block_count; ++block) {
+      const int out_c = block * kFullyConnectedBlockSize;
+      // The reference adds a zero bias too, which turns -0 into +0.
+      const float* bias = bias_data ? bias_data + out_c : kZeroBias;
+#ifdef TFLITE_FULLY_CONNECTED_SSE
+      __m128 totals = _mm_setzero_ps();
+      for (int d = 0; d < accum_depth; ++d) {
+        totals = _mm_add_ps(
+            totals, _mm_mul_ps(_mm_set1_ps(input[d]), _mm_loadu_ps(packed)));
+        packed += kFullyConnectedBlockSize;
+      }
+      totals = _mm_add_ps(totals, _mm_loadu_ps(bias));
+      // The operand order gives the NaN handling of std::max and std::min in
+      // ActivationFunctionWithMinMax().
+      totals = _mm_min_ps(activation_max, _mm_max_ps(activation_min, totals));
+      _mm_storeu_ps(output + out_c, totals);
+#else
+      float total0 = 0.f;
+      float total1 = 0.f;
+      float total2 = 0.f;
+      float total3 = 0.f;
+      for (int d = 0; d < accum_depth; ++d) {
+        const float input_value = input[d];
+        total0 += input_value * packed[0];
+        total1 += input_value * packed[1];
+        total2 += input_value * packed[2];
+        total3 += input_value * packed[3];
+        packed += kFullyConnectedBlockSize;
+      }
+      output[out_c] = ActivationFunctionWithMinMax(
+          total0 + bias[0], output_activation_min, output_activation_max);
+      output[out_c + 1] = ActivationFunctionWithMinMax(
+          total1 + bias[1], output_activation_min, output_activation_max);
+      output[out_c + 2] = ActivationFunctionWithMinMax(
+          total2 + bias[2], output_activation_min, output_activation_max);
+      output[out_c + 3] = ActivationFunctionWithMinMax(
+          total3 + bias[3], output_activation_min, output_activation_max);
+#endif
+    }
+    for (int out_c = block_count * kFullyConnectedBlockSize;
+         out_c < output_depth; ++out_c) {
+      const float* weights = weights_data + out_c * accum_depth;
+      float total = 0.f;
+      for (int d = 0; d < accum_depth; ++d) {
+        total += input[d] * weights[d];
+      }
+      const float bias_value = bias_data ? bias_data[out_c] : 0.0f;
+      output[out_c] = ActivationFunctionWithMinMax(
+          total + bias_value, output_activation_min, output_activation_max);
+    }
+  }
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#undef TFLITE_FULLY_CONNECTED_SSE
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_FULLY_CONNECTED_H_
@@ -0,0 +1,129 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_IM2COL_UTILS_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_IM2COL_UTILS_H_
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/lite/kernels/internal/types.h"
+
+// Helpers to run a convolution as a matrix multiplication. Every output pixel
+// gets a row with its input patch, laid out like a filter row:
+// [filter_y][filter_x][input_channel]. The output pixel for one channel is
+// then the dot product of the patch row with the filter row of the channel.
+//
+// The rows are built for a tile of consecutive output pixels at a time, so
+// the im2col buffer can be much smaller than the whole patch matrix.
+
+namespace tflite {
+namespace optimized_ops {
+
+// Number of values in one patch row.
+inline int Im2colRowSize(const RuntimeShape& filter_shape) {
+  return filter_shape.Dims(1) * filter_shape.Dims(2) * filter_shape.Dims(3);
+}
+
+// True when the patch rows are exactly the input pixels, i.e. for 1x1
+// filters with stride 1 and no padding. Then no im2col buffer is needed.
+inline bool Im2colIsIdentity(const ConvParams& params,
+                             const RuntimeShape& input_shape,
+                             const RuntimeShape& filter_shape,
+                             const RuntimeShape& output_shape) {
+  return filter_shape.Dims(1) == 1 && filter_shape.Dims(2) == 1 &&
+         params.stride_width == 1 && params.stride_height == 1 &&
+         params.padding_values.width == 0 &&
+         params.padding_values.height == 0 &&
+         input_shape.Dims(1) == output_shape.Dims(1) &&
+         input_shape.Dims(2) == output_shape.Dims(2);
+}
+
+// Writes the patch rows of `pixel_count` output pixels, starting at
+// `first_pixel` in [batch][output_y][output_x] order, to `im2col_data`.
+// Values outside the input are `pad_value`, the input zero point for
+// quantized data.
+template <typename T>
+inline void Im2colRows(const ConvParams& params,
+                       const RuntimeShape& input_shape, const T* input_data,
+                       const RuntimeShape& filter_shape,
+                       const RuntimeShape& output_shape, int first_pixel,
+                       int pixel_count, T pad_value, T* im2col_data) {
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int output_pixels_per_batch = output_height * output_width;
+  T* row = im2col_data;
+  for (int pixel = first_pixel; pixel < first_pixel + pixel_count; ++pixel) {
+    const int batch = pixel / output_pixels_per_batch;
+    const int out_y = (pixel % output_pixels_per_batch) / output_width;
+    const int out_x = pixel % output_width;
+    const int in_y_origin =
+        out_y * params.stride_height - params.padding_values.height;
+    const int in_x_origin =
+        out_x * params.stride_width - params.padding_values.width;
+    for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+      const int in_y = in_y_origin + params.dilation_height_factor * filter_y;
+      for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+        const int in_x = in_x_origin + params.dilation_width_factor * filter_x;
+        if (in_y >= 0 && in_y < input_height && in_x >= 0 &&
+            in_x < input_width) {
+          memcpy(row, input_data + Offset(input_shape, batch, in_y, in_x, 0),
+                 input_depth * sizeof(T));
+        } else {
+          std::fill(row, row + input_depth, pad_value);
+        }
+        row += input_depth;
+      }
+    }
+  }
+}
+
+// Calls `multiply(rows, first_pixel, pixel_count)` for the patch rows of
+// every output pixel, in tiles of at most `tile_pixels` pixels built in
+// `im2col_data`. When `im2col_data` is nullptr the convolution must satisfy
+// Im2colIsIdentity(), and the input itself is used for all pixels at once.
+template <typename T, typename MultiplyFn>
+inline void ForEachIm2colTile(const ConvParams& params,
+                              const RuntimeShape& input_shape,
+                              const T* input_data,
+                              const RuntimeShape& filter_shape,
+                              const RuntimeShape& output_shape, T pad_value,
+                              int tile_pixels, T* im2col_data,
+                              const MultiplyFn& multiply) {
+  const int pixel_count = output_shape.Dims(0) * output_shape.Dims(1) *
+                          output_shape.Dims(2);
+  if (im2col_data == nullptr) {
+    TFLITE_DCHECK(
+        Im2colIsIdentity(params, input_shape, filter_shape, output_shape));
+    multiply(input_data, 0, pixel_count);
+    return;
+  }
+  TFLITE_DCHECK_GT(tile_pixels, 0);
+  for (int first = 0; first < pixel_count; first += tile_pixels) {
+    const int count = std::min(tile_pixels, pixel_count - first);
+    Im2colRows(params, input_shape, input_data, filter_shape, output_shape,
+               first, count, pad_value, im2col_data);
+    multiply(const_cast<const T*>(im2col_data), first, count);
+  }
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_IM2COL_UTILS_H_
@@ -0,0 +1,124 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_CONV_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_CONV_H_
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/im2col_utils.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/dot_product.h"
+
+// Per-channel int8 convolution as a tiled matrix multiplication, giving the
+// same results as reference_integer_ops::ConvPerChannel(). The filter is
+// symmetric, so
+//
+//   sum(filter * (input + input_offset))
+//     = sum(filter * input) + input_offset * sum(filter)
+//
+// and the second term is folded into the bias once with
+// PrecomputeConvBias(). Padding uses the input zero point, which makes
+// both sides of the equation zero for values outside the image.
+
+namespace tflite {
+namespace optimized_integer_ops {
+namespace conv_internal {
+
+inline int8_t Requantize(int32 acc, int32 output_multiplier, int output_shift,
+                         const ConvParams& params) {
+  acc = MultiplyByQuantizedMultiplier(acc, output_multiplier, output_shift);
+  acc += params.output_offset;
+  acc = std::max(acc, params.quantized_activation_min);
+  acc = std::min(acc, params.quantized_activation_max);
+  return static_cast<int8_t>(acc);
+}
+
+}  // namespace conv_internal
+
+// Computes bias + input_offset * sum(filter) for every output channel into
+// `folded_bias`. `bias_data` may be nullptr.
+inline void PrecomputeConvBias(int32 input_offset,
+                               const RuntimeShape& filter_shape,
+                               const int8_t* filter_data,
+                               const int32* bias_data, int32* folded_bias) {
+  const int output_depth = filter_shape.Dims(0);
+  const int row_size = optimized_ops::Im2colRowSize(filter_shape);
+  for (int out_c = 0; out_c < output_depth; ++out_c) {
+    int32 filter_sum = 0;
+    for (int i = 0; i < row_size; ++i) {
+      filter_sum += filter_data[out_c * row_size + i];
+    }
+    folded_bias[out_c] =
+        input_offset * filter_sum + (bias_data ? bias_data[out_c] : 0);
+  }
+}
+
+// Same as reference_integer_ops::ConvPerChannel(), with the bias replaced by
+// the result of PrecomputeConvBias(). `im2col_data` holds the patch rows of
+// `im2col_tile_pixels` output pixels, see optimized_ops::ForEachIm2colTile().
+inline void ConvPerChannel(
+    const ConvParams& params, const int32* output_multiplier,
+    const int32* output_shift, const RuntimeShape& input_shape,
+    const int8* input_data, const RuntimeShape& filter_shape,
+    const int8* filter_data, const int32* folded_bias,
+    const RuntimeShape& output_shape, int8* output_data,
+    int im2col_tile_pixels, int8* im2col_data) {
+  using conv_internal::Requantize;
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  MatchingDim(input_shape, 0, output_shape, 0);
+  MatchingDim(input_shape, 3, filter_shape, 3);
+  const int output_depth = MatchingDim(filter_shape, 0, output_shape, 3);
+  const int row_size = optimized_ops::Im2colRowSize(filter_shape);
+
+  auto multiply = [&](const int8* rows, int first_pixel, int pixel_count) {
+    int8* output = output_data + first_pixel * output_depth;
+    int out_c = 0;
+    for (; out_c + 4 <= output_depth; out_c += 4) {
+      const int8* filter = filter_data + out_c * row_size;
+      for (int p = 0; p < pixel_count; ++p) {
+        int32 acc[4];
+        DotProduct4(rows + p * row_size, filter, row_size, acc);
+        int8* out = output + p * output_depth + out_c;
+        for (int i = 0; i < 4; ++i) {
+          out[i] = Requantize(acc[i] + folded_bias[out_c + i],
+                              output_multiplier[out_c + i],
+                              output_shift[out_c + i], params);
+        }
+      }
+    }
+    for (; out_c < output_depth; ++out_c) {
+      const int8* filter = filter_data + out_c * row_size;
+      for (int p = 0; p < pixel_count; ++p) {
+        const int32 acc = DotProduct(rows + p * row_size, filter, row_size);
+        output[p * output_depth + out_c] =
+            Requantize(acc + folded_bias[out_c], output_multiplier[out_c],
+                       output_shift[out_c], params);
+      }
+    }
+  };
+  optimized_ops::ForEachIm2colTile(
+      params, input_shape, input_data, filter_shape, output_shape,
+      static_cast<int8>(-params.input_offset), im2col_tile_pixels, im2col_data,
+      multiply);
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_CONV_H_
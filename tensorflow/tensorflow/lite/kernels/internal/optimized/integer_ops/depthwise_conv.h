@@ -0,0 +1,152 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_DEPTHWISE_CONV_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_DEPTHWISE_CONV_H_
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/depthwise_conv_utils.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+// Per-channel int8 depthwise convolution for the filter sizes and strides
+// that optimized_ops::HasSpecializedDepthwiseConv() accepts, giving the same
+// results as reference_integer_ops::DepthwiseConvPerChannel(). Like the float
+// version in optimized/depthwise_conv.h, the filter taps of an interior pixel
+// are unrolled and only the border pixels check the taps against the input.
+
+namespace tflite {
+namespace optimized_integer_ops {
+namespace depthwise_conv_internal {
+
+template <int kFilterSize, int kStride>
+inline void DepthwiseConvPerChannel(
+    const DepthwiseParams& params, const int32* output_multiplier,
+    const int32* output_shift, const RuntimeShape& input_shape,
+    const int8* input_data, const RuntimeShape& filter_shape,
+    const int8* filter_data, const int32* bias_data,
+    const RuntimeShape& output_shape, int8* output_data) {
+  const int32 input_offset = params.input_offset;
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int depth = MatchingDim(input_shape, 3, output_shape, 3);
+  const int row_stride = input_width * depth;
+
+  auto store = [&](int32 acc, int8* output, int c) {
+    if (bias_data) {
+      acc += bias_data[c];
+    }
+    acc = MultiplyByQuantizedMultiplier(acc, output_multiplier[c],
+                                        output_shift[c]);
+    acc += params.output_offset;
+    acc = std::max(acc, params.quantized_activation_min);
+    acc = std::min(acc, params.quantized_activation_max);
+    output[c] = static_cast<int8_t>(acc);
+  };
+  auto interior = [&](int batch, int out_y, int out_x, int in_y, int in_x) {
+    const int8* input = input_data + Offset(input_shape, batch, in_y, in_x, 0);
+    int8* output = output_data + Offset(output_shape, batch, out_y, out_x, 0);
+    for (int c = 0; c < depth; ++c) {
+      int32 acc = 0;
+      for (int filter_y = 0; filter_y < kFilterSize; ++filter_y) {
+        for (int filter_x = 0; filter_x < kFilterSize; ++filter_x) {
+          const int32 input_value =
+              input[filter_y * row_stride + filter_x * depth + c];
+          const int32 filter_value =
+              filter_data[(filter_y * kFilterSize + filter_x) * depth + c];
+          acc += filter_value * (input_value + input_offset);
+        }
+      }
+      store(acc, output, c);
+    }
+  };
+  auto border = [&](int batch, int out_y, int out_x, int in_y, int in_x) {
+    const int y_begin = std::max(0, -in_y);
+    const int y_end = std::min(kFilterSize, input_height - in_y);
+    const int x_begin = std::max(0, -in_x);
+    const int x_end = std::min(kFilterSize, input_width - in_x);
+    int8* output = output_data + Offset(output_shape, batch, out_y, out_x, 0);
+    for (int c = 0; c < depth; ++c) {
+      int32 acc = 0;
+      for (int filter_y = y_begin; filter_y < y_end; ++filter_y) {
+        for (int filter_x = x_begin; filter_x < x_end; ++filter_x) {
+          const int32 input_value = input_data[Offset(
+              input_shape, batch, in_y + filter_y, in_x + filter_x, c)];
+          const int32 filter_value =
+              filter_data[(filter_y * kFilterSize + filter_x) * depth + c];
+          acc += filter_value * (input_value + input_offset);
+        }
+      }
+      store(acc, output, c);
+    }
+  };
+  optimized_ops::ForEachDepthwisePixel<kFilterSize, kStride>(
+      params, input_shape, output_shape, interior, border);
+}
+
+}  // namespace depthwise_conv_internal
+
+inline void DepthwiseConvPerChannel(
+    const DepthwiseParams& params, const int32* output_multiplier,
+    const int32* output_shift, const RuntimeShape& input_shape,
+    const int8* input_data, const RuntimeShape& filter_shape,
+    const int8* filter_data, const RuntimeShape& bias_shape,
+    const int32* bias_data, const RuntimeShape& output_shape,
+    int8* output_data) {
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK(optimized_ops::HasSpecializedDepthwiseConv(
+      filter_shape.Dims(1), filter_shape.Dims(2), params.stride_height,
+      params.stride_width, params.dilation_height_factor,
+      params.dilation_width_factor, params.depth_multiplier));
+  MatchingDim(filter_shape, 3, output_shape, 3);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_shape.Dims(3));
+  }
+  using depthwise_conv_internal::DepthwiseConvPerChannel;
+  if (filter_shape.Dims(1) == 3) {
+    if (params.stride_height == 1) {
+      DepthwiseConvPerChannel<3, 1>(params, output_multiplier, output_shift,
+                                    input_shape, input_data, filter_shape,
+                                    filter_data, bias_data, output_shape,
+                                    output_data);
+    } else {
+      DepthwiseConvPerChannel<3, 2>(params, output_multiplier, output_shift,
+                                    input_shape, input_data, filter_shape,
+                                    filter_data, bias_data, output_shape,
+                                    output_data);
+    }
+  } else {
+    if (params.stride_height == 1) {
+      DepthwiseConvPerChannel<5, 1>(params, output_multiplier, output_shift,
+                                    input_shape, input_data, filter_shape,
+                                    filter_data, bias_data, output_shape,
+                                    output_data);
+    } else {
+      DepthwiseConvPerChannel<5, 2>(params, output_multiplier, output_shift,
+                                    input_shape, input_data, filter_shape,
+                                    filter_data, bias_data, output_shape,
+                                    output_data);
+    }
+  }
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_DEPTHWISE_CONV_H_
@@ -0,0 +1,241 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_DOT_PRODUCT_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_DOT_PRODUCT_H_
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/kernels/internal/types.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+// Dot products of int8 vectors with int32 accumulation, the inner loop of the
+// optimized int8 kernels. They use SIMD instructions where available:
+//   AVX2 or SSE4.1 on x86 hosts: 16 or 8 products per instruction pair.
+//   Cortex-M DSP extension (e.g. Cortex-M4, M7): 4 products with two SMLAD.
+//   Otherwise portable code, unrolled to 4 inputs at a time.
+// Integer addition is associative, so the results are the same as summing the
+// products in order.
+
+namespace tflite {
+namespace optimized_integer_ops {
+namespace dot_product_internal {
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+
+inline int32 HorizontalSum(__m128i sums) {
+  sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(1, 0, 3, 2)));
+  sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sums);
+}
+
+// Products of 8 int8 pairs, added pairwise into 4 int32 lanes.
+inline __m128i MultiplyAdd8(__m128i input, const int8_t* filter) {
+  const __m128i filter_values = _mm_cvtepi8_epi16(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(filter)));
+  return _mm_madd_epi16(input, filter_values);
+}
+
+inline __m128i LoadInput8(const int8_t* input) {
+  return _mm_cvtepi8_epi16(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input)));
+}
+
+#endif
+
+#if defined(__AVX2__)
+
+inline int32 HorizontalSum(__m256i sums) {
+  return HorizontalSum(_mm_add_epi32(_mm256_castsi256_si128(sums),
+                                     _mm256_extracti128_si256(sums, 1)));
+}
+
+// Products of 16 int8 pairs, added pairwise into 8 int32 lanes.
+inline __m256i MultiplyAdd16(__m256i input, const int8_t* filter) {
+  const __m256i filter_values = _mm256_cvtepi8_epi16(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(filter)));
+  return _mm256_madd_epi16(input, filter_values);
+}
+
+inline __m256i LoadInput16(const int8_t* input) {
+  return _mm256_cvtepi8_epi16(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(input)));
+}
+
+#elif defined(__ARM_FEATURE_DSP)
+
+inline uint32_t Load4(const int8_t* data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+// Sign extends bytes 0 and 2 of `value` into two int16 halves.
+inline uint32_t SignExtendEvenBytes(uint32_t value) {
+  uint32_t result;
+  asm("sxtb16 %0, %1" : "=r"(result) : "r"(value));
+  return result;
+}
+
+// Sign extends bytes 1 and 3 of `value` into two int16 halves.
+inline uint32_t SignExtendOddBytes(uint32_t value) {
+  uint32_t result;
+  asm("sxtb16 %0, %1, ror #8" : "=r"(result) : "r"(value));
+  return result;
+}
+
+// accumulator + a.low * b.low + a.high * b.high, on int16 halves.
+inline int32 DualMultiplyAccumulate(uint32_t a, uint32_t b,
+                                    int32 accumulator) {
+  int32 result;
+  asm("smlad %0, %1, %2, %3"
+      : "=r"(result)
+      : "r"(a), "r"(b), "r"(accumulator));
+  return result;
+}
+
+// Adds the products of the 4 int8 pairs in `input` and `filter`.
+inline int32 MultiplyAdd4(uint32_t input_even, uint32_t input_odd,
+                          const int8_t* filter, int32 accumulator) {
+  const uint32_t filter_values = Load4(filter);
+  accumulator = DualMultiplyAccumulate(
+      input_even, SignExtendEvenBytes(filter_values), accumulator);
+  return DualMultiplyAccumulate(input_odd, SignExtendOddBytes(filter_values),
+                                accumulator);
+}
+
+#endif
+
+}  // namespace dot_product_internal
+
+// Dot products of `input` with the four consecutive filter rows of `depth`
+// values starting at `filter`.
+inline void DotProduct4(const int8_t* input, const int8_t* filter, int depth,
+                        int32* results) {
+  using namespace dot_product_internal;  // NOLINT
+  const int8_t* filter0 = filter;
+  const int8_t* filter1 = filter0 + depth;
+  const int8_t* filter2 = filter1 + depth;
+  const int8_t* filter3 = filter2 + depth;
+  int32 acc0 = 0;
+  int32 acc1 = 0;
+  int32 acc2 = 0;
+  int32 acc3 = 0;
+  int d = 0;
+#if defined(__AVX2__)
+  __m256i sums0 = _mm256_setzero_si256();
+  __m256i sums1 = _mm256_setzero_si256();
+  __m256i sums2 = _mm256_setzero_si256();
+  __m256i sums3 = _mm256_setzero_si256();
+  for (; d + 16 <= depth; d += 16) {
+    const __m256i input_values = LoadInput16(input + d);
+    sums0 = _mm256_add_epi32(sums0, MultiplyAdd16(input_values, filter0 + d));
+    sums1 = _mm256_add_epi32(sums1, MultiplyAdd16(input_values, filter1 + d));
+    sums2 = _mm256_add_epi32(sums2, MultiplyAdd16(input_values, filter2 + d));
+    sums3 = _mm256_add_epi32(sums3, MultiplyAdd16(input_values, filter3 + d));
+  }
+  acc0 = HorizontalSum(sums0);
+  acc1 = HorizontalSum(sums1);
+  acc2 = HorizontalSum(sums2);
+  acc3 = HorizontalSum(sums3);
+#endif
+#if defined(__AVX2__) || defined(__SSE4_1__)
+  __m128i sums0_8 = _mm_setzero_si128();
+  __m128i sums1_8 = _mm_setzero_si128();
+  __m128i sums2_8 = _mm_setzero_si128();
+  __m128i sums3_8 = _mm_setzero_si128();
+  for (; d + 8 <= depth; d += 8) {
+    const __m128i input_values = LoadInput8(input + d);
+    sums0_8 = _mm_add_epi32(sums0_8, MultiplyAdd8(input_values, filter0 + d));
+    sums1_8 = _mm_add_epi32(sums1_8, MultiplyAdd8(input_values, filter1 + d));
+    sums2_8 = _mm_add_epi32(sums2_8, MultiplyAdd8(input_values, filter2 + d));
+    sums3_8 = _mm_add_epi32(sums3_8, MultiplyAdd8(input_values, filter3 + d));
+  }
+  acc0 += HorizontalSum(sums0_8);
+  acc1 += HorizontalSum(sums1_8);
+  acc2 += HorizontalSum(sums2_8);
+  acc3 += HorizontalSum(sums3_8);
+#elif defined(__ARM_FEATURE_DSP)
+  for (; d + 4 <= depth; d += 4) {
+    const uint32_t input_values = Load4(input + d);
+    const uint32_t input_even = SignExtendEvenBytes(input_values);
+    const uint32_t input_odd = SignExtendOddBytes(input_values);
+    acc0 = MultiplyAdd4(input_even, input_odd, filter0 + d, acc0);
+    acc1 = MultiplyAdd4(input_even, input_odd, filter1 + d, acc1);
+    acc2 = MultiplyAdd4(input_even, input_odd, filter2 + d, acc2);
+    acc3 = MultiplyAdd4(input_even, input_odd, filter3 + d, acc3);
+  }
+#else
+  for (; d + 4 <= depth; d += 4) {
+    const int32 input0 = input[d];
+    const int32 input1 = input[d + 1];
+    const int32 input2 = input[d + 2];
+    const int32 input3 = input[d + 3];
+    acc0 += filter0[d] * input0 + filter0[d + 1] * input1 +
+            filter0[d + 2] * input2 + filter0[d + 3] * input3;
+    acc1 += filter1[d] * input0 + filter1[d + 1] * input1 +
+            filter1[d + 2] * input2 + filter1[d + 3] * input3;
+    acc2 += filter2[d] * input0 + filter2[d + 1] * input1 +
+            filter2[d + 2] * input2 + filter2[d + 3] * input3;
+    acc3 += filter3[d] * input0 + filter3[d + 1] * input1 +
+            filter3[d + 2] * input2 + filter3[d + 3] * input3;
+  }
+#endif
+  for (; d < depth; ++d) {
+    const int32 input_value = input[d];
+    acc0 += filter0[d] * input_value;
+    acc1 += filter1[d] * input_value;
+    acc2 += filter2[d] * input_value;
+    acc3 += filter3[d] * input_value;
+  }
+  results[0] = acc0;
+  results[1] = acc1;
+  results[2] = acc2;
+  results[3] = acc3;
+}
+
+inline int32 DotProduct(const int8_t* input, const int8_t* filter,
+                        int depth) {
+  using namespace dot_product_internal;  // NOLINT
+  int32 acc = 0;
+  int d = 0;
+#if defined(__AVX2__) || defined(__SSE4_1__)
+  __m128i sums = _mm_setzero_si128();
+  for (; d + 8 <= depth; d += 8) {
+    sums = _mm_add_epi32(sums, MultiplyAdd8(LoadInput8(input + d), filter + d));
+  }
+  acc = HorizontalSum(sums);
+#elif defined(__ARM_FEATURE_DSP)
+  for (; d + 4 <= depth; d += 4) {
+    const uint32_t input_values = Load4(input + d);
+    acc = MultiplyAdd4(SignExtendEvenBytes(input_values),
+                       SignExtendOddBytes(input_values), filter + d, acc);
+  }
+#endif
+  for (; d < depth; ++d) {
+    acc += filter[d] * static_cast<int32>(input[d]);
+  }
+  return acc;
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_DOT_PRODUCT_H_
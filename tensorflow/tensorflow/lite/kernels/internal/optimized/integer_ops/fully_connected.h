@@ -0,0 +1,133 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_FULLY_CONNECTED_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_FULLY_CONNECTED_H_
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/dot_product.h"
+
+// Int8 fully connected kernel that gives the same results as
+// reference_integer_ops::FullyConnected(), with less work per multiply
+// accumulate:
+//
+//   sum((filter + filter_offset) * (input + input_offset))
+//     = sum(filter * input) + input_offset * sum(filter)
+//       + filter_offset * sum(input) + depth * filter_offset * input_offset
+//
+// The terms that only depend on the constant filter are folded into the bias
+// once with PrecomputeFullyConnectedBias(), and the filter_offset * sum(input)
+// term is computed once per batch instead of once per output. The remaining
+// dot products run on four outputs at a time, so every input load is shared.
+// All sums are int32 like the reference, so the result is the same.
+
+namespace tflite {
+namespace optimized_integer_ops {
+namespace fully_connected_internal {
+
+inline int8_t Requantize(int32 acc, const FullyConnectedParams& params) {
+  acc = MultiplyByQuantizedMultiplier(acc, params.output_multiplier,
+                                      params.output_shift);
+  acc += params.output_offset;
+  acc = std::max(acc, params.quantized_activation_min);
+  acc = std::min(acc, params.quantized_activation_max);
+  return static_cast<int8_t>(acc);
+}
+
+}  // namespace fully_connected_internal
+
+// Computes, for each of the `output_depth` filter rows,
+//   bias + input_offset * sum(filter) + depth * filter_offset * input_offset
+// into `folded_bias`. `bias_data` may be nullptr.
+inline void PrecomputeFullyConnectedBias(int32 input_offset,
+                                         int32 filter_offset,
+                                         const RuntimeShape& filter_shape,
+                                         const int8_t* filter_data,
+                                         const int32* bias_data,
+                                         int32* folded_bias) {
+  const int filter_dim_count = filter_shape.DimensionsCount();
+  const int output_depth = filter_shape.Dims(filter_dim_count - 2);
+  const int accum_depth = filter_shape.Dims(filter_dim_count - 1);
+  for (int out_c = 0; out_c < output_depth; ++out_c) {
+    int32 filter_sum = 0;
+    for (int d = 0; d < accum_depth; ++d) {
+      filter_sum += filter_data[out_c * accum_depth + d];
+    }
+    int32 acc = input_offset * filter_sum +
+                accum_depth * filter_offset * input_offset;
+    if (bias_data) {
+      acc += bias_data[out_c];
+    }
+    folded_bias[out_c] = acc;
+  }
+}
+
+// Same as reference_integer_ops::FullyConnected(), with the bias replaced by
+// the result of PrecomputeFullyConnectedBias() for the same filter and
+// offsets.
+inline void FullyConnected(const FullyConnectedParams& params,
+                           const RuntimeShape& input_shape,
+                           const int8_t* input_data,
+                           const RuntimeShape& filter_shape,
+                           const int8_t* filter_data,
+                           const int32* folded_bias,
+                           const RuntimeShape& output_shape,
+                           int8_t* output_data) {
+  using fully_connected_internal::Requantize;
+  const int32 filter_offset = params.weights_offset;
+  TFLITE_DCHECK_GE(filter_shape.DimensionsCount(), 2);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 2);
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  const int filter_dim_count = filter_shape.DimensionsCount();
+  const int batches = output_shape.Dims(0);
+  const int output_depth = output_shape.Dims(1);
+  TFLITE_DCHECK_LE(output_depth, filter_shape.Dims(filter_dim_count - 2));
+  const int accum_depth = filter_shape.Dims(filter_dim_count - 1);
+  for (int b = 0; b < batches; ++b) {
+    const int8_t* input = input_data + b * accum_depth;
+    int8_t* output = output_data + b * output_depth;
+    // The filter_offset * sum(input) term is the same for every output.
+    int32 input_term = 0;
+    if (filter_offset != 0) {
+      int32 input_sum = 0;
+      for (int d = 0; d < accum_depth; ++d) {
+        input_sum += input[d];
+      }
+      input_term = filter_offset * input_sum;
+    }
+    int out_c = 0;
+    for (; out_c + 4 <= output_depth; out_c += 4) {
+      int32 acc[4];
+      DotProduct4(input, filter_data + out_c * accum_depth, accum_depth, acc);
+      for (int i = 0; i < 4; ++i) {
+        output[out_c + i] =
+            Requantize(acc[i] + folded_bias[out_c + i] + input_term, params);
+      }
+    }
+    for (; out_c < output_depth; ++out_c) {
+      const int32 acc =
+          DotProduct(input, filter_data + out_c * accum_depth, accum_depth);
+      output[out_c] =
+          Requantize(acc + folded_bias[out_c] + input_term, params);
+    }
+  }
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_FULLY_CONNECTED_H_
@@ -0,0 +1,232 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_SOFTMAX_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_SOFTMAX_H_
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+#include "fixedpoint/fixedpoint.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TFLITE_SOFTMAX_AVX2
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define TFLITE_SOFTMAX_SSE4_1
+#endif
+
+// Quantized softmax with 8-bit input that looks up exp() instead of
+// computing it. The difference between an input and the maximum of its row
+// is one of only 256 values, so exp() of each, as the Q0.31 value
+// reference_ops::Softmax() computes, is stored once in a table filled by
+// PopulateSoftmaxExpTable(). A row then takes one pass over the input for its
+// maximum, one for the sum of the looked up values and one that scales each
+// looked up value by the reciprocal of the sum. Rows longer than the table,
+// e.g. classification heads with 1000 classes, first scale the whole table
+// into a table of outputs for the row, so that each output is one lookup.
+//
+// On x86 hosts the maximum is taken over 16 or 32 inputs at a time, and with
+// AVX2 the sum gathers 8 table values at a time.
+//
+// The outputs are the same as those of reference_ops::Softmax().
+
+namespace tflite {
+namespace optimized_integer_ops {
+
+// The number of int32 values PopulateSoftmaxExpTable() writes.
+constexpr int kSoftmaxExpTableSize = 256;
+
+// Fills table[d] with exp() of the input d steps below the row maximum, for
+// the beta and input scale that `params` was computed for. Differences
+// smaller than params.diff_min get 0, which gives them the minimum output.
+inline void PopulateSoftmaxExpTable(const SoftmaxParams& params,
+                                    int32* table) {
+  static const int kScaledDiffIntegerBits = 5;
+  using FixedPointScaledDiff =
+      gemmlowp::FixedPoint<int32, kScaledDiffIntegerBits>;
+  for (int d = 0; d < kSoftmaxExpTableSize; ++d) {
+    const int32 input_diff = -d;
+    if (input_diff >= params.diff_min) {
+      const int32 input_diff_rescaled =
+          MultiplyByQuantizedMultiplierGreaterThanOne(
+              input_diff, params.input_multiplier, params.input_left_shift);
+      table[d] = gemmlowp::exp_on_negative_values(
+                     FixedPointScaledDiff::FromRaw(input_diff_rescaled))
+                     .raw();
+    } else {
+      table[d] = 0;
+    }
+  }
+}
+
+namespace softmax_internal {
+
+// The number of integer bits of the sum of the exp() values.
+constexpr int kAccumulationIntegerBits = 12;
+
+#if defined(TFLITE_SOFTMAX_AVX2) || defined(TFLITE_SOFTMAX_SSE4_1)
+inline int8 MaxOfLanes(__m128i maxes) {
+  maxes = _mm_max_epi8(maxes, _mm_srli_si128(maxes, 8));
+  maxes = _mm_max_epi8(maxes, _mm_srli_si128(maxes, 4));
+  maxes = _mm_max_epi8(maxes, _mm_srli_si128(maxes, 2));
+  maxes = _mm_max_epi8(maxes, _mm_srli_si128(maxes, 1));
+  return static_cast<int8>(_mm_cvtsi128_si32(maxes));
+}
+#endif
+
+template <typename InputT>
+inline InputT MaxInRow(const InputT* input, int depth) {
+  InputT max_in_row = std::numeric_limits<InputT>::min();
+  for (int c = 0; c < depth; ++c) {
+    max_in_row = std::max(max_in_row, input[c]);
+  }
+  return max_in_row;
+}
+
+template <>
+inline int8 MaxInRow(const int8* input, int depth) {
+  int8 max_in_row = std::numeric_limits<int8>::min();
+  int c = 0;
+#if defined(TFLITE_SOFTMAX_AVX2)
+  if (depth >= 32) {
+    __m256i maxes = _mm256_set1_epi8(max_in_row);
+    for (; c <= depth - 32; c += 32) {
+      maxes = _mm256_max_epi8(
+          maxes,
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + c)));
+    }
+    max_in_row = MaxOfLanes(_mm_max_epi8(_mm256_castsi256_si128(maxes),
+                                         _mm256_extracti128_si256(maxes, 1)));
+  }
+#elif defined(TFLITE_SOFTMAX_SSE4_1)
+  if (depth >= 16) {
+    __m128i maxes = _mm_set1_epi8(max_in_row);
+    for (; c <= depth - 16; c += 16) {
+      maxes = _mm_max_epi8(
+          maxes, _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + c)));
+    }
+    max_in_row = MaxOfLanes(maxes);
+  }
+#endif
+  for (; c < depth; ++c) {
+    max_in_row = std::max(max_in_row, input[c]);
+  }
+  return max_in_row;
+}
+
+// The sum of the exp() values of a row, rescaled to kAccumulationIntegerBits
+// one by one like in reference_ops::Softmax().
+template <typename InputT>
+inline int32 SumOfExps(const int32* exp_table, InputT max_in_row,
+                       const InputT* input, int depth) {
+  int32 sum = 0;
+  int c = 0;
+#if defined(TFLITE_SOFTMAX_AVX2)
+  if (std::is_same<InputT, int8>::value && depth >= 8) {
+    const __m256i max_values = _mm256_set1_epi32(max_in_row);
+    const __m256i ones = _mm256_set1_epi32(1);
+    __m256i sums = _mm256_setzero_si256();
+    for (; c <= depth - 8; c += 8) {
+      const __m256i values = _mm256_cvtepi8_epi32(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + c)));
+      const __m256i exps = _mm256_i32gather_epi32(
+          exp_table, _mm256_sub_epi32(max_values, values), 4);
+      // RoundingDivideByPOT() of the non-negative values: round up when the
+      // highest bit shifted out is set.
+      const __m256i rescaled = _mm256_add_epi32(
+          _mm256_srai_epi32(exps, kAccumulationIntegerBits),
+          _mm256_and_si256(
+              _mm256_srli_epi32(exps, kAccumulationIntegerBits - 1), ones));
+      sums = _mm256_add_epi32(sums, rescaled);
+    }
+    __m128i sums128 = _mm_add_epi32(_mm256_castsi256_si128(sums),
+                                    _mm256_extracti128_si256(sums, 1));
+    sums128 = _mm_add_epi32(sums128, _mm_srli_si128(sums128, 8));
+    sums128 = _mm_add_epi32(sums128, _mm_srli_si128(sums128, 4));
+    sum = _mm_cvtsi128_si32(sums128);
+  }
+#endif
+  for (; c < depth; ++c) {
+    sum += gemmlowp::RoundingDivideByPOT(exp_table[max_in_row - input[c]],
+                                         kAccumulationIntegerBits);
+  }
+  return sum;
+}
+
+}  // namespace softmax_internal
+
+// `exp_table` was filled by PopulateSoftmaxExpTable() for `params`.
+template <typename InputT, typename OutputT>
+inline void Softmax(const SoftmaxParams& params, const int32* exp_table,
+                    const RuntimeShape& input_shape, const InputT* input_data,
+                    const RuntimeShape& output_shape, OutputT* output_data) {
+  static_assert(sizeof(InputT) == 1, "The table covers 8-bit inputs only.");
+  using FixedPoint0 = gemmlowp::FixedPoint<int32, 0>;
+  using softmax_internal::kAccumulationIntegerBits;
+  static constexpr int32 kMinOutput = std::numeric_limits<OutputT>::min();
+  static constexpr int32 kMaxOutput = std::numeric_limits<OutputT>::max();
+
+  const int trailing_dim = input_shape.DimensionsCount() - 1;
+  const int outer_size =
+      MatchingFlatSizeSkipDim(input_shape, trailing_dim, output_shape);
+  const int depth =
+      MatchingDim(input_shape, trailing_dim, output_shape, trailing_dim);
+
+  for (int i = 0; i < outer_size; ++i) {
+    const InputT* input = input_data + i * depth;
+    OutputT* output = output_data + i * depth;
+    const InputT max_in_row = softmax_internal::MaxInRow(input, depth);
+    const int32 sum_of_exps =
+        softmax_internal::SumOfExps(exp_table, max_in_row, input, depth);
+
+    int num_bits_over_unit;
+    const FixedPoint0 shifted_scale = FixedPoint0::FromRaw(
+        GetReciprocal(sum_of_exps, kAccumulationIntegerBits,
+                      &num_bits_over_unit));
+    const int output_shift =
+        num_bits_over_unit + 31 - static_cast<int>(sizeof(OutputT) * 8);
+    auto scale = [&](int32 exp_value) {
+      const int32 unsat_output = gemmlowp::RoundingDivideByPOT(
+          (shifted_scale * FixedPoint0::FromRaw(exp_value)).raw(),
+          output_shift);
+      return static_cast<OutputT>(
+          std::max(std::min(unsat_output + kMinOutput, kMaxOutput),
+                   kMinOutput));
+    };
+
+    if (depth > kSoftmaxExpTableSize) {
+      OutputT output_table[kSoftmaxExpTableSize];
+      for (int d = 0; d < kSoftmaxExpTableSize; ++d) {
+        output_table[d] = scale(exp_table[d]);
+      }
+      for (int c = 0; c < depth; ++c) {
+        output[c] = output_table[max_in_row - input[c]];
+      }
+    } else {
+      for (int c = 0; c < depth; ++c) {
+        output[c] = scale(exp_table[max_in_row - input[c]]);
+      }
+    }
+  }
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_SOFTMAX_H_
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/kernels/internal/cppmath.h"
@@ -48,6 +49,46 @@ inline float ActivationValFloat(TfLiteFusedActivation act, float a) {
                 // activation is added to the enum and not handled here).
 }
 
+// An int8 activation has only 256 possible inputs, so it can be computed once
+// per input in Prepare and looked up in Eval. The table holds the output for
+// every input, indexed by the input bits as uint8_t.
+constexpr int kInt8LookupTableSize = 256;
+
+// Fills `table` with `transform`, a function that applies the activation to
+// `size` inputs like the reference kernels do, so the looked up outputs are
+// the same as the reference.
+template <typename Transform>
+inline void PopulateInt8LookupTable(const Transform& transform,
+                                    int8_t* table) {
+  int8_t inputs[kInt8LookupTableSize];
+  for (int i = 0; i < kInt8LookupTableSize; ++i) {
+    inputs[i] = static_cast<int8_t>(i);
+  }
+  transform(kInt8LookupTableSize, inputs, table);
+}
+
+// Replaces every input with its table entry. Four elements at a time, so the
+// loads of a word of inputs and the stores of a word of outputs overlap with
+// the lookups.
+inline void LookupInt8(const int8_t* table, int size, const int8_t* input,
+                       int8_t* output) {
+  const uint8_t* indices = reinterpret_cast<const uint8_t*>(input);
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const int8_t output0 = table[indices[i]];
+    const int8_t output1 = table[indices[i + 1]];
+    const int8_t output2 = table[indices[i + 2]];
+    const int8_t output3 = table[indices[i + 3]];
+    output[i] = output0;
+    output[i + 1] = output1;
+    output[i + 2] = output2;
+    output[i + 3] = output3;
+  }
+  for (; i < size; ++i) {
+    output[i] = table[indices[i]];
+  }
+}
+
 }  // namespace micro
 }  // namespace ops
 }  // namespace tflite
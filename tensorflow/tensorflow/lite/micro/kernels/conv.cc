@@ -18,6 +18,8 @@ limitations under the License.
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/conv.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/conv.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
@@ -29,6 +31,14 @@ namespace ops {
 namespace micro {
 namespace conv {
 
+// Upper bound for the im2col scratch buffer of each CONV_2D, in bytes. The
+// buffer holds the input patches of as many output pixels as fit, and always
+// of at least one. Larger tiles load each filter row fewer times; define this
+// at build time to trade arena size for speed.
+#ifndef TF_LITE_MICRO_CONV_IM2COL_BYTES
+#define TF_LITE_MICRO_CONV_IM2COL_BYTES 4096
+#endif
+
 constexpr int kInputTensor = 0;
 constexpr int kFilterTensor = 1;
 constexpr int kBiasTensor = 2;
@@ -55,6 +65,15 @@ struct OpData {
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
   int32_t output_activation_max;
+
+  // Bias with input_offset * sum(filter) folded in, for int8 with a constant
+  // filter. Otherwise nullptr and the reference kernel is used.
+  int32_t* folded_bias;
+
+  // Scratch buffer with the patch rows of `im2col_tile_pixels` output pixels,
+  // or -1 when the input can be used as is.
+  int im2col_index;
+  int im2col_tile_pixels;
 };
 
 inline PaddingType RuntimePaddingType(TfLitePadding padding) {
@@ -107,6 +126,64 @@ TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+TfLiteStatus PrepareFoldedBias(TfLiteContext* context, TfLiteNode* node,
+                               OpData* data) {
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  const TfLiteTensor* filter = GetInput(context, node, kFilterTensor);
+  const TfLiteTensor* bias = GetOptionalInputTensor(context, node, kBiasTensor);
+  data->folded_bias = nullptr;
+  if (input->type != kTfLiteInt8 || filter->allocation_type != kTfLiteMmapRo ||
+      (bias != nullptr && bias->allocation_type != kTfLiteMmapRo)) {
+    return kTfLiteOk;
+  }
+  const int num_channels = filter->dims->data[kConvQuantizedDimension];
+  TF_LITE_ENSURE_STATUS(context->AllocatePersistentBuffer(
+      context, num_channels * sizeof(int32_t),
+      reinterpret_cast<void**>(&data->folded_bias)));
+  optimized_integer_ops::PrecomputeConvBias(
+      -input->params.zero_point, GetTensorShape(filter),
+      GetTensorData<int8_t>(filter), GetTensorData<int32_t>(bias),
+      data->folded_bias);
+  return kTfLiteOk;
+}
+
+// Requests the im2col buffer for the optimized kernels, with as many output
+// pixels per tile as fit in TF_LITE_MICRO_CONV_IM2COL_BYTES.
+TfLiteStatus PrepareIm2col(TfLiteContext* context, TfLiteNode* node,
+                           const TfLiteConvParams* params, OpData* data) {
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  const TfLiteTensor* filter = GetInput(context, node, kFilterTensor);
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+  data->im2col_index = -1;
+  data->im2col_tile_pixels = 0;
+  if (input->type == kTfLiteInt8 && data->folded_bias == nullptr) {
+    return kTfLiteOk;
+  }
+  ConvParams op_params;
+  op_params.stride_width = params->stride_width;
+  op_params.stride_height = params->stride_height;
+  op_params.padding_values.width = data->padding.width;
+  op_params.padding_values.height = data->padding.height;
+  const RuntimeShape filter_shape = GetTensorShape(filter);
+  const RuntimeShape output_shape = GetTensorShape(output);
+  if (optimized_ops::Im2colIsIdentity(op_params, GetTensorShape(input),
+                                      filter_shape, output_shape)) {
+    return kTfLiteOk;
+  }
+  const size_t element_size =
+      input->type == kTfLiteFloat32 ? sizeof(float) : sizeof(uint8_t);
+  const size_t row_bytes =
+      optimized_ops::Im2colRowSize(filter_shape) * element_size;
+  const int pixel_count =
+      output_shape.Dims(0) * output_shape.Dims(1) * output_shape.Dims(2);
+  data->im2col_tile_pixels = std::max<int>(
+      1, std::min<int>(pixel_count,
+                       TF_LITE_MICRO_CONV_IM2COL_BYTES / row_bytes));
+  TFLITE_DCHECK(context->RequestScratchBufferInArena != nullptr);
+  return context->RequestScratchBufferInArena(
+      context, data->im2col_tile_pixels * row_bytes, &data->im2col_index);
+}
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
   void* data = nullptr;
@@ -163,16 +240,18 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                       affine_quantization->zero_point->size);
   }
 
-  return CalculateOpData(context, node, params, input_width, input_height,
-                         filter_width, filter_height, output_width,
-                         output_height, input->type, data);
-}  // namespace conv
+  TF_LITE_ENSURE_STATUS(CalculateOpData(
+      context, node, params, input_width, input_height, filter_width,
+      filter_height, output_width, output_height, input->type, data));
+  TF_LITE_ENSURE_STATUS(PrepareFoldedBias(context, node, data));
+  return PrepareIm2col(context, node, params, data);
+}
 
 void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                    TfLiteConvParams* params, const OpData& data,
                    const TfLiteTensor* input, const TfLiteTensor* filter,
-                   const TfLiteTensor* bias, TfLiteTensor* im2col,
-                   TfLiteTensor* hwcn_weights, TfLiteTensor* output) {
+                   const TfLiteTensor* bias, uint8_t* im2col,
+                   TfLiteTensor* output) {
   const int32_t input_offset = -input->params.zero_point;
   const int32_t filter_offset = -filter->params.zero_point;
   const int32_t output_offset = output->params.zero_point;
@@ -193,12 +272,12 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
   op_params.output_shift = -data.output_shift;
   op_params.quantized_activation_min = data.output_activation_min;
   op_params.quantized_activation_max = data.output_activation_max;
-  reference_ops::Conv(op_params, GetTensorShape(input),
+  optimized_ops::Conv(op_params, GetTensorShape(input),
                       GetTensorData<uint8_t>(input), GetTensorShape(filter),
                       GetTensorData<uint8_t>(filter), GetTensorShape(bias),
                       GetTensorData<int32_t>(bias), GetTensorShape(output),
-                      GetTensorData<uint8_t>(output), GetTensorShape(im2col),
-                      GetTensorData<uint8_t>(im2col), nullptr);
+                      GetTensorData<uint8_t>(output), data.im2col_tile_pixels,
+                      im2col);
 }
 
 void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
@@ -206,7 +285,7 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
                              const TfLiteTensor* input,
                              const TfLiteTensor* filter,
                              const TfLiteTensor* bias, TfLiteTensor* output,
-                             TfLiteTensor* im2col) {
+                             int8_t* im2col) {
   // TODO(b/154032858): Investigate removing extra copies.
   ConvParams op_params;
   op_params.input_offset = -input->params.zero_point;
@@ -220,6 +299,15 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
   op_params.quantized_activation_min = data.output_activation_min;
   op_params.quantized_activation_max = data.output_activation_max;
 
+  if (data.folded_bias != nullptr) {
+    optimized_integer_ops::ConvPerChannel(
+        op_params, data.per_channel_output_multiplier,
+        data.per_channel_output_shift, GetTensorShape(input),
+        GetTensorData<int8>(input), GetTensorShape(filter),
+        GetTensorData<int8>(filter), data.folded_bias, GetTensorShape(output),
+        GetTensorData<int8>(output), data.im2col_tile_pixels, im2col);
+    return;
+  }
   reference_integer_ops::ConvPerChannel(
       op_params, data.per_channel_output_multiplier,
       data.per_channel_output_shift, GetTensorShape(input),
@@ -232,8 +320,8 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
 void EvalFloat(TfLiteContext* context, TfLiteNode* node,
                TfLiteConvParams* params, const OpData& data,
                const TfLiteTensor* input, const TfLiteTensor* filter,
-               const TfLiteTensor* bias, TfLiteTensor* im2col,
-               TfLiteTensor* hwcn_weights, TfLiteTensor* output) {
+               const TfLiteTensor* bias, float* im2col,
+               TfLiteTensor* output) {
   float output_activation_min, output_activation_max;
   CalculateActivationRange(params->activation, &output_activation_min,
                            &output_activation_max);
@@ -249,12 +337,12 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
 
-  reference_ops::Conv(op_params, GetTensorShape(input),
+  optimized_ops::Conv(op_params, GetTensorShape(input),
                       GetTensorData<float>(input), GetTensorShape(filter),
                       GetTensorData<float>(filter), GetTensorShape(bias),
                       GetTensorData<float>(bias), GetTensorShape(output),
-                      GetTensorData<float>(output), GetTensorShape(im2col),
-                      GetTensorData<float>(im2col));
+                      GetTensorData<float>(output), data.im2col_tile_pixels,
+                      im2col);
 }
 
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
@@ -268,18 +356,24 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TFLITE_DCHECK(node->user_data != nullptr);
   const OpData& data = *(static_cast<const OpData*>(node->user_data));
 
+  void* im2col = nullptr;
+  if (data.im2col_index >= 0) {
+    TFLITE_DCHECK(context->GetScratchBuffer != nullptr);
+    im2col = context->GetScratchBuffer(context, data.im2col_index);
+  }
+
   switch (input->type) {  // Already know in/out types are same.
     case kTfLiteFloat32:
-      EvalFloat(context, node, params, data, input, filter, bias, nullptr,
-                nullptr, output);
+      EvalFloat(context, node, params, data, input, filter, bias,
+                static_cast<float*>(im2col), output);
       break;
     case kTfLiteInt8:
       EvalQuantizedPerChannel(context, node, params, data, input, filter, bias,
-                              output, nullptr);
+                              output, static_cast<int8_t*>(im2col));
       break;
     case kTfLiteUInt8:
-      EvalQuantized(context, node, params, data, input, filter, bias, nullptr,
-                    nullptr, output);
+      EvalQuantized(context, node, params, data, input, filter, bias,
+                    static_cast<uint8_t*>(im2col), output);
       break;
     default:
       TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
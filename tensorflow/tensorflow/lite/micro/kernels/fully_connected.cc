@@ -18,6 +18,8 @@ limitations under the License.
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
@@ -29,6 +31,14 @@ namespace micro {
 namespace fully_connected {
 namespace {
 
+// The largest float weights that are packed into the arena for the optimized
+// kernel, in bytes per layer. The packed copy lives in RAM next to the
+// weights in flash, so larger layers keep the reference kernel. Can be
+// changed at build time.
+#ifndef TF_LITE_MICRO_FULLY_CONNECTED_PACK_BYTES
+#define TF_LITE_MICRO_FULLY_CONNECTED_PACK_BYTES 16384
+#endif
+
 struct OpData {
   // The scaling factor from input to output (aka the 'real multiplier') can
   // be represented as a fixed point multiplier plus a left shift.
@@ -40,6 +50,14 @@ struct OpData {
   int32_t output_activation_max;
   // The index of the temporary tensor where the quantized inputs are cached.
   int input_quantized_index;
+  // Bias with the zero point terms that only depend on the weights folded
+  // in, one per output channel. Only set for int8 with constant weights,
+  // otherwise the reference kernel is used.
+  int32_t* folded_bias;
+  // Float weights packed for optimized_ops::FullyConnected(). Only set with
+  // constant weights of at most TF_LITE_MICRO_FULLY_CONNECTED_PACK_BYTES and
+  // at least one full block of output channels.
+  float* packed_weights;
 };
 
 constexpr int kInputTensor = 0;
@@ -68,6 +86,54 @@ TfLiteStatus CalculateOpData(TfLiteContext* context,
   return status;
 }
 
+TfLiteStatus PrepareFoldedBias(TfLiteContext* context,
+                               const TfLiteTensor* input,
+                               const TfLiteTensor* filter,
+                               const TfLiteTensor* bias, OpData* data) {
+  data->folded_bias = nullptr;
+  if (input->type != kTfLiteInt8 || filter->allocation_type != kTfLiteMmapRo ||
+      (bias != nullptr && bias->allocation_type != kTfLiteMmapRo) ||
+      NumDimensions(filter) < 2) {
+    return kTfLiteOk;
+  }
+  const RuntimeShape filter_shape = GetTensorShape(filter);
+  const int output_depth =
+      filter_shape.Dims(filter_shape.DimensionsCount() - 2);
+  void* buffer = nullptr;
+  TF_LITE_ENSURE_STATUS(context->AllocatePersistentBuffer(
+      context, output_depth * sizeof(int32_t), &buffer));
+  data->folded_bias = static_cast<int32_t*>(buffer);
+  optimized_integer_ops::PrecomputeFullyConnectedBias(
+      -input->params.zero_point, -filter->params.zero_point, filter_shape,
+      GetTensorData<int8_t>(filter), GetTensorData<int32_t>(bias),
+      data->folded_bias);
+  return kTfLiteOk;
+}
+
+TfLiteStatus PreparePackedWeights(TfLiteContext* context,
+                                  const TfLiteTensor* input,
+                                  const TfLiteTensor* filter, OpData* data) {
+  data->packed_weights = nullptr;
+  if (input->type != kTfLiteFloat32 ||
+      filter->allocation_type != kTfLiteMmapRo || NumDimensions(filter) < 2) {
+    return kTfLiteOk;
+  }
+  const RuntimeShape filter_shape = GetTensorShape(filter);
+  const size_t packed_bytes =
+      optimized_ops::FullyConnectedPackedSize(filter_shape) * sizeof(float);
+  if (packed_bytes == 0 ||
+      packed_bytes > TF_LITE_MICRO_FULLY_CONNECTED_PACK_BYTES) {
+    return kTfLiteOk;
+  }
+  void* buffer = nullptr;
+  TF_LITE_ENSURE_STATUS(
+      context->AllocatePersistentBuffer(context, packed_bytes, &buffer));
+  data->packed_weights = static_cast<float*>(buffer);
+  optimized_ops::PackFullyConnectedWeights(
+      filter_shape, GetTensorData<float>(filter), data->packed_weights);
+  return kTfLiteOk;
+}
+
 }  // namespace
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -97,8 +163,11 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_MSG(context, input->type == filter->type,
                      "Hybrid models are not supported on TFLite Micro.");
 
-  return CalculateOpData(context, params->activation, input->type, input,
-                         filter, bias, output, data);
+  TF_LITE_ENSURE_STATUS(CalculateOpData(context, params->activation,
+                                        input->type, input, filter, bias,
+                                        output, data));
+  TF_LITE_ENSURE_STATUS(PreparePackedWeights(context, input, filter, data));
+  return PrepareFoldedBias(context, input, filter, bias, data);
 }
 
 TfLiteStatus EvalQuantizedInt8(TfLiteContext* context, TfLiteNode* node,
@@ -115,6 +184,13 @@ TfLiteStatus EvalQuantizedInt8(TfLiteContext* context, TfLiteNode* node,
   op_params.quantized_activation_min = data.output_activation_min;
   op_params.quantized_activation_max = data.output_activation_max;
 
+  if (data.folded_bias != nullptr) {
+    optimized_integer_ops::FullyConnected(
+        op_params, GetTensorShape(input), GetTensorData<int8_t>(input),
+        GetTensorShape(filter), GetTensorData<int8_t>(filter), data.folded_bias,
+        GetTensorShape(output), GetTensorData<int8_t>(output));
+    return kTfLiteOk;
+  }
   reference_integer_ops::FullyConnected(
       op_params, GetTensorShape(input), GetTensorData<int8_t>(input),
       GetTensorShape(filter), GetTensorData<int8_t>(filter),
@@ -164,7 +240,7 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
 }
 
 TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
-                       TfLiteFusedActivation activation,
+                       const OpData& data, TfLiteFusedActivation activation,
                        const TfLiteTensor* input, const TfLiteTensor* filter,
                        const TfLiteTensor* bias, TfLiteTensor* output) {
   float output_activation_min, output_activation_max;
@@ -173,6 +249,14 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
   tflite::FullyConnectedParams op_params;
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
+  if (data.packed_weights != nullptr) {
+    optimized_ops::FullyConnected(
+        op_params, GetTensorShape(input), GetTensorData<float>(input),
+        GetTensorShape(filter), GetTensorData<float>(filter),
+        data.packed_weights, GetTensorShape(bias), GetTensorData<float>(bias),
+        GetTensorShape(output), GetTensorData<float>(output));
+    return kTfLiteOk;
+  }
   tflite::reference_ops::FullyConnected(
       op_params, GetTensorShape(input), GetTensorData<float>(input),
       GetTensorShape(filter), GetTensorData<float>(filter),
@@ -197,8 +281,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   // Checks in Prepare ensure input, output and filter types are all the same.
   switch (input->type) {
     case kTfLiteFloat32:
-      return EvalFloat(context, node, params->activation, input, filter, bias,
-                       output);
+      return EvalFloat(context, node, data, params->activation, input, filter,
+                       bias, output);
     case kTfLiteInt8:
       return EvalQuantizedInt8(context, node, data, input, filter, bias,
                                output);
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/op_macros.h"
+#include "tensorflow/lite/micro/kernels/activation_utils.h"
 
 namespace tflite {
 namespace ops {
@@ -37,6 +38,8 @@ struct OpData {
   int32_t input_range_radius;
   int32_t input_multiplier;
   int input_left_shift;
+  // The output for every int8 input, see PopulateInt8LookupTable().
+  int8_t* table;
 };
 
 TfLiteStatus CalculateArithmeticOpData(TfLiteContext* context, TfLiteNode* node,
@@ -48,6 +51,7 @@ TfLiteStatus CalculateArithmeticOpData(TfLiteContext* context, TfLiteNode* node,
   if (input->type == kTfLiteInt8) {
     TF_LITE_ENSURE_EQ(context, output->params.zero_point,
                       std::numeric_limits<int8_t>::min());
+    TF_LITE_ENSURE(context, output->params.scale == 1. / 256);
 
     static constexpr int kInputIntegerBits = 4;
     const double input_real_multiplier =
@@ -64,11 +68,46 @@ TfLiteStatus CalculateArithmeticOpData(TfLiteContext* context, TfLiteNode* node,
 }
 }  // namespace
 
+void* LogisticInit(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  void* data = nullptr;
+  if (context->AllocatePersistentBuffer(context, sizeof(OpData), &data) ==
+      kTfLiteError) {
+    return nullptr;
+  }
+  return data;
+}
+
+TfLiteStatus LogisticPrepare(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+  TF_LITE_ENSURE_STATUS(CalculateArithmeticOpData(context, node, data));
+
+  data->table = nullptr;
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  if (input->type == kTfLiteInt8) {
+    void* table = nullptr;
+    TF_LITE_ENSURE_STATUS(context->AllocatePersistentBuffer(
+        context, kInt8LookupTableSize, &table));
+    data->table = static_cast<int8_t*>(table);
+    const int32_t input_zero_point = input->params.zero_point;
+    PopulateInt8LookupTable(
+        [&](int size, const int8_t* inputs, int8_t* outputs) {
+          reference_integer_ops::Logistic(
+              input_zero_point, data->input_range_radius,
+              data->input_multiplier, data->input_left_shift, size, inputs,
+              outputs);
+        },
+        data->table);
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus LogisticEval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* input = GetInput(context, node, kInputTensor);
   TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
-  OpData data;
-  CalculateArithmeticOpData(context, node, &data);
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
 
   if (input->type == kTfLiteFloat32) {
     switch (output->type) {
@@ -87,11 +126,8 @@ TfLiteStatus LogisticEval(TfLiteContext* context, TfLiteNode* node) {
   } else if (input->type == kTfLiteInt8) {
     switch (output->type) {
       case kTfLiteInt8: {
-        reference_integer_ops::Logistic(
-            input->params.zero_point, data.input_range_radius,
-            data.input_multiplier, data.input_left_shift,
-            NumElements(input->dims), GetTensorData<int8_t>(input),
-            GetTensorData<int8_t>(output));
+        LookupInt8(data.table, NumElements(input->dims),
+                   GetTensorData<int8_t>(input), GetTensorData<int8_t>(output));
         return kTfLiteOk;
       }
       default:
@@ -114,9 +150,9 @@ TfLiteStatus LogisticEval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace activations
 
 TfLiteRegistration* Register_LOGISTIC() {
-  static TfLiteRegistration r = {/*init=*/nullptr,
+  static TfLiteRegistration r = {/*init=*/activations::LogisticInit,
                                  /*free=*/nullptr,
-                                 /*prepare=*/nullptr,
+                                 /*prepare=*/activations::LogisticPrepare,
                                  /*invoke=*/activations::LogisticEval,
                                  /*profiling_string=*/nullptr,
                                  /*builtin_code=*/0,
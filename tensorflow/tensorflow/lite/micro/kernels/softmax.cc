@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/softmax.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
@@ -29,6 +30,13 @@ namespace micro {
 namespace activations {
 namespace {
 
+struct OpData {
+  SoftmaxParams params;
+  // exp() of every difference to the row maximum for 8-bit inputs, see
+  // optimized_integer_ops::PopulateSoftmaxExpTable().
+  int32_t* exp_table;
+};
+
 TfLiteStatus CalculateSoftmaxParams(TfLiteContext* context,
                                     const TfLiteTensor* input,
                                     TfLiteTensor* output,
@@ -72,12 +80,41 @@ TfLiteStatus CalculateSoftmaxParams(TfLiteContext* context,
 
 }  // namespace
 
+void* SoftmaxInit(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  void* data = nullptr;
+  if (context->AllocatePersistentBuffer(context, sizeof(OpData), &data) ==
+      kTfLiteError) {
+    return nullptr;
+  }
+  return data;
+}
+
 TfLiteStatus SoftmaxPrepare(TfLiteContext* context, TfLiteNode* node) {
+  auto* params = static_cast<TfLiteSoftmaxParams*>(node->builtin_data);
+
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 1);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
   const TfLiteTensor* input = GetInput(context, node, 0);
   TF_LITE_ENSURE(context, NumDimensions(input) >= 1);
+  TfLiteTensor* output = GetOutput(context, node, 0);
 
+  TFLITE_DCHECK(node->user_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+  TF_LITE_ENSURE_STATUS(
+      CalculateSoftmaxParams(context, input, output, params, &data->params));
+
+  data->exp_table = nullptr;
+  if (input->type == kTfLiteUInt8 || input->type == kTfLiteInt8) {
+    void* exp_table = nullptr;
+    TF_LITE_ENSURE_STATUS(context->AllocatePersistentBuffer(
+        context,
+        optimized_integer_ops::kSoftmaxExpTableSize * sizeof(int32_t),
+        &exp_table));
+    data->exp_table = static_cast<int32_t*>(exp_table);
+    optimized_integer_ops::PopulateSoftmaxExpTable(data->params,
+                                                    data->exp_table);
+  }
   return kTfLiteOk;
 }
 
@@ -90,42 +127,42 @@ void SoftmaxFloat(const TfLiteTensor* input, TfLiteTensor* output,
 }
 
 void SoftmaxQuantized(const TfLiteTensor* input, TfLiteTensor* output,
-                      const SoftmaxParams& op_data) {
+                      const OpData& data) {
   if (input->type == kTfLiteUInt8) {
-    tflite::reference_ops::Softmax(
-        op_data, GetTensorShape(input), GetTensorData<uint8_t>(input),
-        GetTensorShape(output), GetTensorData<uint8_t>(output));
+    tflite::optimized_integer_ops::Softmax(
+        data.params, data.exp_table, GetTensorShape(input),
+        GetTensorData<uint8_t>(input), GetTensorShape(output),
+        GetTensorData<uint8_t>(output));
   } else {
     if (output->type == kTfLiteInt16) {
-      tflite::reference_ops::Softmax(
-          op_data, GetTensorShape(input), GetTensorData<int8_t>(input),
-          GetTensorShape(output), GetTensorData<int16_t>(output));
+      tflite::optimized_integer_ops::Softmax(
+          data.params, data.exp_table, GetTensorShape(input),
+          GetTensorData<int8_t>(input), GetTensorShape(output),
+          GetTensorData<int16_t>(output));
     } else {
-      tflite::reference_ops::Softmax(
-          op_data, GetTensorShape(input), GetTensorData<int8_t>(input),
-          GetTensorShape(output), GetTensorData<int8_t>(output));
+      tflite::optimized_integer_ops::Softmax(
+          data.params, data.exp_table, GetTensorShape(input),
+          GetTensorData<int8_t>(input), GetTensorShape(output),
+          GetTensorData<int8_t>(output));
     }
   }
 }
 
 TfLiteStatus SoftmaxEval(TfLiteContext* context, TfLiteNode* node) {
-  auto* params = static_cast<TfLiteSoftmaxParams*>(node->builtin_data);
-
   const TfLiteTensor* input = GetInput(context, node, 0);
   TfLiteTensor* output = GetOutput(context, node, 0);
 
-  SoftmaxParams op_data;
-  TF_LITE_ENSURE_STATUS(
-      CalculateSoftmaxParams(context, input, output, params, &op_data));
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
 
   switch (input->type) {
     case kTfLiteFloat32: {
-      SoftmaxFloat(input, output, op_data);
+      SoftmaxFloat(input, output, data.params);
       return kTfLiteOk;
     }
     case kTfLiteInt8:
     case kTfLiteUInt8: {
-      SoftmaxQuantized(input, output, op_data);
+      SoftmaxQuantized(input, output, data);
       return kTfLiteOk;
     }
     default:
@@ -137,7 +174,7 @@ TfLiteStatus SoftmaxEval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace activations
 
 TfLiteRegistration* Register_SOFTMAX() {
-  static TfLiteRegistration r = {/*init=*/nullptr,
+  static TfLiteRegistration r = {/*init=*/activations::SoftmaxInit,
                                  /*free=*/nullptr,
                                  /*prepare=*/activations::SoftmaxPrepare,
                                  /*invoke=*/activations::SoftmaxEval,
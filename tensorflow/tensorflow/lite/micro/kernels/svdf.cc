@@ -40,6 +40,10 @@ struct OpData {
   int effective_scale_2_b;
   int scratch_tensor_index;
   int scratch_output_tensor_index;
+  // The activation state is a ring buffer of memory_size columns per filter.
+  // state_head is the column that holds the oldest activations, which the
+  // next Invoke overwrites with the newest ones.
+  int state_head;
 };
 
 /**
@@ -51,12 +55,35 @@ struct OpData {
  * 2.) Output dimensions - the TFLite version determines output size and runtime
  * and resizes the output tensor. Micro runtime does not support tensor
  * resizing.
+ * 3.) Activation state - the TFLite version shifts the whole state left by one
+ * column on every invoke. Here each invoke only writes the newest column over
+ * the oldest one, see OpData::state_head, and the time weights are applied to
+ * the columns from the oldest to the newest, wrapping around.
  */
+
+// Dot product of the time weights of one filter with the filter's activation
+// state, whose oldest column is `oldest`. The products are summed from the
+// oldest column to the newest, like on a shifted state.
+template <typename T, typename AccT>
+inline AccT DotProductWithStateRing(const T* weights, const T* state,
+                                    int memory_size, int oldest) {
+  AccT sum = 0;
+  const int wrap = memory_size - oldest;
+  for (int j = 0; j < wrap; ++j) {
+    sum += weights[j] * state[oldest + j];
+  }
+  for (int j = wrap; j < memory_size; ++j) {
+    sum += weights[j] * state[j - wrap];
+  }
+  return sum;
+}
+
 static inline void ApplyTimeWeightsBiasAndActivation(
     int batch_size, int memory_size, int num_filters, int num_units, int rank,
     const float* const __restrict__ weights_time_ptr,
     const float* const __restrict__ bias_ptr, TfLiteFusedActivation activation,
-    float* const __restrict__ state_ptr, float* const __restrict__ scratch_ptr,
+    float* const __restrict__ state_ptr, int state_oldest,
+    float* const __restrict__ scratch_ptr,
     float* const __restrict__ output_ptr) {
   // Compute matmul(activation_state, weights_time).
   for (int b = 0; b < batch_size; ++b) {
@@ -65,11 +92,10 @@ static inline void ApplyTimeWeightsBiasAndActivation(
     const float* vector1_ptr = weights_time_ptr;
     const float* vector2_ptr = state_ptr + b * memory_size * num_filters;
     for (int i = 0; i < num_filters; ++i) {
-      *scratch_ptr_batch = 0.f;
-      for (int j = 0; j < memory_size; ++j) {
-        *scratch_ptr_batch += *vector1_ptr++ * *vector2_ptr++;
-      }
-      scratch_ptr_batch++;
+      *scratch_ptr_batch++ = DotProductWithStateRing<float, float>(
+          vector1_ptr, vector2_ptr, memory_size, state_oldest);
+      vector1_ptr += memory_size;
+      vector2_ptr += memory_size;
     }
   }
 
@@ -117,7 +143,7 @@ inline void EvalFloatSVDF(
     TfLiteContext* context, TfLiteNode* node, const TfLiteTensor* input,
     const TfLiteTensor* weights_feature, const TfLiteTensor* weights_time,
     const TfLiteTensor* bias, const TfLiteSVDFParams* params,
-    int scratch_tensor_index, TfLiteTensor* activation_state,
+    int scratch_tensor_index, int state_head, TfLiteTensor* activation_state,
     TfLiteTensor* output) {
   const int rank = params->rank;
   const int batch_size = input->dims->data[0];
@@ -141,29 +167,18 @@ inline void EvalFloatSVDF(
 
   float* output_ptr = GetTensorData<float>(output);
 
-  // Left shift the activation_state.
-  {
-    float* new_state_start = state_ptr;
-    const float* old_state_start = state_ptr + 1;
-    const float* old_state_end =
-        state_ptr + batch_size * num_filters * memory_size;
-    while (old_state_start != old_state_end) {
-      *new_state_start++ = *old_state_start++;
-    }
-  }
-
   // Note: no need to clear the latest activation, matmul is not accumulative.
 
   // Compute conv1d(inputs, weights_feature).
-  // The activation_state's rightmost column is used to save current cycle
-  // activation. This is achieved by starting at state_ptr[memory_size - 1] and
+  // The activation_state's oldest column is used to save current cycle
+  // activation. This is achieved by starting at state_ptr[state_head] and
   // having the stride equal to memory_size.
 
   // Perform batched matrix vector multiply operation:
   {
     const float* matrix = weights_feature_ptr;
     const float* vector = input_ptr;
-    float* result = &state_ptr[memory_size - 1];
+    float* result = &state_ptr[state_head];
     float* result_in_batch = result;
     for (int i = 0; i < batch_size; ++i) {
       const float* matrix_ptr = matrix;
@@ -181,7 +196,8 @@ inline void EvalFloatSVDF(
 
   ApplyTimeWeightsBiasAndActivation(
       batch_size, memory_size, num_filters, num_units, rank, weights_time_ptr,
-      bias_ptr, params->activation, state_ptr, scratch_ptr, output_ptr);
+      bias_ptr, params->activation, state_ptr, (state_head + 1) % memory_size,
+      scratch_ptr, output_ptr);
 }
 
 void EvalIntegerSVDF(TfLiteContext* context, TfLiteNode* node,
@@ -208,19 +224,6 @@ void EvalIntegerSVDF(TfLiteContext* context, TfLiteNode* node,
   int32_t* scratch_output_tensor = static_cast<int32_t*>(
       context->GetScratchBuffer(context, data.scratch_output_tensor_index));
 
-  // Shift states.
-  int16_t* const state_ptr = GetTensorData<int16_t>(activation_state_tensor);
-
-  // Left shift the activation_state.
-  {
-    int16_t* new_state_start = state_ptr;
-    const int16_t* old_state_start = state_ptr + 1;
-    const int16_t* old_state_end = state_ptr + n_batch * n_filter * n_memory;
-    while (old_state_start != old_state_end) {
-      *new_state_start++ = *old_state_start++;
-    }
-  }
-
   // Note: no need to clear the latest activation, matmul is not accumulative.
 
   // Feature matmul.
@@ -231,7 +234,7 @@ void EvalIntegerSVDF(TfLiteContext* context, TfLiteNode* node,
         GetTensorData<int8_t>(weights_feature_tensor);
     const int32_t output_max = std::numeric_limits<int16_t>::max();
     const int32_t output_min = std::numeric_limits<int16_t>::min();
-    int16_t* result_in_batch = state + (n_memory - 1);
+    int16_t* result_in_batch = state + data.state_head;
     for (int b = 0; b < n_batch; b++) {
       const int8_t* matrix_ptr = weight_feature;
       for (int r = 0; r < n_filter; r++) {
@@ -257,6 +260,7 @@ void EvalIntegerSVDF(TfLiteContext* context, TfLiteNode* node,
 
   // Time.
   {
+    const int state_oldest = (data.state_head + 1) % n_memory;
     for (int b = 0; b < n_batch; ++b) {
       int32_t* scratch_ptr_batch = scratch_tensor + b * n_filter;
 
@@ -267,11 +271,10 @@ void EvalIntegerSVDF(TfLiteContext* context, TfLiteNode* node,
           b * n_memory * n_filter;
 
       for (int i = 0; i < n_filter; i++) {
-        *scratch_ptr_batch = 0;
-        for (int j = 0; j < n_memory; j++) {
-          *scratch_ptr_batch += *vector1_ptr++ * *vector2_ptr++;
-        }
-        scratch_ptr_batch++;
+        *scratch_ptr_batch++ = DotProductWithStateRing<int16_t, int32_t>(
+            vector1_ptr, vector2_ptr, n_memory, state_oldest);
+        vector1_ptr += n_memory;
+        vector2_ptr += n_memory;
       }
     }
   }
@@ -411,6 +414,11 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   TF_LITE_ENSURE_EQ(context, node->inputs->size, 5);
 
+  TFLITE_DCHECK(node->user_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+  // The state starts out all zeros, so any column can be the oldest one.
+  data->state_head = 0;
+
   if (input->type == kTfLiteInt8) {
     TF_LITE_ENSURE_EQ(context, weights_feature->type, kTfLiteInt8);
     TF_LITE_ENSURE_EQ(context, weights_time->type, kTfLiteInt16);
@@ -440,9 +448,6 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
         state_params->scale->data[0] * weight_time_params->scale->data[0] /
         output_params->scale->data[0]);
 
-    TFLITE_DCHECK(node->user_data != nullptr);
-    OpData* data = static_cast<OpData*>(node->user_data);
-
     QuantizeMultiplier(effective_scale_1, &(data->effective_scale_1_a),
                        &(data->effective_scale_1_b));
     QuantizeMultiplier(effective_scale_2, &(data->effective_scale_2_a),
@@ -469,9 +474,6 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     }
     TF_LITE_ENSURE_EQ(context, output->type, kTfLiteFloat32);
 
-    TFLITE_DCHECK(node->user_data != nullptr);
-    OpData* data = static_cast<OpData*>(node->user_data);
-
     TFLITE_DCHECK(context->RequestScratchBufferInArena != nullptr);
     const TfLiteStatus scratch_status = context->RequestScratchBufferInArena(
         context, batch_size * num_filters * sizeof(float),
@@ -496,13 +498,15 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
 
   TFLITE_DCHECK(node->user_data != nullptr);
-  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+  OpData& data = *(static_cast<OpData*>(node->user_data));
+  const int memory_size = weights_time->dims->data[1];
 
   switch (weights_feature->type) {
     case kTfLiteFloat32: {
       EvalFloatSVDF(context, node, input, weights_feature, weights_time, bias,
-                    params, data.scratch_tensor_index, activation_state,
-                    output);
+                    params, data.scratch_tensor_index, data.state_head,
+                    activation_state, output);
+      data.state_head = (data.state_head + 1) % memory_size;
       return kTfLiteOk;
       break;
     }
@@ -513,6 +517,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       EvalIntegerSVDF(context, node, input, weights_feature, weights_time, bias,
                       params, activation_state, output, data,
                       input->params.zero_point, output->params.zero_point);
+      data.state_head = (data.state_head + 1) % memory_size;
       return kTfLiteOk;
       break;
     }
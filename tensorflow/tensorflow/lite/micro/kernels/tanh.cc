@@ -0,0 +1,143 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/tanh.h"
+
+#include <cmath>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/activation_utils.h"
+
+namespace tflite {
+namespace ops {
+namespace micro {
+namespace activations {
+namespace {
+constexpr int kInputTensor = 0;
+constexpr int kOutputTensor = 0;
+
+struct OpData {
+  // The output for every int8 input, see PopulateInt8LookupTable().
+  int8_t* table;
+};
+
+}  // namespace
+
+void* TanhInit(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  void* data = nullptr;
+  if (context->AllocatePersistentBuffer(context, sizeof(OpData), &data) ==
+      kTfLiteError) {
+    return nullptr;
+  }
+  return data;
+}
+
+TfLiteStatus TanhPrepare(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 1);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+  TF_LITE_ENSURE_EQ(context, input->type, output->type);
+
+  data->table = nullptr;
+  if (input->type == kTfLiteFloat32) {
+    return kTfLiteOk;
+  }
+  if (input->type != kTfLiteInt8) {
+    TF_LITE_KERNEL_LOG(context, "Input data type %s (%d) is not supported.",
+                       TfLiteTypeGetName(input->type), input->type);
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_EQ(context, output->params.zero_point, 0);
+  TF_LITE_ENSURE(context, output->params.scale == 1. / 128);
+
+  static constexpr int kInputIntegerBits = 4;
+  const double input_real_multiplier =
+      static_cast<double>(input->params.scale) *
+      static_cast<double>(1 << (31 - kInputIntegerBits));
+  int input_left_shift;
+  const double q = std::frexp(input_real_multiplier, &input_left_shift);
+  const int32_t input_multiplier =
+      static_cast<int32_t>(TfLiteRound(q * (1ll << 31)));
+  const int32_t input_range_radius =
+      CalculateInputRadius(kInputIntegerBits, input_left_shift, 31);
+  const int32_t input_zero_point = input->params.zero_point;
+
+  void* table = nullptr;
+  TF_LITE_ENSURE_STATUS(
+      context->AllocatePersistentBuffer(context, kInt8LookupTableSize, &table));
+  data->table = static_cast<int8_t*>(table);
+  PopulateInt8LookupTable(
+      [&](int size, const int8_t* inputs, int8_t* outputs) {
+        reference_integer_ops::Tanh(input_zero_point, input_range_radius,
+                                    input_multiplier, input_left_shift, size,
+                                    inputs, outputs);
+      },
+      data->table);
+  return kTfLiteOk;
+}
+
+TfLiteStatus TanhEval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+
+  const int size = NumElements(input->dims);
+  switch (input->type) {
+    case kTfLiteFloat32: {
+      const float* input_data = GetTensorData<float>(input);
+      float* output_data = GetTensorData<float>(output);
+      for (int i = 0; i < size; ++i) {
+        output_data[i] = std::tanh(input_data[i]);
+      }
+      return kTfLiteOk;
+    }
+    case kTfLiteInt8:
+      LookupInt8(data.table, size, GetTensorData<int8_t>(input),
+                 GetTensorData<int8_t>(output));
+      return kTfLiteOk;
+    default:
+      TF_LITE_KERNEL_LOG(context, "Input %s, output %s not supported.",
+                         TfLiteTypeGetName(input->type),
+                         TfLiteTypeGetName(output->type));
+      return kTfLiteError;
+  }
+}
+
+}  // namespace activations
+
+TfLiteRegistration* Register_TANH() {
+  static TfLiteRegistration r = {/*init=*/activations::TanhInit,
+                                 /*free=*/nullptr,
+                                 /*prepare=*/activations::TanhPrepare,
+                                 /*invoke=*/activations::TanhEval,
+                                 /*profiling_string=*/nullptr,
+                                 /*builtin_code=*/0,
+                                 /*custom_name=*/nullptr,
+                                 /*version=*/0};
+  return &r;
+}
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
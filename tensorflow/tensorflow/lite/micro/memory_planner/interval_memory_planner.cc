@@ -0,0 +1,272 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/memory_planner/interval_memory_planner.h"
+
+namespace tflite {
+
+namespace {
+
+// Sorts `ids` in place so that `comes_before` holds between neighbours, in
+// O(n log n) time and without extra memory. `comes_before` must be a strict
+// total order for the result to be deterministic.
+template <typename Order>
+void SiftDown(int* ids, int root, int count, const Order& comes_before) {
+  while (true) {
+    int child = 2 * root + 1;
+    if (child >= count) {
+      return;
+    }
+    if (child + 1 < count && comes_before(ids[child], ids[child + 1])) {
+      ++child;
+    }
+    if (!comes_before(ids[root], ids[child])) {
+      return;
+    }
+    const int temp = ids[root];
+    ids[root] = ids[child];
+    ids[child] = temp;
+    root = child;
+  }
+}
+
+template <typename Order>
+void HeapSort(int* ids, int count, const Order& comes_before) {
+  for (int i = count / 2 - 1; i >= 0; --i) {
+    SiftDown(ids, i, count, comes_before);
+  }
+  for (int end = count - 1; end > 0; --end) {
+    const int temp = ids[0];
+    ids[0] = ids[end];
+    ids[end] = temp;
+    SiftDown(ids, 0, end, comes_before);
+  }
+}
+
+}  // namespace
+
+IntervalMemoryPlanner::IntervalMemoryPlanner(unsigned char* scratch_buffer,
+                                             int scratch_buffer_size)
+    : buffer_count_(0), max_size_(0), need_to_calculate_offsets_(true) {
+  max_buffer_count_ = scratch_buffer_size / per_buffer_size();
+
+  unsigned char* next_free = scratch_buffer;
+  requirements_ = reinterpret_cast<BufferRequirements*>(next_free);
+  next_free += sizeof(BufferRequirements) * max_buffer_count_;
+  ids_sorted_by_size_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  ids_sorted_by_first_use_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  max_last_time_used_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  offsets_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  active_ids_ = reinterpret_cast<int*>(next_free);
+}
+
+IntervalMemoryPlanner::~IntervalMemoryPlanner() {
+  // We don't own the scratch buffer, so don't deallocate anything.
+}
+
+TfLiteStatus IntervalMemoryPlanner::AddBuffer(
+    tflite::ErrorReporter* error_reporter, int size, int first_time_used,
+    int last_time_used) {
+  if (buffer_count_ >= max_buffer_count_) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Too many buffers (max is %d)",
+                         max_buffer_count_);
+    return kTfLiteError;
+  }
+  BufferRequirements* current = &requirements_[buffer_count_];
+  current->size = size;
+  current->first_time_used = first_time_used;
+  current->last_time_used = last_time_used;
+  ++buffer_count_;
+  need_to_calculate_offsets_ = true;
+  return kTfLiteOk;
+}
+
+void IntervalMemoryPlanner::AddToTree(int position) {
+  const int last_time_used =
+      requirements_[ids_sorted_by_first_use_[position]].last_time_used;
+  int begin = 0;
+  int end = buffer_count_;
+  while (true) {
+    const int middle = (begin + end) / 2;
+    if (max_last_time_used_[middle] < last_time_used) {
+      max_last_time_used_[middle] = last_time_used;
+    }
+    if (position == middle) {
+      return;
+    }
+    if (position < middle) {
+      end = middle;
+    } else {
+      begin = middle + 1;
+    }
+  }
+}
+
+void IntervalMemoryPlanner::CollectActive(int begin, int end, int limit,
+                                          int first_time_used,
+                                          int* active_count) const {
+  if (begin >= end || begin >= limit) {
+    return;
+  }
+  const int middle = (begin + end) / 2;
+  // Nothing placed in this subtree is alive at `first_time_used`.
+  if (max_last_time_used_[middle] < first_time_used) {
+    return;
+  }
+  CollectActive(begin, middle, limit, first_time_used, active_count);
+  if (middle >= limit) {
+    return;
+  }
+  const int id = ids_sorted_by_first_use_[middle];
+  if (offsets_[id] != -1 &&
+      requirements_[id].last_time_used >= first_time_used) {
+    active_ids_[*active_count] = id;
+    ++*active_count;
+  }
+  CollectActive(middle + 1, end, limit, first_time_used, active_count);
+}
+
+void IntervalMemoryPlanner::CalculateOffsetsIfNeeded() {
+  if (!need_to_calculate_offsets_) {
+    return;
+  }
+  need_to_calculate_offsets_ = false;
+  max_size_ = 0;
+
+  // Walked backwards, this is the order of the GreedyMemoryPlanner: largest
+  // first, and the order the buffers were added in on ties.
+  struct SmallerSize {
+    const BufferRequirements* requirements;
+    bool operator()(int a, int b) const {
+      if (requirements[a].size != requirements[b].size) {
+        return requirements[a].size < requirements[b].size;
+      }
+      return a > b;
+    }
+  };
+  struct EarlierFirstUse {
+    const BufferRequirements* requirements;
+    bool operator()(int a, int b) const {
+      if (requirements[a].first_time_used != requirements[b].first_time_used) {
+        return requirements[a].first_time_used <
+               requirements[b].first_time_used;
+      }
+      return a < b;
+    }
+  };
+  struct LowerOffset {
+    const int* offsets;
+    bool operator()(int a, int b) const {
+      if (offsets[a] != offsets[b]) {
+        return offsets[a] < offsets[b];
+      }
+      return a < b;
+    }
+  };
+  const SmallerSize smaller_size = {requirements_};
+  const EarlierFirstUse earlier_first_use = {requirements_};
+  const LowerOffset lower_offset = {offsets_};
+
+  for (int i = 0; i < buffer_count_; ++i) {
+    ids_sorted_by_size_[i] = i;
+    ids_sorted_by_first_use_[i] = i;
+    max_last_time_used_[i] = -1;
+    offsets_[i] = -1;
+  }
+  HeapSort(ids_sorted_by_size_, buffer_count_, smaller_size);
+  HeapSort(ids_sorted_by_first_use_, buffer_count_, earlier_first_use);
+
+  for (int i = buffer_count_ - 1; i >= 0; --i) {
+    const int buffer_id = ids_sorted_by_size_[i];
+    const BufferRequirements& wanted = requirements_[buffer_id];
+
+    // The buffers first used up to `wanted.last_time_used` are the positions
+    // before `limit`, and the buffer's own position is found the same way.
+    int low = 0;
+    int high = buffer_count_;
+    while (low < high) {
+      const int middle = (low + high) / 2;
+      if (requirements_[ids_sorted_by_first_use_[middle]].first_time_used <=
+          wanted.last_time_used) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    const int limit = low;
+    low = 0;
+    high = buffer_count_;
+    while (low < high) {
+      const int middle = (low + high) / 2;
+      if (earlier_first_use(ids_sorted_by_first_use_[middle], buffer_id)) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    const int position = low;
+
+    int active_count = 0;
+    CollectActive(0, buffer_count_, limit, wanted.first_time_used,
+                  &active_count);
+    HeapSort(active_ids_, active_count, lower_offset);
+
+    // The same walk as the GreedyMemoryPlanner's over the offset-ordered
+    // list, restricted to the buffers that matter.
+    int candidate_offset = 0;
+    for (int j = 0; j < active_count; ++j) {
+      const int active_id = active_ids_[j];
+      if (offsets_[active_id] - candidate_offset >= wanted.size) {
+        break;
+      }
+      const int active_end =
+          offsets_[active_id] + requirements_[active_id].size;
+      if (active_end > candidate_offset) {
+        candidate_offset = active_end;
+      }
+    }
+    offsets_[buffer_id] = candidate_offset;
+    if (candidate_offset + wanted.size > max_size_) {
+      max_size_ = candidate_offset + wanted.size;
+    }
+    AddToTree(position);
+  }
+}
+
+size_t IntervalMemoryPlanner::GetMaximumMemorySize() {
+  CalculateOffsetsIfNeeded();
+  return max_size_;
+}
+
+int IntervalMemoryPlanner::GetBufferCount() { return buffer_count_; }
+
+TfLiteStatus IntervalMemoryPlanner::GetOffsetForBuffer(
+    tflite::ErrorReporter* error_reporter, int buffer_index, int* offset) {
+  CalculateOffsetsIfNeeded();
+  if ((buffer_index < 0) || (buffer_index >= buffer_count_)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "buffer index %d is outside range 0 to %d",
+                         buffer_index, buffer_count_);
+    return kTfLiteError;
+  }
+  *offset = offsets_[buffer_index];
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
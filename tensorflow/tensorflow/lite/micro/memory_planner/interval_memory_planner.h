@@ -0,0 +1,105 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_INTERVAL_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_INTERVAL_MEMORY_PLANNER_H_
+
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/memory_planner/memory_planner.h"
+
+namespace tflite {
+
+// A memory planner that gives exactly the layout of the GreedyMemoryPlanner,
+// but scales to graphs with thousands of buffers.
+//
+// The greedy planner places the buffers from the largest to the smallest,
+// each at the lowest offset where it doesn't overlap a placed buffer that is
+// active at the same time. It finds that offset by walking the list of all
+// placed buffers and sorts with a bubble sort, so planning takes O(n^2) time.
+//
+// This planner makes the same choices with other data structures:
+//  - The buffers are heap sorted by size, ties in the order they were added.
+//  - The buffers sorted by first_time_used form an implicit interval tree:
+//    each subtree stores the latest last_time_used of its placed buffers.
+//    The placed buffers active while a buffer is alive are found in
+//    O((k + 1) log n) time, where k is their number.
+//  - Only those k buffers are sorted by offset to find the lowest gap.
+//
+// Planning takes O(n log n) time when the number of buffers alive at the
+// same time is bounded, as it is in typical graphs, and O(n^2 log n) in the
+// worst case where everything is alive at once.
+class IntervalMemoryPlanner : public MemoryPlanner {
+ public:
+  // The scratch buffer holds the planning state like for the
+  // GreedyMemoryPlanner, per_buffer_size() bytes per buffer.
+  IntervalMemoryPlanner(unsigned char* scratch_buffer, int scratch_buffer_size);
+  ~IntervalMemoryPlanner() override;
+
+  TfLiteStatus AddBuffer(ErrorReporter* error_reporter, int size,
+                         int first_time_used, int last_time_used) override;
+  size_t GetMaximumMemorySize() override;
+  int GetBufferCount() override;
+  TfLiteStatus GetOffsetForBuffer(ErrorReporter* error_reporter,
+                                  int buffer_index, int* offset) override;
+
+  // Number of bytes required in order to plan a buffer.
+  static size_t per_buffer_size() {
+    return sizeof(BufferRequirements) +  // requirements_
+           sizeof(int) +                 // ids_sorted_by_size_
+           sizeof(int) +                 // ids_sorted_by_first_use_
+           sizeof(int) +                 // max_last_time_used_
+           sizeof(int) +                 // offsets_
+           sizeof(int);                  // active_ids_
+  }
+
+ private:
+  struct BufferRequirements {
+    int size;
+    int first_time_used;
+    int last_time_used;
+  };
+
+  // Marks the buffer at `position` in ids_sorted_by_first_use_ as placed.
+  void AddToTree(int position);
+  // Appends the placed buffers among positions [begin, end) of
+  // ids_sorted_by_first_use_, below `limit`, that are still alive at
+  // `first_time_used`, to active_ids_.
+  void CollectActive(int begin, int end, int limit, int first_time_used,
+                     int* active_count) const;
+  void CalculateOffsetsIfNeeded();
+
+  int max_buffer_count_;
+  int buffer_count_;
+
+  BufferRequirements* requirements_;
+  int* ids_sorted_by_size_;
+  int* ids_sorted_by_first_use_;
+  // For the subtree of positions [begin, end) of ids_sorted_by_first_use_,
+  // stored at its middle (begin + end) / 2: the latest last_time_used of its
+  // placed buffers, -1 if none.
+  int* max_last_time_used_;
+  int* offsets_;
+  // The placed buffers active at the same time as the one being placed.
+  int* active_ids_;
+
+  int max_size_;
+  bool need_to_calculate_offsets_;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_INTERVAL_MEMORY_PLANNER_H_
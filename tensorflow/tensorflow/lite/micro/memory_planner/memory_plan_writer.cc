@@ -0,0 +1,53 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/memory_planner/memory_plan_writer.h"
+
+#include "tensorflow/lite/micro/micro_string.h"
+
+namespace tflite {
+
+namespace {
+
+// Long enough for a JSON record with all fields at their largest.
+constexpr int kMaxLineLength = 192;
+
+}  // namespace
+
+void MemoryPlanWriter::Start() {
+  if (format_ == MemoryPlanFormat::kCsv) {
+    WriteLine("buffer,type,id,size,first_used,last_used,region,offset");
+  }
+}
+
+void MemoryPlanWriter::WriteRecord(const MemoryPlanRecord& record) {
+  const char* type = record.is_scratch_buffer ? "scratch" : "tensor";
+  const char* format =
+      format_ == MemoryPlanFormat::kCsv
+          ? "%d,%s,%d,%d,%d,%d,%d,%d"
+          : "{\"buffer\":%d,\"type\":\"%s\",\"id\":%d,\"size\":%d,"
+            "\"first_used\":%d,\"last_used\":%d,\"region\":%d,\"offset\":%d}";
+  char line[kMaxLineLength];
+  MicroSnprintf(line, kMaxLineLength, format, record.buffer_index, type,
+                record.id, record.size, record.first_time_used,
+                record.last_time_used, record.region, record.offset);
+  WriteLine(line);
+}
+
+void ReportingMemoryPlanWriter::WriteLine(const char* line) {
+  TF_LITE_REPORT_ERROR(error_reporter_, "%s", line);
+}
+
+}  // namespace tflite
@@ -0,0 +1,94 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_MEMORY_PLAN_WRITER_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_MEMORY_PLAN_WRITER_H_
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/compatibility.h"
+
+namespace tflite {
+
+// One planned buffer of a memory plan.
+struct MemoryPlanRecord {
+  // Index of the planned buffer, in the order the planner received them.
+  int buffer_index;
+  // True for a buffer requested with RequestScratchBufferInArena.
+  bool is_scratch_buffer;
+  // The tensor index, or the scratch buffer index for a scratch buffer.
+  int id;
+  // Planned bytes, including the alignment padding.
+  int size;
+  // The first and last node that use the buffer.
+  int first_time_used;
+  int last_time_used;
+  // 0 for the head of the arena, r for the memory region added r-th with
+  // MicroAllocator::AddMemoryRegion.
+  int region;
+  // Offset of the buffer from the start of its region.
+  int offset;
+};
+
+enum class MemoryPlanFormat {
+  // A header line, then one line per buffer:
+  //   buffer,type,id,size,first_used,last_used,region,offset
+  kCsv,
+  // One JSON object per line (JSON Lines), e.g.
+  //   {"buffer":0,"type":"tensor","id":3,"size":64,"first_used":0,
+  //    "last_used":1,"region":0,"offset":128}
+  kJson,
+};
+
+// Writes a memory plan as text, one line per buffer, so tools can chart the
+// arena pressure over time or compare planners. Unlike
+// GreedyMemoryPlanner::PrintMemoryPlan it works with any planner and names
+// the tensors. Subclasses decide where the lines go.
+class MemoryPlanWriter {
+ public:
+  explicit MemoryPlanWriter(MemoryPlanFormat format) : format_(format) {}
+  virtual ~MemoryPlanWriter() {}
+
+  // Writes the CSV header, if any. Called before the first record.
+  void Start();
+  void WriteRecord(const MemoryPlanRecord& record);
+
+ protected:
+  // Writes one line, without its line break.
+  virtual void WriteLine(const char* line) = 0;
+
+ private:
+  MemoryPlanFormat format_;
+};
+
+// Writes the plan through an ErrorReporter, e.g. to the serial port of a
+// target, with one Report() per line.
+class ReportingMemoryPlanWriter : public MemoryPlanWriter {
+ public:
+  ReportingMemoryPlanWriter(ErrorReporter* error_reporter,
+                            MemoryPlanFormat format)
+      : MemoryPlanWriter(format), error_reporter_(error_reporter) {}
+
+ protected:
+  void WriteLine(const char* line) override;
+
+ private:
+  ErrorReporter* error_reporter_;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_MEMORY_PLAN_WRITER_H_
@@ -0,0 +1,224 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/memory_planner/multi_region_memory_planner.h"
+
+#include <stdint.h>
+
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+
+namespace tflite {
+
+size_t MultiRegionMemoryPlanner::per_buffer_size() {
+  return GreedyMemoryPlanner::per_buffer_size() +  // greedy_scratch_
+         sizeof(BufferRequirements) +              // requirements_
+         sizeof(int) +                             // ids_by_heat_
+         sizeof(int) +                             // buffer_regions_
+         sizeof(int) +                             // buffer_offsets_
+         sizeof(int);                              // region_buffer_ids_
+}
+
+MultiRegionMemoryPlanner::MultiRegionMemoryPlanner(
+    unsigned char* scratch_buffer, int scratch_buffer_size)
+    : buffer_count_(0),
+      region_count_(0),
+      need_to_place_(true),
+      place_status_(kTfLiteOk) {
+  max_buffer_count_ = scratch_buffer_size / per_buffer_size();
+
+  // The greedy planner's scratch comes first, it has the strictest alignment.
+  unsigned char* next_free = scratch_buffer;
+  greedy_scratch_ = next_free;
+  greedy_scratch_size_ =
+      GreedyMemoryPlanner::per_buffer_size() * max_buffer_count_;
+  next_free += greedy_scratch_size_;
+  requirements_ = reinterpret_cast<BufferRequirements*>(next_free);
+  next_free += sizeof(BufferRequirements) * max_buffer_count_;
+  ids_by_heat_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  buffer_regions_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  buffer_offsets_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  region_buffer_ids_ = reinterpret_cast<int*>(next_free);
+}
+
+MultiRegionMemoryPlanner::~MultiRegionMemoryPlanner() {
+  // We don't own the scratch buffer, so don't deallocate anything.
+}
+
+TfLiteStatus MultiRegionMemoryPlanner::AddRegion(ErrorReporter* error_reporter,
+                                                 size_t capacity, int speed) {
+  if (region_count_ >= kMaxRegions) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Too many memory regions (max is %d)",
+                         kMaxRegions);
+    return kTfLiteError;
+  }
+  Region* region = &regions_[region_count_];
+  region->capacity = capacity;
+  region->speed = speed;
+  region->used_bytes = 0;
+  ++region_count_;
+  need_to_place_ = true;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MultiRegionMemoryPlanner::AddBuffer(ErrorReporter* error_reporter,
+                                                 int size, int first_time_used,
+                                                 int last_time_used,
+                                                 int access_count) {
+  if (buffer_count_ >= max_buffer_count_) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Too many buffers (max is %d)",
+                         max_buffer_count_);
+    return kTfLiteError;
+  }
+  BufferRequirements* current = &requirements_[buffer_count_];
+  current->size = size;
+  current->first_time_used = first_time_used;
+  current->last_time_used = last_time_used;
+  current->access_count = access_count < 1 ? 1 : access_count;
+  ++buffer_count_;
+  need_to_place_ = true;
+  return kTfLiteOk;
+}
+
+bool MultiRegionMemoryPlanner::IsHotter(int a, int b) const {
+  const BufferRequirements& ra = requirements_[a];
+  const BufferRequirements& rb = requirements_[b];
+  // Compares access_count / size without dividing.
+  const int64_t heat_a = static_cast<int64_t>(ra.access_count) * rb.size;
+  const int64_t heat_b = static_cast<int64_t>(rb.access_count) * ra.size;
+  if (heat_a != heat_b) {
+    return heat_a > heat_b;
+  }
+  return ra.size < rb.size;
+}
+
+TfLiteStatus MultiRegionMemoryPlanner::LayOutRegion(
+    ErrorReporter* error_reporter, int region_index, size_t* size,
+    int* offsets) {
+  GreedyMemoryPlanner planner(greedy_scratch_, greedy_scratch_size_);
+  int count = 0;
+  for (int i = 0; i < buffer_count_; ++i) {
+    if (buffer_regions_[i] != region_index) {
+      continue;
+    }
+    const BufferRequirements& current = requirements_[i];
+    TF_LITE_ENSURE_STATUS(planner.AddBuffer(error_reporter, current.size,
+                                            current.first_time_used,
+                                            current.last_time_used));
+    region_buffer_ids_[count] = i;
+    ++count;
+  }
+  *size = planner.GetMaximumMemorySize();
+  if (offsets != nullptr) {
+    for (int i = 0; i < count; ++i) {
+      TF_LITE_ENSURE_STATUS(planner.GetOffsetForBuffer(
+          error_reporter, i, &offsets[region_buffer_ids_[i]]));
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus MultiRegionMemoryPlanner::PlaceIfNeeded(
+    ErrorReporter* error_reporter) {
+  if (!need_to_place_) {
+    return place_status_;
+  }
+  need_to_place_ = false;
+  place_status_ = kTfLiteError;
+
+  // Stable insertion sort, there are only a few dozen buffers.
+  for (int i = 0; i < buffer_count_; ++i) {
+    int j = i;
+    while (j > 0 && IsHotter(i, ids_by_heat_[j - 1])) {
+      ids_by_heat_[j] = ids_by_heat_[j - 1];
+      --j;
+    }
+    ids_by_heat_[j] = i;
+    buffer_regions_[i] = -1;
+  }
+
+  // Regions from the fastest to the slowest, the first added on ties.
+  bool region_done[kMaxRegions] = {};
+  for (int pass = 0; pass < region_count_; ++pass) {
+    int region_index = -1;
+    for (int r = 0; r < region_count_; ++r) {
+      if (!region_done[r] &&
+          (region_index < 0 ||
+           regions_[r].speed > regions_[region_index].speed)) {
+        region_index = r;
+      }
+    }
+    region_done[region_index] = true;
+    const size_t capacity = regions_[region_index].capacity;
+    for (int i = 0; i < buffer_count_; ++i) {
+      const int id = ids_by_heat_[i];
+      if (buffer_regions_[id] != -1 ||
+          static_cast<size_t>(requirements_[id].size) > capacity) {
+        continue;
+      }
+      buffer_regions_[id] = region_index;
+      size_t size = 0;
+      TF_LITE_ENSURE_STATUS(
+          LayOutRegion(error_reporter, region_index, &size, nullptr));
+      if (size > capacity) {
+        buffer_regions_[id] = -1;
+      }
+    }
+  }
+
+  for (int i = 0; i < buffer_count_; ++i) {
+    if (buffer_regions_[i] == -1) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Buffer %d of %d bytes doesn't fit in any memory "
+                           "region",
+                           i, requirements_[i].size);
+      return kTfLiteError;
+    }
+  }
+  for (int r = 0; r < region_count_; ++r) {
+    TF_LITE_ENSURE_STATUS(LayOutRegion(error_reporter, r,
+                                       &regions_[r].used_bytes,
+                                       buffer_offsets_));
+  }
+  place_status_ = kTfLiteOk;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MultiRegionMemoryPlanner::GetPlacementForBuffer(
+    ErrorReporter* error_reporter, int buffer_index, int* region_index,
+    int* offset) {
+  TF_LITE_ENSURE_STATUS(PlaceIfNeeded(error_reporter));
+  if ((buffer_index < 0) || (buffer_index >= buffer_count_)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "buffer index %d is outside range 0 to %d",
+                         buffer_index, buffer_count_);
+    return kTfLiteError;
+  }
+  *region_index = buffer_regions_[buffer_index];
+  *offset = buffer_offsets_[buffer_index];
+  return kTfLiteOk;
+}
+
+size_t MultiRegionMemoryPlanner::GetRegionMemorySize(int region_index) const {
+  if (need_to_place_ || place_status_ != kTfLiteOk || region_index < 0 ||
+      region_index >= region_count_) {
+    return 0;
+  }
+  return regions_[region_index].used_bytes;
+}
+
+}  // namespace tflite
@@ -0,0 +1,122 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_MULTI_REGION_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_MULTI_REGION_MEMORY_PLANNER_H_
+
+#include <stddef.h>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+
+namespace tflite {
+
+// A memory planner that spreads the buffers over several memory regions of
+// different speed and capacity, e.g. DTCM, SRAM and external SDRAM on a
+// Cortex-M7. It only deals with sizes and offsets, so it can be used with
+// plain buffers standing in for the regions.
+//
+// Every buffer has an access count, the number of operators reading or
+// writing it. The buffers are ranked by accesses per byte, so small buffers
+// that are touched often come first and the largest activations last. The
+// regions are then filled from the fastest to the slowest: each buffer in
+// rank order joins the region if a GreedyMemoryPlanner layout of the region's
+// buffers still fits its capacity, and otherwise is left for the next
+// region. The final offsets are the greedy layout of each region.
+//
+// Planning runs one greedy layout per buffer and region, so it takes
+// O(regions * buffers^3) time in the worst case. That is fine for the few
+// dozen buffers of a microcontroller model.
+class MultiRegionMemoryPlanner {
+ public:
+  static constexpr int kMaxRegions = 4;
+
+  // The scratch buffer holds the planning state, per_buffer_size() bytes per
+  // buffer, like for the GreedyMemoryPlanner.
+  MultiRegionMemoryPlanner(unsigned char* scratch_buffer,
+                           int scratch_buffer_size);
+  ~MultiRegionMemoryPlanner();
+
+  // Adds a region of `capacity` bytes. `speed` only matters relative to the
+  // other regions, higher is faster. The N-th call adds region N.
+  TfLiteStatus AddRegion(ErrorReporter* error_reporter, size_t capacity,
+                         int speed);
+
+  // Records a buffer to place, like MemoryPlanner::AddBuffer().
+  // `access_count` is how many operators read or write it.
+  TfLiteStatus AddBuffer(ErrorReporter* error_reporter, int size,
+                         int first_time_used, int last_time_used,
+                         int access_count);
+
+  int GetBufferCount() const { return buffer_count_; }
+  int GetRegionCount() const { return region_count_; }
+
+  // Assigns the buffers to regions on the first call. Fails when a buffer
+  // doesn't fit in any region.
+  TfLiteStatus GetPlacementForBuffer(ErrorReporter* error_reporter,
+                                     int buffer_index, int* region_index,
+                                     int* offset);
+
+  // The high-water mark of the layout in a region, 0 before the placement.
+  size_t GetRegionMemorySize(int region_index) const;
+
+  // Number of bytes required in order to plan a buffer.
+  static size_t per_buffer_size();
+
+ private:
+  struct BufferRequirements {
+    int size;
+    int first_time_used;
+    int last_time_used;
+    int access_count;
+  };
+
+  struct Region {
+    size_t capacity;
+    int speed;
+    size_t used_bytes;
+  };
+
+  // Whether buffer `a` goes to a fast region before buffer `b`.
+  bool IsHotter(int a, int b) const;
+  // Lays out the buffers assigned to `region_index` with a
+  // GreedyMemoryPlanner. Stores their offsets when `offsets` is not null.
+  TfLiteStatus LayOutRegion(ErrorReporter* error_reporter, int region_index,
+                            size_t* size, int* offsets);
+  TfLiteStatus PlaceIfNeeded(ErrorReporter* error_reporter);
+
+  int max_buffer_count_;
+  int buffer_count_;
+  int region_count_;
+  Region regions_[kMaxRegions];
+
+  BufferRequirements* requirements_;
+  // Buffer ids from hottest to coldest.
+  int* ids_by_heat_;
+  // Region of every buffer, -1 while unassigned.
+  int* buffer_regions_;
+  int* buffer_offsets_;
+  // Buffer id of every buffer added to the greedy planner of a region.
+  int* region_buffer_ids_;
+  unsigned char* greedy_scratch_;
+  int greedy_scratch_size_;
+
+  bool need_to_place_;
+  TfLiteStatus place_status_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_MULTI_REGION_MEMORY_PLANNER_H_
@@ -0,0 +1,235 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host test of MultiRegionMemoryPlanner. It defines main(), so the firmware
+// build excludes it in .cproject. From the repository root:
+//
+//   g++ -std=c++11 -O2 -Itensorflow -Ithird_party/flatbuffers/include
+//     tensorflow/tensorflow/lite/micro/memory_planner/multi_region_memory_planner_test.cc
+//     tensorflow/tensorflow/lite/micro/memory_planner/multi_region_memory_planner.cc
+//     tensorflow/tensorflow/lite/micro/memory_planner/greedy_memory_planner.cc
+//     tensorflow/tensorflow/lite/micro/micro_error_reporter.cc
+//     tensorflow/tensorflow/lite/micro/micro_string.cc
+//     tensorflow/tensorflow/lite/core/api/error_reporter.cc
+//     tensorflow/tensorflow/lite/micro/tools/host_debug_log.cc
+//     -o multi_region_memory_planner_test
+//   ./multi_region_memory_planner_test
+//
+// It prints "~~~ALL TESTS PASSED~~~" when all the tests pass.
+
+#include "tensorflow/lite/micro/memory_planner/multi_region_memory_planner.h"
+
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace {
+
+constexpr int kMaxBuffers = 16;
+constexpr int kScratchBufferSize = 1024;
+alignas(8) unsigned char g_scratch_buffer[kScratchBufferSize];
+
+struct TestBuffer {
+  int size;
+  int first_time_used;
+  int last_time_used;
+  int access_count;
+};
+
+// Adds `buffers` to `planner` and checks the resulting placement: every
+// buffer is in a region, ends within the region's capacity and the region's
+// high-water mark, and doesn't overlap another buffer of the same region that
+// is alive at the same time.
+void AddAndCheckPlacement(ErrorReporter* error_reporter,
+                          MultiRegionMemoryPlanner* planner,
+                          const size_t* capacities, const TestBuffer* buffers,
+                          int buffer_count, int* regions) {
+  for (int i = 0; i < buffer_count; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(
+        kTfLiteOk,
+        planner->AddBuffer(error_reporter, buffers[i].size,
+                           buffers[i].first_time_used,
+                           buffers[i].last_time_used, buffers[i].access_count));
+  }
+  int offsets[kMaxBuffers];
+  for (int i = 0; i < buffer_count; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(
+        kTfLiteOk, planner->GetPlacementForBuffer(error_reporter, i,
+                                                  &regions[i], &offsets[i]));
+    TF_LITE_MICRO_EXPECT_GE(regions[i], 0);
+    TF_LITE_MICRO_EXPECT_LT(regions[i], planner->GetRegionCount());
+    TF_LITE_MICRO_EXPECT_GE(offsets[i], 0);
+    const size_t end = offsets[i] + buffers[i].size;
+    TF_LITE_MICRO_EXPECT_LE(end, capacities[regions[i]]);
+    TF_LITE_MICRO_EXPECT_LE(end, planner->GetRegionMemorySize(regions[i]));
+  }
+  for (int i = 0; i < buffer_count; ++i) {
+    for (int j = i + 1; j < buffer_count; ++j) {
+      if (regions[i] != regions[j] ||
+          buffers[i].last_time_used < buffers[j].first_time_used ||
+          buffers[j].last_time_used < buffers[i].first_time_used) {
+        continue;
+      }
+      TF_LITE_MICRO_EXPECT_TRUE(offsets[i] + buffers[i].size <= offsets[j] ||
+                                offsets[j] + buffers[j].size <= offsets[i]);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestSingleRegion) {
+  tflite::MicroErrorReporter micro_error_reporter;
+  tflite::ErrorReporter* error_reporter = &micro_error_reporter;
+
+  tflite::MultiRegionMemoryPlanner planner(tflite::g_scratch_buffer,
+                                           tflite::kScratchBufferSize);
+  const size_t capacities[] = {1000};
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddRegion(error_reporter, capacities[0], 1));
+  const tflite::TestBuffer buffers[] = {
+      {100, 0, 1, 2}, {50, 1, 2, 2}, {20, 2, 3, 2}, {100, 0, 3, 1}};
+  int regions[4];
+  tflite::AddAndCheckPlacement(error_reporter, &planner, capacities, buffers,
+                               4, regions);
+  TF_LITE_MICRO_EXPECT_EQ(4, planner.GetBufferCount());
+  // The three buffers alive at time 1 need 250 bytes.
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(250),
+                          planner.GetRegionMemorySize(0));
+}
+
+TF_LITE_MICRO_TEST(TestHotBuffersGoToTheFastRegion) {
+  tflite::MicroErrorReporter micro_error_reporter;
+  tflite::ErrorReporter* error_reporter = &micro_error_reporter;
+
+  tflite::MultiRegionMemoryPlanner planner(tflite::g_scratch_buffer,
+                                           tflite::kScratchBufferSize);
+  // The slow region is added first, the speed decides the order.
+  const size_t capacities[] = {4096, 128};
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddRegion(error_reporter, capacities[0], 1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddRegion(error_reporter, capacities[1], 2));
+  const tflite::TestBuffer buffers[] = {
+      {1024, 0, 1, 2}, {64, 0, 2, 8}, {1024, 1, 2, 2}, {64, 2, 3, 8}};
+  int regions[4];
+  tflite::AddAndCheckPlacement(error_reporter, &planner, capacities, buffers,
+                               4, regions);
+  TF_LITE_MICRO_EXPECT_EQ(0, regions[0]);
+  TF_LITE_MICRO_EXPECT_EQ(1, regions[1]);
+  TF_LITE_MICRO_EXPECT_EQ(0, regions[2]);
+  TF_LITE_MICRO_EXPECT_EQ(1, regions[3]);
+}
+
+TF_LITE_MICRO_TEST(TestFullRegionSpillsToTheNextOne) {
+  tflite::MicroErrorReporter micro_error_reporter;
+  tflite::ErrorReporter* error_reporter = &micro_error_reporter;
+
+  tflite::MultiRegionMemoryPlanner planner(tflite::g_scratch_buffer,
+                                           tflite::kScratchBufferSize);
+  const size_t capacities[] = {256, 256, 1024};
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddRegion(error_reporter, capacities[0], 3));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddRegion(error_reporter, capacities[1], 2));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddRegion(error_reporter, capacities[2], 1));
+  // All alive at the same time, so they need 1000 bytes together.
+  const tflite::TestBuffer buffers[] = {
+      {100, 0, 4, 4}, {100, 0, 4, 4}, {100, 0, 4, 4}, {100, 0, 4, 4},
+      {100, 0, 4, 4}, {100, 0, 4, 4}, {200, 0, 4, 4}, {200, 0, 4, 4}};
+  int regions[8];
+  tflite::AddAndCheckPlacement(error_reporter, &planner, capacities, buffers,
+                               8, regions);
+  int region_counts[3] = {};
+  for (int i = 0; i < 8; ++i) {
+    ++region_counts[regions[i]];
+  }
+  TF_LITE_MICRO_EXPECT_EQ(2, region_counts[0]);
+  TF_LITE_MICRO_EXPECT_EQ(2, region_counts[1]);
+  TF_LITE_MICRO_EXPECT_EQ(4, region_counts[2]);
+  for (int r = 0; r < 3; ++r) {
+    TF_LITE_MICRO_EXPECT_LE(planner.GetRegionMemorySize(r), capacities[r]);
+  }
+}
+
+TF_LITE_MICRO_TEST(TestBufferThatFitsNoRegion) {
+  tflite::MicroErrorReporter micro_error_reporter;
+  tflite::ErrorReporter* error_reporter = &micro_error_reporter;
+
+  tflite::MultiRegionMemoryPlanner planner(tflite::g_scratch_buffer,
+                                           tflite::kScratchBufferSize);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, planner.AddRegion(error_reporter, 64, 2));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, planner.AddRegion(error_reporter, 128, 1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(error_reporter, 32, 0, 1, 1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(error_reporter, 256, 1, 2, 1));
+
+  int region = -1;
+  int offset = -1;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError,
+      planner.GetPlacementForBuffer(error_reporter, 0, &region, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError,
+      planner.GetPlacementForBuffer(error_reporter, 1, &region, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(-1, region);
+  TF_LITE_MICRO_EXPECT_EQ(-1, offset);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(0),
+                          planner.GetRegionMemorySize(0));
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(0),
+                          planner.GetRegionMemorySize(1));
+}
+
+TF_LITE_MICRO_TEST(TestBuffersThatFitNoRegionTogether) {
+  tflite::MicroErrorReporter micro_error_reporter;
+  tflite::ErrorReporter* error_reporter = &micro_error_reporter;
+
+  tflite::MultiRegionMemoryPlanner planner(tflite::g_scratch_buffer,
+                                           tflite::kScratchBufferSize);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, planner.AddRegion(error_reporter, 100, 1));
+  // Each fits on its own, but they are alive at the same time.
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(error_reporter, 60, 0, 1, 1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(error_reporter, 60, 1, 2, 1));
+
+  int region;
+  int offset;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError,
+      planner.GetPlacementForBuffer(error_reporter, 0, &region, &offset));
+}
+
+TF_LITE_MICRO_TEST(TestTooManyRegions) {
+  tflite::MicroErrorReporter micro_error_reporter;
+  tflite::ErrorReporter* error_reporter = &micro_error_reporter;
+
+  tflite::MultiRegionMemoryPlanner planner(tflite::g_scratch_buffer,
+                                           tflite::kScratchBufferSize);
+  for (int i = 0; i < tflite::MultiRegionMemoryPlanner::kMaxRegions; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                            planner.AddRegion(error_reporter, 1024, i));
+  }
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          planner.AddRegion(error_reporter, 1024, 0));
+  TF_LITE_MICRO_EXPECT_EQ(tflite::MultiRegionMemoryPlanner::kMaxRegions,
+                          planner.GetRegionCount());
+}
+
+TF_LITE_MICRO_TESTS_END
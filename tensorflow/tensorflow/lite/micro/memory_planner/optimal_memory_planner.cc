@@ -0,0 +1,300 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/memory_planner/optimal_memory_planner.h"
+
+#include "tensorflow/lite/micro/micro_time.h"
+
+namespace tflite {
+namespace {
+
+// How many placements are tried between two reads of the timer.
+constexpr int64_t kStepsPerTimeCheck = 256;
+
+}  // namespace
+
+OptimalMemoryPlanner::OptimalMemoryPlanner(unsigned char* scratch_buffer,
+                                           int scratch_buffer_size,
+                                           int32_t time_budget_ms,
+                                           int64_t max_search_steps)
+    : buffer_count_(0),
+      best_size_(0),
+      lower_bound_(0),
+      is_optimal_(false),
+      need_to_calculate_offsets_(true),
+      time_budget_ms_(time_budget_ms),
+      max_search_steps_(max_search_steps),
+      search_steps_(0),
+      deadline_ticks_(0) {
+  max_buffer_count_ = scratch_buffer_size / per_buffer_size();
+
+  unsigned char* next_free = scratch_buffer;
+  requirements_ = reinterpret_cast<BufferRequirements*>(next_free);
+  next_free += sizeof(BufferRequirements) * max_buffer_count_;
+  ids_sorted_by_size_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  offsets_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  best_offsets_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  placed_at_depth_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  next_candidate_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  top_at_depth_ = reinterpret_cast<int*>(next_free);
+}
+
+OptimalMemoryPlanner::~OptimalMemoryPlanner() {
+  // We don't own the scratch buffer, so don't deallocate anything.
+}
+
+TfLiteStatus OptimalMemoryPlanner::AddBuffer(ErrorReporter* error_reporter,
+                                             int size, int first_time_used,
+                                             int last_time_used) {
+  if (buffer_count_ >= max_buffer_count_) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Too many buffers (max is %d)",
+                         max_buffer_count_);
+    return kTfLiteError;
+  }
+  BufferRequirements* current = &requirements_[buffer_count_];
+  current->size = size;
+  current->first_time_used = first_time_used;
+  current->last_time_used = last_time_used;
+  ++buffer_count_;
+  need_to_calculate_offsets_ = true;
+  return kTfLiteOk;
+}
+
+bool OptimalMemoryPlanner::OverlapInTime(int a, int b) const {
+  return requirements_[a].first_time_used <= requirements_[b].last_time_used &&
+         requirements_[b].first_time_used <= requirements_[a].last_time_used;
+}
+
+bool OptimalMemoryPlanner::IsDuplicateOf(int a, int b) const {
+  return requirements_[a].size == requirements_[b].size &&
+         requirements_[a].first_time_used == requirements_[b].first_time_used &&
+         requirements_[a].last_time_used == requirements_[b].last_time_used;
+}
+
+int OptimalMemoryPlanner::LowestFit(int buffer) const {
+  const int size = requirements_[buffer].size;
+  // The lowest position is either zero or right above an active buffer.
+  int best = -1;
+  for (int c = -1; c < buffer_count_; ++c) {
+    int candidate = 0;
+    if (c >= 0) {
+      if (offsets_[c] < 0 || !OverlapInTime(c, buffer)) {
+        continue;
+      }
+      candidate = offsets_[c] + requirements_[c].size;
+    }
+    if (best >= 0 && candidate >= best) {
+      continue;
+    }
+    bool fits = true;
+    for (int other = 0; other < buffer_count_ && fits; ++other) {
+      if (offsets_[other] < 0 || !OverlapInTime(other, buffer)) {
+        continue;
+      }
+      fits = candidate + size <= offsets_[other] ||
+             offsets_[other] + requirements_[other].size <= candidate;
+    }
+    if (fits) {
+      best = candidate;
+    }
+  }
+  return best;
+}
+
+bool OptimalMemoryPlanner::IsCanonicalNext(int buffer, int depth) const {
+  // Of identical buffers, the one added first is placed first.
+  for (int other = 0; other < buffer; ++other) {
+    if (offsets_[other] < 0 && IsDuplicateOf(other, buffer)) {
+      return false;
+    }
+  }
+  // Buffers that are never active together don't affect each other's
+  // position, so only one of their two orders is tried.
+  if (depth == 0) {
+    return true;
+  }
+  const int previous = placed_at_depth_[depth - 1];
+  return buffer > previous || OverlapInTime(previous, buffer);
+}
+
+bool OptimalMemoryPlanner::BudgetExceeded() {
+  if (search_steps_ >= max_search_steps_) {
+    return true;
+  }
+  if (ticks_per_second() == 0 || search_steps_ % kStepsPerTimeCheck != 0) {
+    return false;
+  }
+  return GetCurrentTimeTicks64() >= deadline_ticks_;
+}
+
+void OptimalMemoryPlanner::Search() {
+  int depth = 0;
+  next_candidate_[0] = 0;
+  placed_at_depth_[0] = -1;
+  while (depth >= 0) {
+    // Take back the buffer tried last at this depth.
+    if (placed_at_depth_[depth] >= 0) {
+      offsets_[placed_at_depth_[depth]] = -1;
+      placed_at_depth_[depth] = -1;
+    }
+    if (best_size_ == lower_bound_) {
+      is_optimal_ = true;
+      return;
+    }
+    if (BudgetExceeded()) {
+      return;
+    }
+    int buffer = -1;
+    while (next_candidate_[depth] < buffer_count_) {
+      const int candidate = ids_sorted_by_size_[next_candidate_[depth]];
+      ++next_candidate_[depth];
+      if (offsets_[candidate] < 0 && IsCanonicalNext(candidate, depth)) {
+        buffer = candidate;
+        break;
+      }
+    }
+    if (buffer < 0) {
+      --depth;
+      continue;
+    }
+
+    ++search_steps_;
+    const int offset = LowestFit(buffer);
+    const int previous_top = depth > 0 ? top_at_depth_[depth - 1] : 0;
+    const int end = offset + requirements_[buffer].size;
+    const int top = end > previous_top ? end : previous_top;
+    if (top >= best_size_) {
+      continue;
+    }
+    offsets_[buffer] = offset;
+    placed_at_depth_[depth] = buffer;
+    top_at_depth_[depth] = top;
+    if (depth + 1 == buffer_count_) {
+      best_size_ = top;
+      for (int i = 0; i < buffer_count_; ++i) {
+        best_offsets_[i] = offsets_[i];
+      }
+      continue;
+    }
+    ++depth;
+    next_candidate_[depth] = 0;
+    placed_at_depth_[depth] = -1;
+  }
+  is_optimal_ = true;
+}
+
+void OptimalMemoryPlanner::CalculateOffsetsIfNeeded() {
+  if (!need_to_calculate_offsets_) {
+    return;
+  }
+  need_to_calculate_offsets_ = false;
+  is_optimal_ = false;
+  search_steps_ = 0;
+  best_size_ = 0;
+  lower_bound_ = 0;
+  if (buffer_count_ == 0) {
+    is_optimal_ = true;
+    return;
+  }
+
+  // Largest first, with a stable insertion sort.
+  for (int i = 0; i < buffer_count_; ++i) {
+    int position = i;
+    while (position > 0 &&
+           requirements_[ids_sorted_by_size_[position - 1]].size <
+               requirements_[i].size) {
+      ids_sorted_by_size_[position] = ids_sorted_by_size_[position - 1];
+      --position;
+    }
+    ids_sorted_by_size_[position] = i;
+  }
+
+  // The memory in use when a buffer starts is a lower bound for the arena,
+  // and the usage can only peak when some buffer starts.
+  for (int i = 0; i < buffer_count_; ++i) {
+    int active_size = 0;
+    for (int j = 0; j < buffer_count_; ++j) {
+      if (requirements_[j].first_time_used <=
+              requirements_[i].first_time_used &&
+          requirements_[i].first_time_used <= requirements_[j].last_time_used) {
+        active_size += requirements_[j].size;
+      }
+    }
+    if (active_size > lower_bound_) {
+      lower_bound_ = active_size;
+    }
+  }
+
+  // The greedy plan is the first solution to improve on.
+  for (int i = 0; i < buffer_count_; ++i) {
+    offsets_[i] = -1;
+  }
+  for (int i = 0; i < buffer_count_; ++i) {
+    const int buffer = ids_sorted_by_size_[i];
+    offsets_[buffer] = LowestFit(buffer);
+    const int end = offsets_[buffer] + requirements_[buffer].size;
+    if (end > best_size_) {
+      best_size_ = end;
+    }
+  }
+  for (int i = 0; i < buffer_count_; ++i) {
+    best_offsets_[i] = offsets_[i];
+    offsets_[i] = -1;
+  }
+
+  if (ticks_per_second() != 0) {
+    deadline_ticks_ =
+        GetCurrentTimeTicks64() +
+        static_cast<int64_t>(ticks_per_second()) * time_budget_ms_ / 1000;
+  }
+  Search();
+}
+
+size_t OptimalMemoryPlanner::GetMaximumMemorySize() {
+  CalculateOffsetsIfNeeded();
+  return best_size_;
+}
+
+int OptimalMemoryPlanner::GetBufferCount() { return buffer_count_; }
+
+TfLiteStatus OptimalMemoryPlanner::GetOffsetForBuffer(
+    ErrorReporter* error_reporter, int buffer_index, int* offset) {
+  CalculateOffsetsIfNeeded();
+  if ((buffer_index < 0) || (buffer_index >= buffer_count_)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "buffer index %d is outside range 0 to %d",
+                         buffer_index, buffer_count_);
+    return kTfLiteError;
+  }
+  *offset = best_offsets_[buffer_index];
+  return kTfLiteOk;
+}
+
+bool OptimalMemoryPlanner::IsOptimal() {
+  CalculateOffsetsIfNeeded();
+  return is_optimal_;
+}
+
+int OptimalMemoryPlanner::GetLowerBound() {
+  CalculateOffsetsIfNeeded();
+  return lower_bound_;
+}
+
+}  // namespace tflite
@@ -0,0 +1,135 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_OPTIMAL_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_OPTIMAL_MEMORY_PLANNER_H_
+
+#include <stdint.h>
+
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/memory_planner/memory_planner.h"
+
+namespace tflite {
+
+// A memory planner that searches for the smallest arena, for use on the host
+// where planning time is cheap. The result can be handed to the firmware with
+// PrecomputedMemoryPlanner, see tensorflow/lite/micro/tools/plan_memory.cc.
+//
+// Every buffer is placed at the lowest offset where it doesn't overlap any
+// already placed buffer that is active at the same time. Any layout can be
+// compacted into one built this way by placing its buffers in order of
+// increasing offset, so searching over the placement orders finds the
+// optimum. The search is a depth-first branch and bound:
+//  - It starts from the order of the GreedyMemoryPlanner, largest first, so
+//    the result is never worse than the greedy plan.
+//  - A partial order is abandoned as soon as it reaches the size of the best
+//    plan found so far.
+//  - Orders that only differ by swapping buffers that are never active at the
+//    same time, or buffers with identical size and lifetime, give the same
+//    layout and are only tried once.
+//  - It stops early when the plan reaches the lower bound, the largest total
+//    size of the buffers active at any one time.
+//
+// The search is exponential in the worst case, so it's limited by a time
+// budget, after which the best plan found so far is used. IsOptimal() tells
+// whether the search completed.
+class OptimalMemoryPlanner : public MemoryPlanner {
+ public:
+  // The scratch buffer holds the planning state like for the
+  // GreedyMemoryPlanner, per_buffer_size() bytes per buffer. The search
+  // stops after `time_budget_ms` milliseconds as measured by
+  // GetCurrentTimeTicks64(), or after `max_search_steps` placements, whichever
+  // comes first. Only the step limit applies on platforms without a timer.
+  OptimalMemoryPlanner(unsigned char* scratch_buffer, int scratch_buffer_size,
+                       int32_t time_budget_ms = 1000,
+                       int64_t max_search_steps = 10000000);
+  ~OptimalMemoryPlanner() override;
+
+  TfLiteStatus AddBuffer(ErrorReporter* error_reporter, int size,
+                         int first_time_used, int last_time_used) override;
+  size_t GetMaximumMemorySize() override;
+  int GetBufferCount() override;
+  TfLiteStatus GetOffsetForBuffer(ErrorReporter* error_reporter,
+                                  int buffer_index, int* offset) override;
+
+  // True when the search completed, so no smaller layout exists.
+  bool IsOptimal();
+
+  // The arena size that no layout can go below.
+  int GetLowerBound();
+
+  // Number of buffer placements tried by the search.
+  int64_t search_steps() const { return search_steps_; }
+
+  // Number of bytes required in order to plan a buffer.
+  static size_t per_buffer_size() {
+    return sizeof(BufferRequirements) +  // requirements_
+           sizeof(int) +                 // ids_sorted_by_size_
+           sizeof(int) +                 // offsets_
+           sizeof(int) +                 // best_offsets_
+           sizeof(int) +                 // placed_at_depth_
+           sizeof(int) +                 // next_candidate_
+           sizeof(int);                  // top_at_depth_
+  }
+
+ private:
+  struct BufferRequirements {
+    int size;
+    int first_time_used;
+    int last_time_used;
+  };
+
+  bool OverlapInTime(int a, int b) const;
+  bool IsDuplicateOf(int a, int b) const;
+  // Lowest offset where `buffer` fits between the placed buffers.
+  int LowestFit(int buffer) const;
+  // Whether `buffer` may follow the buffer placed at `depth` - 1, or is a
+  // permutation of an order that was already tried.
+  bool IsCanonicalNext(int buffer, int depth) const;
+  bool BudgetExceeded();
+  void CalculateOffsetsIfNeeded();
+  void Search();
+
+  int max_buffer_count_;
+  int buffer_count_;
+
+  BufferRequirements* requirements_;
+  int* ids_sorted_by_size_;
+  // Offsets of the placed buffers in the current search state, -1 if not
+  // placed.
+  int* offsets_;
+  int* best_offsets_;
+  // The buffer placed at each depth of the search, -1 if none.
+  int* placed_at_depth_;
+  // Position in ids_sorted_by_size_ of the next buffer to try at each depth.
+  int* next_candidate_;
+  // End of the highest buffer placed up to each depth.
+  int* top_at_depth_;
+
+  int best_size_;
+  int lower_bound_;
+  bool is_optimal_;
+  bool need_to_calculate_offsets_;
+
+  int32_t time_budget_ms_;
+  int64_t max_search_steps_;
+  int64_t search_steps_;
+  int64_t deadline_ticks_;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_OPTIMAL_MEMORY_PLANNER_H_
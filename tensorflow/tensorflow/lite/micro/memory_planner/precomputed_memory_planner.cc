@@ -0,0 +1,116 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/memory_planner/precomputed_memory_planner.h"
+
+namespace tflite {
+namespace {
+
+// The alignment of the buffers in the arena, kBufferAlignment in
+// micro_allocator.cc. Misaligned float and int32 tensors fault on the
+// Cortex-M7.
+constexpr int kBufferAlignment = 16;
+
+}  // namespace
+
+PrecomputedMemoryPlanner::PrecomputedMemoryPlanner(
+    const int32_t* offsets, int offset_count, unsigned char* scratch_buffer,
+    int scratch_buffer_size)
+    : offsets_(offsets), offset_count_(offset_count), buffer_count_(0) {
+  max_buffer_count_ = scratch_buffer_size / per_buffer_size();
+  requirements_ = reinterpret_cast<BufferRequirements*>(scratch_buffer);
+}
+
+PrecomputedMemoryPlanner::~PrecomputedMemoryPlanner() {
+  // We don't own the scratch buffer, so don't deallocate anything.
+}
+
+TfLiteStatus PrecomputedMemoryPlanner::AddBuffer(
+    ErrorReporter* error_reporter, int size, int first_time_used,
+    int last_time_used) {
+  if (buffer_count_ >= max_buffer_count_) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Too many buffers (max is %d)",
+                         max_buffer_count_);
+    return kTfLiteError;
+  }
+  BufferRequirements* current = &requirements_[buffer_count_];
+  current->size = size;
+  current->first_time_used = first_time_used;
+  current->last_time_used = last_time_used;
+  ++buffer_count_;
+  return kTfLiteOk;
+}
+
+size_t PrecomputedMemoryPlanner::GetMaximumMemorySize() {
+  size_t max_size = 0;
+  for (int i = 0; i < buffer_count_ && i < offset_count_; ++i) {
+    const size_t end = offsets_[i] + requirements_[i].size;
+    if (end > max_size) {
+      max_size = end;
+    }
+  }
+  return max_size;
+}
+
+int PrecomputedMemoryPlanner::GetBufferCount() { return buffer_count_; }
+
+TfLiteStatus PrecomputedMemoryPlanner::GetOffsetForBuffer(
+    ErrorReporter* error_reporter, int buffer_index, int* offset) {
+  if (buffer_count_ != offset_count_) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Memory plan has %d buffers, but %d are needed",
+                         offset_count_, buffer_count_);
+    return kTfLiteError;
+  }
+  if ((buffer_index < 0) || (buffer_index >= buffer_count_)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "buffer index %d is outside range 0 to %d",
+                         buffer_index, buffer_count_);
+    return kTfLiteError;
+  }
+  const BufferRequirements& buffer = requirements_[buffer_index];
+  const int start = offsets_[buffer_index];
+  if (start < 0) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Memory plan has a negative offset for buffer %d",
+                         buffer_index);
+    return kTfLiteError;
+  }
+  if (start % kBufferAlignment != 0) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Memory plan offset %d of buffer %d isn't a multiple "
+                         "of %d",
+                         start, buffer_index, kBufferAlignment);
+    return kTfLiteError;
+  }
+  for (int i = 0; i < buffer_count_; ++i) {
+    const BufferRequirements& other = requirements_[i];
+    if (i == buffer_index || other.first_time_used > buffer.last_time_used ||
+        buffer.first_time_used > other.last_time_used) {
+      continue;
+    }
+    if (start < offsets_[i] + other.size && offsets_[i] < start + buffer.size) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Memory plan places buffers %d and %d in the same "
+                           "memory while both are in use",
+                           buffer_index, i);
+      return kTfLiteError;
+    }
+  }
+  *offset = start;
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
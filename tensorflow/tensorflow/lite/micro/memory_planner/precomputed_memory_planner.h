@@ -0,0 +1,73 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_PRECOMPUTED_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_PRECOMPUTED_MEMORY_PLANNER_H_
+
+#include <stdint.h>
+
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/memory_planner/memory_planner.h"
+
+namespace tflite {
+
+// A memory planner that places the buffers at offsets calculated ahead of
+// time, e.g. by the OptimalMemoryPlanner through
+// tensorflow/lite/micro/tools/plan_memory.cc. The N-th offset is used for the
+// N-th buffer added.
+//
+// The plan only fits the model and interpreter options it was made for, so
+// GetOffsetForBuffer() checks that the number of buffers matches, that the
+// offset is 16 bytes aligned like the buffers of the arena and that the
+// buffer doesn't overlap another one active at the same time. A stale or
+// malformed plan then makes AllocateTensors() fail instead of corrupting
+// tensors.
+class PrecomputedMemoryPlanner : public MemoryPlanner {
+ public:
+  // `offsets` must outlive the planner. The scratch buffer records the
+  // buffers for the checks, per_buffer_size() bytes per buffer.
+  PrecomputedMemoryPlanner(const int32_t* offsets, int offset_count,
+                           unsigned char* scratch_buffer,
+                           int scratch_buffer_size);
+  ~PrecomputedMemoryPlanner() override;
+
+  TfLiteStatus AddBuffer(ErrorReporter* error_reporter, int size,
+                         int first_time_used, int last_time_used) override;
+  size_t GetMaximumMemorySize() override;
+  int GetBufferCount() override;
+  TfLiteStatus GetOffsetForBuffer(ErrorReporter* error_reporter,
+                                  int buffer_index, int* offset) override;
+
+  // Number of bytes required in order to plan a buffer.
+  static size_t per_buffer_size() { return sizeof(BufferRequirements); }
+
+ private:
+  struct BufferRequirements {
+    int size;
+    int first_time_used;
+    int last_time_used;
+  };
+
+  const int32_t* offsets_;
+  int offset_count_;
+  int max_buffer_count_;
+  int buffer_count_;
+  BufferRequirements* requirements_;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_PRECOMPUTED_MEMORY_PLANNER_H_
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
@@ -25,11 +26,19 @@ limitations under the License.
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/micro/compatibility.h"
 #include "tensorflow/lite/micro/memory_helpers.h"
-#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/interval_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/multi_region_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/precomputed_memory_planner.h"
+#include "tensorflow/lite/micro/micro_graph_fusion.h"
+#include "tensorflow/lite/micro/micro_snapshot.h"
 #include "tensorflow/lite/micro/simple_memory_allocator.h"
 
 namespace tflite {
 
+// The head of the arena is one more region for the planner.
+static_assert(kMaxMemoryRegions < MultiRegionMemoryPlanner::kMaxRegions,
+              "MultiRegionMemoryPlanner supports too few regions");
+
 namespace {
 // Used to hold information used during allocation calculations.
 struct AllocationInfo {
@@ -38,6 +47,11 @@ struct AllocationInfo {
   int last_used;
   bool needs_allocating;
   void** output_ptr;
+  // Index of the tensor whose memory this tensor shares, or -1. Such a
+  // tensor isn't planned, see AllocationInfoBuilder::AddInPlaceAliases().
+  int alias_of;
+  // How many nodes read or write the buffer.
+  int access_count;
 };
 
 // We align tensor buffers to 16-byte boundaries, since this is a common
@@ -80,6 +94,34 @@ TfLiteStatus AllocateVariables(
   return kTfLiteOk;
 }
 
+// Operators whose kernels read every element of their first input before
+// writing the same element of their output, so both may share one buffer.
+// RESHAPE skips its copy when they do.
+bool CanRunInPlace(int32_t builtin_code) {
+  switch (builtin_code) {
+    case BuiltinOperator_RESHAPE:
+    case BuiltinOperator_RELU:
+    case BuiltinOperator_RELU6:
+    case BuiltinOperator_LOGISTIC:
+    case BuiltinOperator_TANH:
+    case BuiltinOperator_ABS:
+    case BuiltinOperator_SIN:
+    case BuiltinOperator_COS:
+    case BuiltinOperator_LOG:
+    case BuiltinOperator_SQRT:
+    case BuiltinOperator_RSQRT:
+    case BuiltinOperator_SQUARE:
+    case BuiltinOperator_LOGICAL_NOT:
+    case BuiltinOperator_NEG:
+    case BuiltinOperator_FLOOR:
+    case BuiltinOperator_CEIL:
+    case BuiltinOperator_ROUND:
+      return true;
+    default:
+      return false;
+  }
+}
+
 // A helper class to construct AllocationInfo array. This array contains the
 // lifetime of tensors / scratch_buffer and will be used to calculate the memory
 // plan. Methods need to be called in order from `Init`, `Add*`, to `Finish`.
@@ -97,9 +139,18 @@ class AllocationInfoBuilder {
     return Allocate();
   }
 
-  // Add allocaiton information for the tensors.
+  // Add allocaiton information for the tensors. Tensors that need allocating
+  // get room for `batch_size` copies of their data. Lifetimes come from the
+  // inputs and outputs of the runtime nodes, which may differ from the
+  // flatbuffer after graph fusion.
   TfLiteStatus AddTensors(const SubGraph* subgraph,
-                          TfLiteTensor* runtime_tensors);
+                          const NodeAndRegistration* node_and_registrations,
+                          TfLiteTensor* runtime_tensors, int batch_size);
+  // Lets the output of an operator that can run in place share the memory of
+  // its input when the input isn't used after that operator. Must be called
+  // after AddTensors.
+  void AddInPlaceAliases(const SubGraph* subgraph,
+                         const NodeAndRegistration* node_and_registrations);
   // Add allocation information for the scratch buffers.
   TfLiteStatus AddScratchBuffers(internal::ScratchBufferHandle* buffer_handles);
 
@@ -132,18 +183,23 @@ TfLiteStatus AllocationInfoBuilder::Allocate() {
   return kTfLiteOk;
 }
 
-TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
-                                               TfLiteTensor* runtime_tensors) {
+TfLiteStatus AllocationInfoBuilder::AddTensors(
+    const SubGraph* subgraph, const NodeAndRegistration* node_and_registrations,
+    TfLiteTensor* runtime_tensors, int batch_size) {
   // Set up allocation info for all tensors.
   for (size_t i = 0; i < tensor_count_; ++i) {
     AllocationInfo* current = &info_[i];
     // TfLiteTensor.uint8 field is deprecated so use .data field instead.
     current->output_ptr = &(runtime_tensors[i].data.data);
-    current->bytes = runtime_tensors[i].bytes;
     current->first_created = -1;
     current->last_used = -1;
+    current->alias_of = -1;
+    current->access_count = 0;
     current->needs_allocating = (runtime_tensors[i].data.data == nullptr) &&
                                 (!subgraph->tensors()->Get(i)->is_variable());
+    current->bytes = current->needs_allocating
+                         ? runtime_tensors[i].bytes * batch_size
+                         : runtime_tensors[i].bytes;
   }
 
   for (size_t i = 0; i < subgraph->inputs()->size(); ++i) {
@@ -161,20 +217,26 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
 
   // Figure out when the first and last use of each tensor is.
   for (int i = (subgraph->operators()->size() - 1); i >= 0; --i) {
-    const auto* op = subgraph->operators()->Get(i);
-    for (size_t n = 0; n < op->inputs()->size(); ++n) {
-      const int tensor_index = op->inputs()->Get(n);
+    const TfLiteNode* node = &node_and_registrations[i].node;
+    for (int n = 0; n < node->inputs->size; ++n) {
+      const int tensor_index = node->inputs->data[n];
+      // Optional inputs that are left out.
+      if (tensor_index < 0) {
+        continue;
+      }
       AllocationInfo* current = &info_[tensor_index];
       if (((current->last_used == -1) || (current->last_used < i))) {
         current->last_used = i;
       }
+      ++current->access_count;
     }
-    for (size_t n = 0; n < op->outputs()->size(); ++n) {
-      const int tensor_index = op->outputs()->Get(n);
+    for (int n = 0; n < node->outputs->size; ++n) {
+      const int tensor_index = node->outputs->data[n];
       AllocationInfo* current = &info_[tensor_index];
       if ((current->first_created == -1) || (current->first_created > i)) {
         current->first_created = i;
       }
+      ++current->access_count;
     }
   }
 
@@ -183,11 +245,14 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
     AllocationInfo* current = &info_[i];
     const bool is_read_only =
         (current->first_created == -1) && (current->last_used != -1);
-    if (is_read_only) {
+    // E.g. intermediate tensors removed by graph fusion.
+    const bool is_unused =
+        (current->first_created == -1) && (current->last_used == -1);
+    if (is_read_only || is_unused) {
       current->needs_allocating = false;
     }
     const bool has_partial_lifetime =
-        !is_read_only &&
+        !is_read_only && !is_unused &&
         ((current->first_created == -1) || (current->last_used == -1));
     if (has_partial_lifetime && current->needs_allocating) {
       TF_LITE_REPORT_ERROR(
@@ -201,6 +266,47 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
   return kTfLiteOk;
 }
 
+void AllocationInfoBuilder::AddInPlaceAliases(
+    const SubGraph* subgraph,
+    const NodeAndRegistration* node_and_registrations) {
+  for (size_t i = 0; i < subgraph->operators()->size(); ++i) {
+    const TfLiteNode* node = &node_and_registrations[i].node;
+    if (!CanRunInPlace(node_and_registrations[i].registration->builtin_code) ||
+        node->inputs->size < 1 || node->outputs->size != 1) {
+      continue;
+    }
+    const int input_index = node->inputs->data[0];
+    const int output_index = node->outputs->data[0];
+    if (input_index < 0 || input_index == output_index) {
+      continue;
+    }
+    AllocationInfo* input = &info_[input_index];
+    AllocationInfo* output = &info_[output_index];
+    // Constant, variable and bound inputs keep their own memory, and so do the
+    // inputs and outputs of the model, which the caller reads and writes.
+    const bool input_planned =
+        input->needs_allocating || input->alias_of != -1;
+    if (!input_planned || !output->needs_allocating ||
+        input->last_used != static_cast<int>(i) ||
+        input->bytes != output->bytes ||
+        internal::IsGraphInput(subgraph, input_index) ||
+        internal::IsGraphOutput(subgraph, input_index)) {
+      continue;
+    }
+    // Chains share the memory of the first tensor, which stays alive as long
+    // as any tensor of the chain.
+    const int root_index =
+        input->alias_of == -1 ? input_index : input->alias_of;
+    AllocationInfo* root = &info_[root_index];
+    output->alias_of = root_index;
+    output->needs_allocating = false;
+    root->access_count += output->access_count;
+    if (root->last_used < output->last_used) {
+      root->last_used = output->last_used;
+    }
+  }
+}
+
 TfLiteStatus AllocationInfoBuilder::AddScratchBuffers(
     internal::ScratchBufferHandle* buffer_handles) {
   // Set up allocation info for buffers.
@@ -213,6 +319,8 @@ TfLiteStatus AllocationInfoBuilder::AddScratchBuffers(
     current->first_created = handle->node_idx;
     current->last_used = handle->node_idx;
     current->needs_allocating = true;
+    current->alias_of = -1;
+    current->access_count = 1;
   }
   return kTfLiteOk;
 }
@@ -234,6 +342,76 @@ TfLiteStatus CreatePlan(ErrorReporter* error_reporter, MemoryPlanner* planner,
   return kTfLiteOk;
 }
 
+int CountPlannedBuffers(const AllocationInfo* allocation_info,
+                        size_t allocation_info_size) {
+  int count = 0;
+  for (size_t i = 0; i < allocation_info_size; ++i) {
+    if (allocation_info[i].needs_allocating) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+// The number and requested size of the planned buffers. The used bytes
+// depend on the plan.
+MicroAllocationStats PlannedBufferStats(const AllocationInfo* allocation_info,
+                                        size_t allocation_info_size) {
+  MicroAllocationStats stats = {};
+  for (size_t i = 0; i < allocation_info_size; ++i) {
+    if (allocation_info[i].needs_allocating) {
+      stats.requested_bytes += allocation_info[i].bytes;
+      ++stats.count;
+    }
+  }
+  return stats;
+}
+
+// Returns the offsets stored in the kPrecomputedMemoryPlanMetadata of the
+// model, or nullptr if it has none or they are for a different number of
+// buffers, in which case the plan is calculated at runtime.
+const int32_t* GetOfflinePlan(ErrorReporter* error_reporter,
+                              const Model* model, int planned_count) {
+  constexpr int kHeaderSize = 3;
+  if (model->metadata() == nullptr) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < model->metadata()->size(); ++i) {
+    const Metadata* metadata = model->metadata()->Get(i);
+    if (metadata->name() == nullptr ||
+        strcmp(metadata->name()->c_str(), kPrecomputedMemoryPlanMetadata) !=
+            0) {
+      continue;
+    }
+    const Buffer* buffer = nullptr;
+    if (model->buffers() != nullptr &&
+        metadata->buffer() < model->buffers()->size()) {
+      buffer = model->buffers()->Get(metadata->buffer());
+    }
+    const flatbuffers::Vector<uint8_t>* data =
+        buffer != nullptr ? buffer->data() : nullptr;
+    // The buffer data is 16 bytes aligned by the flatbuffer schema.
+    if (data == nullptr || data->size() < kHeaderSize * sizeof(int32_t) ||
+        reinterpret_cast<uintptr_t>(data->data()) % alignof(int32_t) != 0) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Invalid offline memory plan, planning at runtime");
+      return nullptr;
+    }
+    const int32_t* values = reinterpret_cast<const int32_t*>(data->data());
+    const int32_t count = values[2];
+    if (values[0] != 0 || values[1] != 0 || count != planned_count ||
+        data->size() != (kHeaderSize + count) * sizeof(int32_t)) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Offline memory plan of version %d has %d buffers "
+                           "but %d are needed, planning at runtime",
+                           values[0], count, planned_count);
+      return nullptr;
+    }
+    return values + kHeaderSize;
+  }
+  return nullptr;
+}
+
 TfLiteStatus CommitPlan(ErrorReporter* error_reporter, MemoryPlanner* planner,
                         uint8_t* starting_point,
                         const AllocationInfo* allocation_info,
@@ -252,6 +430,163 @@ TfLiteStatus CommitPlan(ErrorReporter* error_reporter, MemoryPlanner* planner,
   }
   return kTfLiteOk;
 }
+
+// Places the planned buffers in the head of the arena, as region 0 of speed
+// 0, and in the extra memory regions. The planner scratch is taken from the
+// head of `tmp_allocator`.
+TfLiteStatus CommitMultiRegionPlan(
+    ErrorReporter* error_reporter, SimpleMemoryAllocator* tmp_allocator,
+    uint8_t* head, size_t head_capacity, MicroMemoryRegion* regions,
+    int region_count, const AllocationInfo* allocation_info,
+    size_t allocation_info_size, size_t* head_used_bytes,
+    size_t* planner_bytes) {
+  const int planned_count =
+      CountPlannedBuffers(allocation_info, allocation_info_size);
+  *planner_bytes =
+      planned_count * MultiRegionMemoryPlanner::per_buffer_size();
+  uint8_t* planner_arena =
+      tmp_allocator->AllocateFromHead(*planner_bytes, alignof(int));
+  TF_LITE_ENSURE(error_reporter, planner_arena != nullptr);
+  MultiRegionMemoryPlanner planner(planner_arena, *planner_bytes);
+  TF_LITE_ENSURE_STATUS(
+      planner.AddRegion(error_reporter, head_capacity, /*speed=*/0));
+  for (int r = 0; r < region_count; ++r) {
+    TF_LITE_ENSURE_STATUS(planner.AddRegion(error_reporter, regions[r].size,
+                                            regions[r].speed));
+  }
+  for (size_t i = 0; i < allocation_info_size; ++i) {
+    const AllocationInfo* current = &allocation_info[i];
+    if (current->needs_allocating) {
+      TF_LITE_ENSURE_STATUS(planner.AddBuffer(
+          error_reporter, AlignSizeUp(current->bytes, kBufferAlignment),
+          current->first_created, current->last_used, current->access_count));
+    }
+  }
+
+  int planner_index = 0;
+  for (size_t i = 0; i < allocation_info_size; ++i) {
+    const AllocationInfo* current = &allocation_info[i];
+    if (current->needs_allocating) {
+      int region_index = -1;
+      int offset = -1;
+      TF_LITE_ENSURE_STATUS(planner.GetPlacementForBuffer(
+          error_reporter, planner_index, &region_index, &offset));
+      uint8_t* base = region_index == 0 ? head : regions[region_index - 1].data;
+      *current->output_ptr = reinterpret_cast<void*>(base + offset);
+      ++planner_index;
+    }
+  }
+  *head_used_bytes = planner.GetRegionMemorySize(0);
+  for (int r = 0; r < region_count; ++r) {
+    regions[r].used_bytes = planner.GetRegionMemorySize(r + 1);
+  }
+  return kTfLiteOk;
+}
+
+// Points the tensors sharing the memory of another one at its buffer, after
+// the plan is committed.
+void CommitAliases(const AllocationInfo* allocation_info,
+                   size_t allocation_info_size) {
+  for (size_t i = 0; i < allocation_info_size; ++i) {
+    const AllocationInfo* current = &allocation_info[i];
+    if (current->alias_of != -1) {
+      *current->output_ptr = *allocation_info[current->alias_of].output_ptr;
+    }
+  }
+}
+
+// Passes the planned buffers to `writer` once the plan is committed. Region 0
+// starts at `head`.
+void WriteMemoryPlan(MemoryPlanWriter* writer, const uint8_t* head,
+                     const MicroMemoryRegion* regions, int region_count,
+                     const AllocationInfo* allocation_info,
+                     size_t allocation_info_size, size_t tensor_count) {
+  writer->Start();
+  int buffer_index = 0;
+  for (size_t i = 0; i < allocation_info_size; ++i) {
+    const AllocationInfo* current = &allocation_info[i];
+    if (!current->needs_allocating) {
+      continue;
+    }
+    const uint8_t* data = static_cast<const uint8_t*>(*current->output_ptr);
+    MemoryPlanRecord record;
+    record.buffer_index = buffer_index;
+    record.is_scratch_buffer = i >= tensor_count;
+    record.id = record.is_scratch_buffer ? static_cast<int>(i - tensor_count)
+                                         : static_cast<int>(i);
+    record.size = AlignSizeUp(current->bytes, kBufferAlignment);
+    record.first_time_used = current->first_created;
+    record.last_time_used = current->last_used;
+    record.region = 0;
+    record.offset = data - head;
+    for (int r = 0; r < region_count; ++r) {
+      if (data >= regions[r].data && data < regions[r].data + regions[r].size) {
+        record.region = r + 1;
+        record.offset = data - regions[r].data;
+      }
+    }
+    writer->WriteRecord(record);
+    ++buffer_index;
+  }
+}
+
+bool EqualZeroPoints(const TfLiteIntArray* array,
+                     const flatbuffers::Vector<int64_t>* zero_points) {
+  if (array->size != static_cast<int>(zero_points->size())) {
+    return false;
+  }
+  for (int i = 0; i < array->size; ++i) {
+    if (array->data[i] != zero_points->Get(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool EqualScales(const TfLiteFloatArray* array,
+                 const flatbuffers::Vector<float>* scales) {
+  if (reinterpret_cast<const void*>(array) ==
+      reinterpret_cast<const void*>(scales)) {
+    return true;
+  }
+  if (array->size != static_cast<int>(scales->size())) {
+    return false;
+  }
+  for (int i = 0; i < array->size; ++i) {
+    if (array->data[i] != scales->Get(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Looks for quantization params equal to `src` among the tensors initialized
+// before. Sets `quantization` to params that can be shared as a whole, or
+// else `zero_points` to an equal zero point array if there is one.
+void FindSharedQuantization(const QuantizationParameters& src,
+                            const TfLiteTensor* tensors, size_t tensor_count,
+                            TfLiteAffineQuantization** quantization,
+                            TfLiteIntArray** zero_points) {
+  *quantization = nullptr;
+  *zero_points = nullptr;
+  for (size_t i = 0; i < tensor_count; ++i) {
+    if (tensors[i].quantization.type != kTfLiteAffineQuantization) {
+      continue;
+    }
+    auto* candidate = static_cast<TfLiteAffineQuantization*>(
+        tensors[i].quantization.params);
+    if (!EqualZeroPoints(candidate->zero_point, src.zero_point())) {
+      continue;
+    }
+    *zero_points = candidate->zero_point;
+    if (candidate->quantized_dimension == src.quantized_dimension() &&
+        EqualScales(candidate->scale, src.scale())) {
+      *quantization = candidate;
+      return;
+    }
+  }
+}
+
 }  // namespace
 
 namespace internal {
@@ -259,7 +594,8 @@ namespace internal {
 TfLiteStatus InitializeRuntimeTensor(
     SimpleMemoryAllocator* allocator, const tflite::Tensor& flatbuffer_tensor,
     const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
-    ErrorReporter* error_reporter, TfLiteTensor* result) {
+    ErrorReporter* error_reporter, TfLiteTensor* result,
+    const TfLiteTensor* initialized_tensors, size_t initialized_count) {
   *result = {};
   // Make sure the serialized type is one we know how to deal with, and convert
   // it from a flatbuffer enum into a constant used by the kernel C API.
@@ -315,6 +651,10 @@ TfLiteStatus InitializeRuntimeTensor(
   result->dims = const_cast<TfLiteIntArray*>(
       reinterpret_cast<const TfLiteIntArray*>(flatbuffer_tensor.shape()));
 
+  if (flatbuffer_tensor.name() != nullptr) {
+    result->name = flatbuffer_tensor.name()->c_str();
+  }
+
   // Copy the quantization information from the serialized data.
   const auto* src_quantization = flatbuffer_tensor.quantization();
   if (src_quantization && src_quantization->scale() &&
@@ -330,26 +670,50 @@ TfLiteStatus InitializeRuntimeTensor(
     result->params.zero_point =
         static_cast<int32_t>(src_quantization->zero_point()->Get(0));
 
-    // Populate per-channel quantization params.
+    // Populate per-channel quantization params. Tensors with equal params,
+    // like the input and output of a reshape, share them, and so do equal
+    // zero point arrays, e.g. the all zero ones of symmetric weights.
+    TfLiteAffineQuantization* quantization;
+    TfLiteIntArray* zero_points;
+    FindSharedQuantization(*src_quantization, initialized_tensors,
+                           initialized_count, &quantization, &zero_points);
+    if (quantization != nullptr) {
+      result->quantization = {kTfLiteAffineQuantization, quantization};
+      return kTfLiteOk;
+    }
+
     int channels = src_quantization->scale()->size();
-    TfLiteAffineQuantization* quantization =
-        reinterpret_cast<TfLiteAffineQuantization*>(
-            allocator->AllocateFromTail(sizeof(TfLiteAffineQuantization),
-                                        alignof(TfLiteAffineQuantization)));
+    quantization = reinterpret_cast<TfLiteAffineQuantization*>(
+        allocator->AllocateFromTail(sizeof(TfLiteAffineQuantization),
+                                    alignof(TfLiteAffineQuantization)));
     if (quantization == nullptr) {
       TF_LITE_REPORT_ERROR(error_reporter,
                            "Unable to allocate TfLiteAffineQuantization.\n");
       return kTfLiteError;
     }
-    quantization->zero_point =
-        reinterpret_cast<TfLiteIntArray*>(allocator->AllocateFromTail(
-            TfLiteIntArrayGetSizeInBytes(channels), alignof(TfLiteIntArray)));
-    if (quantization->zero_point == nullptr) {
-      TF_LITE_REPORT_ERROR(error_reporter,
-                           "Unable to allocate quantization->zero_point.\n");
-      return kTfLiteError;
+    if (zero_points == nullptr) {
+      // The serialized zero points are 64-bit, so they are always copied.
+      zero_points =
+          reinterpret_cast<TfLiteIntArray*>(allocator->AllocateFromTail(
+              TfLiteIntArrayGetSizeInBytes(channels), alignof(TfLiteIntArray)));
+      if (zero_points == nullptr) {
+        TF_LITE_REPORT_ERROR(error_reporter,
+                             "Unable to allocate quantization->zero_point.\n");
+        return kTfLiteError;
+      }
+      zero_points->size = channels;
+      for (int i = 0; i < channels; i++) {
+        zero_points->data[i] = src_quantization->zero_point()->Get(i);
+      }
     }
-
+    quantization->zero_point = zero_points;
+
+#if FLATBUFFERS_LITTLEENDIAN
+    // A serialized float vector has the layout of a TfLiteFloatArray on
+    // little-endian targets, like the dims above.
+    quantization->scale = const_cast<TfLiteFloatArray*>(
+        reinterpret_cast<const TfLiteFloatArray*>(src_quantization->scale()));
+#else
     quantization->scale = reinterpret_cast<TfLiteFloatArray*>(
         allocator->AllocateFromTail(TfLiteFloatArrayGetSizeInBytes(channels),
                                     alignof(TfLiteFloatArray)));
@@ -358,26 +722,37 @@ TfLiteStatus InitializeRuntimeTensor(
                            "Unable to allocate quantization->scale.\n");
       return kTfLiteError;
     }
-
-    quantization->zero_point->size = channels;
     quantization->scale->size = channels;
-    int* zero_point_data = quantization->zero_point->data;
-    float* scale_data = quantization->scale->data;
     for (int i = 0; i < channels; i++) {
-      zero_point_data[i] = src_quantization->zero_point()->Get(i);
-      scale_data[i] = src_quantization->scale()->Get(i);
+      quantization->scale->data[i] = src_quantization->scale()->Get(i);
     }
+#endif
     // TODO(rocky): Need to add a micro_allocator test case that fails when
     // this is not copied:
     quantization->quantized_dimension = src_quantization->quantized_dimension();
 
     result->quantization = {kTfLiteAffineQuantization, quantization};
   }
-  if (flatbuffer_tensor.name() != nullptr) {
-    result->name = flatbuffer_tensor.name()->c_str();
-  }
   return kTfLiteOk;
 }
+
+bool IsGraphInput(const SubGraph* subgraph, int tensor_index) {
+  for (size_t i = 0; i < subgraph->inputs()->size(); ++i) {
+    if (subgraph->inputs()->Get(i) == tensor_index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsGraphOutput(const SubGraph* subgraph, int tensor_index) {
+  for (size_t i = 0; i < subgraph->outputs()->size(); ++i) {
+    if (subgraph->outputs()->Get(i) == tensor_index) {
+      return true;
+    }
+  }
+  return false;
+}
 }  // namespace internal
 
 TfLiteStatus MicroAllocator::Init() {
@@ -389,6 +764,7 @@ TfLiteStatus MicroAllocator::Init() {
   }
   subgraph_ = (*subgraphs)[0];
 
+  TailCounters tail = GetTailCounters();
   context_->tensors_size = subgraph_->tensors()->size();
   context_->tensors =
       reinterpret_cast<TfLiteTensor*>(memory_allocator_->AllocateFromTail(
@@ -401,18 +777,23 @@ TfLiteStatus MicroAllocator::Init() {
         sizeof(TfLiteTensor) * context_->tensors_size);
     return kTfLiteError;
   }
+  RecordTailAllocations(kMicroAllocationTensorStructs, tail);
+  tail = GetTailCounters();
 
   // Initialize runtime tensors in context_ using the flatbuffer.
   for (size_t i = 0; i < subgraph_->tensors()->size(); ++i) {
     TfLiteStatus status = internal::InitializeRuntimeTensor(
         memory_allocator_, *subgraph_->tensors()->Get(i), model_->buffers(),
-        error_reporter_, &context_->tensors[i]);
+        error_reporter_, &context_->tensors[i], context_->tensors, i);
     if (status != kTfLiteOk) {
       TF_LITE_REPORT_ERROR(error_reporter_, "Failed to initialize tensor %d",
                            i);
       return kTfLiteError;
     }
   }
+  // Quantization params are the only tail allocations made while
+  // initializing the runtime tensors.
+  RecordTailAllocations(kMicroAllocationQuantization, tail);
 
   return kTfLiteOk;
 }
@@ -430,6 +811,22 @@ size_t MicroAllocator::used_bytes() const {
   return memory_allocator_->GetUsedBytes();
 }
 
+size_t MicroAllocator::RequiredArenaBytes() const {
+  const MicroArenaUsage& usage = arena_usage_;
+  const size_t tail_bytes =
+      usage.allocator_bytes + usage.tensor_struct_bytes +
+      usage.quantization_bytes + usage.node_and_registration_bytes +
+      usage.builtin_data_bytes + usage.persistent_buffer_bytes +
+      usage.scratch_handle_bytes + usage.variable_bytes +
+      usage.batch_dims_bytes + usage.recording_bytes;
+  // Variables are allocated after planning, so they don't overlap with the
+  // temporary planning memory.
+  const size_t planning_peak =
+      tail_bytes - usage.variable_bytes + usage.planning_bytes;
+  const size_t final_layout = tail_bytes + usage.planned_bytes;
+  return planning_peak > final_layout ? planning_peak : final_layout;
+}
+
 MicroAllocator::MicroAllocator(TfLiteContext* context, const Model* model,
                                uint8_t* tensor_arena, size_t arena_size,
                                ErrorReporter* error_reporter)
@@ -448,6 +845,7 @@ MicroAllocator::MicroAllocator(TfLiteContext* context, const Model* model,
   // destructed as it's the root allocator.
   memory_allocator_ = CreateInPlaceSimpleMemoryAllocator(
       error_reporter, aligned_arena, aligned_arena_size);
+  RecordTailAllocations(kMicroAllocationAllocator, TailCounters{0, 0, 0});
   TfLiteStatus status = Init();
   // TODO(b/147871299): Consider improving this code. A better way of handling
   // failures in the constructor is to have a static function that returns a
@@ -468,6 +866,7 @@ TfLiteStatus MicroAllocator::AllocateNodeAndRegistrations(
     return kTfLiteError;
   }
 
+  const TailCounters tail = GetTailCounters();
   auto* output = reinterpret_cast<NodeAndRegistration*>(
       memory_allocator_->AllocateFromTail(
           sizeof(NodeAndRegistration) * subgraph_->operators()->size(),
@@ -478,6 +877,7 @@ TfLiteStatus MicroAllocator::AllocateNodeAndRegistrations(
         "Failed to allocate memory for node_and_registrations.");
     return kTfLiteError;
   }
+  RecordTailAllocations(kMicroAllocationNodeAndRegistrations, tail);
   TfLiteStatus status = kTfLiteOk;
   auto* opcodes = model_->operator_codes();
   MicroBuiltinDataAllocator builtin_data_allocator(memory_allocator_);
@@ -523,9 +923,11 @@ TfLiteStatus MicroAllocator::AllocateNodeAndRegistrations(
       custom_data = reinterpret_cast<const char*>(op->custom_options()->data());
       custom_data_size = op->custom_options()->size();
     } else {
+      const TailCounters builtin_data_tail = GetTailCounters();
       TF_LITE_ENSURE_STATUS(ParseOpData(op, op_type, error_reporter_,
                                         &builtin_data_allocator,
                                         (void**)(&builtin_data)));
+      RecordTailAllocations(kMicroAllocationBuiltinData, builtin_data_tail, i);
     }
 
     // Disregard const qualifier to workaround with existing API.
@@ -542,6 +944,7 @@ TfLiteStatus MicroAllocator::AllocateNodeAndRegistrations(
     node->custom_initial_data = custom_data;
     node->custom_initial_data_size = custom_data_size;
   }
+  node_and_registrations_ = output;
   *node_and_registrations = output;
   return kTfLiteOk;
 }
@@ -550,10 +953,38 @@ TfLiteStatus MicroAllocator::FinishTensorAllocation() {
   if (!active_) {
     return kTfLiteError;
   }
+  if (node_and_registrations_ == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "AllocateNodeAndRegistrations() must be called "
+                         "before FinishTensorAllocation()");
+    return kTfLiteError;
+  }
+
+  // Move the scratch buffer handles out of the temporary memory, so the head
+  // is free for the plan.
+  if (scratch_buffer_count_ > 0) {
+    const TailCounters tail = GetTailCounters();
+    const size_t handle_bytes =
+        scratch_buffer_count_ * sizeof(internal::ScratchBufferHandle);
+    internal::ScratchBufferHandle* handles =
+        reinterpret_cast<internal::ScratchBufferHandle*>(
+            memory_allocator_->AllocateFromTail(
+                handle_bytes, alignof(internal::ScratchBufferHandle)));
+    if (handles == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Failed to allocate %d scratch buffer handles",
+                           scratch_buffer_count_);
+      return kTfLiteError;
+    }
+    std::memcpy(handles, scratch_buffer_handles_, handle_bytes);
+    scratch_buffer_handles_ = handles;
+    RecordTailAllocations(kMicroAllocationScratchHandles, tail);
+  }
+  memory_allocator_->ResetTempAllocations();
 
   // Create static memory plan
   // 1. Calculate AllocationInfo to know the lifetime of each tensor/buffer.
-  // 2. Add them into the planner (such as the GreedyMemoryPlanner).
+  // 2. Add them into the planner (such as the IntervalMemoryPlanner).
   // 3. Static memory planning using the planner.
   // 4. Set tensor/buffer pointers based on the offsets from the previous step.
   // Note that AllocationInfo is only needed for creating the plan. It will be
@@ -566,44 +997,124 @@ TfLiteStatus MicroAllocator::FinishTensorAllocation() {
     AllocationInfoBuilder builder(error_reporter_, &tmp_allocator);
     TF_LITE_ENSURE_STATUS(
         builder.Init(subgraph_->tensors()->size(), scratch_buffer_count_));
-    TF_LITE_ENSURE_STATUS(builder.AddTensors(subgraph_, context_->tensors));
+    const size_t allocation_info_bytes = tmp_allocator.GetTailUsedBytes();
+    TF_LITE_ENSURE_STATUS(
+        builder.AddTensors(subgraph_, node_and_registrations_,
+                           context_->tensors, max_batch_size_));
+    builder.AddInPlaceAliases(subgraph_, node_and_registrations_);
     TF_LITE_ENSURE_STATUS(builder.AddScratchBuffers(scratch_buffer_handles_));
     const AllocationInfo* allocation_info = builder.Finish();
+    MicroAllocationStats* planned_stats =
+        &allocation_stats_[kMicroAllocationPlannedBuffers];
+    *planned_stats = PlannedBufferStats(allocation_info, builder.Size());
+
+    if (memory_region_count_ > 0) {
+      // A planner set with SetMemoryPlanner, or stored in the model, only
+      // knows about the arena.
+      if (memory_planner_ != nullptr) {
+        TF_LITE_REPORT_ERROR(error_reporter_,
+                             "A memory planner can't be combined with memory "
+                             "regions");
+        return kTfLiteError;
+      }
+      size_t planner_bytes = 0;
+      TF_LITE_ENSURE_STATUS(CommitMultiRegionPlan(
+          error_reporter_, &tmp_allocator, memory_allocator_->GetHead(),
+          memory_allocator_->GetAvailableMemory(), memory_regions_,
+          memory_region_count_, allocation_info, builder.Size(),
+          &arena_usage_.planned_bytes, &planner_bytes));
+      planned_stats->used_bytes = arena_usage_.planned_bytes;
+      arena_usage_.planning_bytes = allocation_info_bytes + planner_bytes;
+      CommitAliases(allocation_info, builder.Size());
+      if (memory_plan_writer_ != nullptr) {
+        WriteMemoryPlan(memory_plan_writer_, memory_allocator_->GetHead(),
+                        memory_regions_, memory_region_count_,
+                        allocation_info, builder.Size(),
+                        subgraph_->tensors()->size());
+      }
+      uint8_t* allocated_tensor_memory = memory_allocator_->AllocateFromHead(
+          arena_usage_.planned_bytes, /*alignment=*/1);
+      TF_LITE_ENSURE(error_reporter_, allocated_tensor_memory != nullptr);
+    } else {
+      // The planner set with SetMemoryPlanner comes first, then the plan stored
+      // in the model. Otherwise the remaining arena is the scratch buffer of an
+      // IntervalMemoryPlanner.
+      const int planned_count =
+          CountPlannedBuffers(allocation_info, builder.Size());
+      const int32_t* offline_offsets = nullptr;
+      if (memory_planner_ == nullptr) {
+        offline_offsets =
+            GetOfflinePlan(error_reporter_, model_, planned_count);
+      }
+      size_t planner_arena_size = 0;
+      uint8_t* planner_arena = nullptr;
+      if (offline_offsets != nullptr) {
+        planner_arena_size =
+            planned_count * PrecomputedMemoryPlanner::per_buffer_size();
+        planner_arena =
+            tmp_allocator.AllocateFromHead(planner_arena_size, alignof(int));
+        TF_LITE_ENSURE(error_reporter_, planner_arena != nullptr);
+      } else if (memory_planner_ == nullptr) {
+        planner_arena_size = tmp_allocator.GetAvailableMemory();
+        planner_arena =
+            tmp_allocator.AllocateFromHead(planner_arena_size, /*alignment=*/1);
+        TF_LITE_ENSURE(error_reporter_, planner_arena != nullptr);
+      }
+      IntervalMemoryPlanner interval_planner(planner_arena, planner_arena_size);
+      PrecomputedMemoryPlanner offline_planner(offline_offsets, planned_count,
+                                               planner_arena,
+                                               planner_arena_size);
+      MemoryPlanner* planner = &interval_planner;
+      arena_usage_.planning_bytes =
+          allocation_info_bytes +
+          planned_count * IntervalMemoryPlanner::per_buffer_size();
+      if (memory_planner_ != nullptr) {
+        planner = memory_planner_;
+        arena_usage_.planning_bytes = allocation_info_bytes;
+      } else if (offline_offsets != nullptr) {
+        planner = &offline_planner;
+        arena_usage_.planning_bytes =
+            allocation_info_bytes + planner_arena_size;
+      }
+      TF_LITE_ENSURE_STATUS(CreatePlan(error_reporter_, planner,
+                                       allocation_info, builder.Size()));
+      arena_usage_.planned_bytes = planner->GetMaximumMemorySize();
+      planned_stats->used_bytes = arena_usage_.planned_bytes;
+
+      size_t actual_available_arena_size =
+          memory_allocator_->GetAvailableMemory();
+      // Make sure we have enough arena size.
+      if (planner->GetMaximumMemorySize() > actual_available_arena_size) {
+        TF_LITE_REPORT_ERROR(
+            error_reporter_,
+            "Arena size is too small for activation buffers. Needed %d but "
+            "only %d was available.",
+            planner->GetMaximumMemorySize(), actual_available_arena_size);
+        return kTfLiteError;
+      }
 
-    // Remaining arena size that memory planner can use for calculating offsets.
-    size_t remaining_arena_size = tmp_allocator.GetAvailableMemory();
-    uint8_t* planner_arena =
-        tmp_allocator.AllocateFromHead(remaining_arena_size, /*alignment=*/1);
-    TF_LITE_ENSURE(error_reporter_, planner_arena != nullptr);
-    GreedyMemoryPlanner planner(planner_arena, remaining_arena_size);
-    TF_LITE_ENSURE_STATUS(
-        CreatePlan(error_reporter_, &planner, allocation_info, builder.Size()));
-
-    size_t actual_available_arena_size =
-        memory_allocator_->GetAvailableMemory();
-    // Make sure we have enough arena size.
-    if (planner.GetMaximumMemorySize() > actual_available_arena_size) {
-      TF_LITE_REPORT_ERROR(
-          error_reporter_,
-          "Arena size is too small for activation buffers. Needed %d but only "
-          "%d was available.",
-          planner.GetMaximumMemorySize(), actual_available_arena_size);
-      return kTfLiteError;
+      // Commit the plan.
+      TF_LITE_ENSURE_STATUS(CommitPlan(error_reporter_, planner,
+                                       memory_allocator_->GetHead(),
+                                       allocation_info, builder.Size()));
+      CommitAliases(allocation_info, builder.Size());
+      if (memory_plan_writer_ != nullptr) {
+        WriteMemoryPlan(memory_plan_writer_, memory_allocator_->GetHead(),
+                        /*regions=*/nullptr, /*region_count=*/0,
+                        allocation_info, builder.Size(),
+                        subgraph_->tensors()->size());
+      }
+      // Allocate the planned area, so the allocator knows it's used.
+      uint8_t* allocated_tensor_memory =
+          memory_allocator_->AllocateFromHead(planner->GetMaximumMemorySize(),
+                                              /*alignment=*/1);
+      TF_LITE_ENSURE(error_reporter_, allocated_tensor_memory != nullptr);
     }
-
-    // Commit the plan.
-    TF_LITE_ENSURE_STATUS(CommitPlan(error_reporter_, &planner,
-                                     memory_allocator_->GetHead(),
-                                     allocation_info, builder.Size()));
-    // Allocate the planned area, so the allocator knows it's used.
-    uint8_t* allocated_tensor_memory =
-        memory_allocator_->AllocateFromHead(planner.GetMaximumMemorySize(),
-                                            /*alignment=*/1);
-    TF_LITE_ENSURE(error_reporter_, allocated_tensor_memory != nullptr);
   }
 
   // Data in variables need to be kept for the next invocation so allocating
   // them from the tail (persistent area).
+  const TailCounters tail = GetTailCounters();
   if (AllocateVariables(subgraph_->tensors(), context_->tensors,
                         memory_allocator_) != kTfLiteOk) {
     TF_LITE_REPORT_ERROR(
@@ -611,13 +1122,15 @@ TfLiteStatus MicroAllocator::FinishTensorAllocation() {
         "Failed to allocate variables. Please increase arena size.");
     return kTfLiteError;
   }
+  RecordTailAllocations(kMicroAllocationVariables, tail);
 
   active_ = false;
   return kTfLiteOk;
 }
 
-TfLiteStatus MicroAllocator::AllocatePersistentBuffer(size_t bytes,
-                                                      void** ptr) {
+TfLiteStatus MicroAllocator::AllocatePersistentBuffer(size_t bytes, void** ptr,
+                                                      int node_id) {
+  const TailCounters tail = GetTailCounters();
   uint8_t* data = memory_allocator_->AllocateFromTail(bytes, kBufferAlignment);
   if (data == nullptr) {
     TF_LITE_REPORT_ERROR(error_reporter_,
@@ -625,6 +1138,7 @@ TfLiteStatus MicroAllocator::AllocatePersistentBuffer(size_t bytes,
                          bytes);
     return kTfLiteError;
   }
+  RecordTailAllocations(kMicroAllocationPersistentBuffers, tail, node_id);
   (*ptr) = data;
   return kTfLiteOk;
 }
@@ -632,37 +1146,370 @@ TfLiteStatus MicroAllocator::AllocatePersistentBuffer(size_t bytes,
 TfLiteStatus MicroAllocator::RequestScratchBufferInArena(int node_id,
                                                          size_t bytes,
                                                          int* buffer_idx) {
-  // A sanity check to make sure scratch_buffer_handles_ is contiguous i.e.
-  // scratch_buffer_handles_ is pointing to the last allocation from memory
-  // allocator.
-  if (scratch_buffer_handles_ != nullptr &&
-      reinterpret_cast<uint8_t*>(scratch_buffer_handles_) !=
-          memory_allocator_->GetTail()) {
-    TF_LITE_REPORT_ERROR(error_reporter_,
-                         "Internal error: AllocateFromTail can not be called "
-                         "between two RequestScratchBufferInArena calls.");
-    return kTfLiteError;
-  }
-
-  internal::ScratchBufferHandle* handle =
+  // The handles are kept in temporary memory above the head while the
+  // kernels are prepared, and FinishTensorAllocation() moves them to the tail.
+  // The temporary array always starts at the same address, so allocating it
+  // again with one more handle keeps the handles requested so far.
+  memory_allocator_->ResetTempAllocations();
+  internal::ScratchBufferHandle* handles =
       reinterpret_cast<internal::ScratchBufferHandle*>(
-          memory_allocator_->AllocateFromTail(
-              sizeof(internal::ScratchBufferHandle),
+          memory_allocator_->AllocateTemp(
+              (scratch_buffer_count_ + 1) *
+                  sizeof(internal::ScratchBufferHandle),
               alignof(internal::ScratchBufferHandle)));
-  if (handle == nullptr) {
+  if (handles == nullptr) {
     TF_LITE_REPORT_ERROR(error_reporter_,
-                         "Failed to register scratch buffer handle for node %s",
+                         "Failed to register scratch buffer handle for node %d",
                          node_id);
     return kTfLiteError;
   }
+  TF_LITE_ENSURE(error_reporter_, scratch_buffer_count_ == 0 ||
+                                      handles == scratch_buffer_handles_);
+  if (node_allocations_ != nullptr && node_id >= 0) {
+    MicroAllocationStats* stats = &node_allocations_[node_id].scratch_buffers;
+    stats->requested_bytes += bytes;
+    stats->used_bytes += AlignSizeUp(bytes, kBufferAlignment);
+    ++stats->count;
+  }
+  internal::ScratchBufferHandle* handle = &handles[scratch_buffer_count_];
   *handle = {};
   handle->bytes = bytes;
   handle->node_idx = node_id;
   *buffer_idx = scratch_buffer_count_;
   scratch_buffer_count_ += 1;
-  // scratch_buffer_handles_ is in reverse order. The following code ensures
-  // that scratch_buffers[0] is pointing to the newly allocated handle.
-  scratch_buffer_handles_ = handle;
+  scratch_buffer_handles_ = handles;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroAllocator::ReserveBatchDimension(int max_batch_size) {
+  if (!active_) {
+    return kTfLiteError;
+  }
+  const TailCounters tail = GetTailCounters();
+  for (size_t i = 0; i < context_->tensors_size; ++i) {
+    TfLiteTensor* tensor = &context_->tensors[i];
+    // The tensors the planner places in the head, and the ones bound to
+    // caller owned buffers, which hold a batch as well.
+    if ((tensor->allocation_type != kTfLiteArenaRw &&
+         tensor->allocation_type != kTfLiteCustom) ||
+        tensor->is_variable) {
+      continue;
+    }
+    if (tensor->dims->size == 0 || tensor->dims->data[0] != 1) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Tensor %d can't be batched, its first dimension "
+                           "must be 1.",
+                           i);
+      return kTfLiteError;
+    }
+    // The original dims point into the flatbuffer, which is read only.
+    TfLiteIntArray* dims =
+        reinterpret_cast<TfLiteIntArray*>(memory_allocator_->AllocateFromTail(
+            TfLiteIntArrayGetSizeInBytes(tensor->dims->size),
+            alignof(TfLiteIntArray)));
+    if (dims == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Failed to allocate dims for batched tensor %d", i);
+      return kTfLiteError;
+    }
+    dims->size = tensor->dims->size;
+    for (int d = 0; d < dims->size; ++d) {
+      dims->data[d] = tensor->dims->data[d];
+    }
+    tensor->dims = dims;
+  }
+  RecordTailAllocations(kMicroAllocationBatchDims, tail);
+  max_batch_size_ = max_batch_size;
+  return kTfLiteOk;
+}
+
+MicroAllocator::TailCounters MicroAllocator::GetTailCounters() const {
+  return {memory_allocator_->GetTailUsedBytes(),
+          memory_allocator_->GetTailRequestedBytes(),
+          memory_allocator_->GetTailAllocationCount()};
+}
+
+void MicroAllocator::RecordTailAllocations(MicroAllocationCategory category,
+                                           const TailCounters& since,
+                                           int node_index) {
+  const TailCounters now = GetTailCounters();
+  MicroAllocationStats delta;
+  delta.requested_bytes = now.requested_bytes - since.requested_bytes;
+  delta.used_bytes = now.used_bytes - since.used_bytes;
+  delta.count = now.count - since.count;
+
+  MicroAllocationStats* stats[2] = {&allocation_stats_[category], nullptr};
+  if (node_allocations_ != nullptr && node_index >= 0) {
+    if (category == kMicroAllocationBuiltinData) {
+      stats[1] = &node_allocations_[node_index].builtin_data;
+    } else if (category == kMicroAllocationPersistentBuffers) {
+      stats[1] = &node_allocations_[node_index].persistent_buffers;
+    }
+  }
+  for (MicroAllocationStats* current : stats) {
+    if (current != nullptr) {
+      current->requested_bytes += delta.requested_bytes;
+      current->used_bytes += delta.used_bytes;
+      current->count += delta.count;
+    }
+  }
+
+  // The byte counts of MicroArenaUsage are the same numbers.
+  size_t* usage_bytes = nullptr;
+  switch (category) {
+    case kMicroAllocationAllocator:
+      usage_bytes = &arena_usage_.allocator_bytes;
+      break;
+    case kMicroAllocationTensorStructs:
+      usage_bytes = &arena_usage_.tensor_struct_bytes;
+      break;
+    case kMicroAllocationQuantization:
+      usage_bytes = &arena_usage_.quantization_bytes;
+      break;
+    case kMicroAllocationNodeAndRegistrations:
+      usage_bytes = &arena_usage_.node_and_registration_bytes;
+      break;
+    case kMicroAllocationBuiltinData:
+      usage_bytes = &arena_usage_.builtin_data_bytes;
+      break;
+    case kMicroAllocationPersistentBuffers:
+      usage_bytes = &arena_usage_.persistent_buffer_bytes;
+      break;
+    case kMicroAllocationScratchHandles:
+      usage_bytes = &arena_usage_.scratch_handle_bytes;
+      break;
+    case kMicroAllocationVariables:
+      usage_bytes = &arena_usage_.variable_bytes;
+      break;
+    case kMicroAllocationBatchDims:
+      usage_bytes = &arena_usage_.batch_dims_bytes;
+      break;
+    case kMicroAllocationRecording:
+      usage_bytes = &arena_usage_.recording_bytes;
+      break;
+    default:
+      // Planned buffers are in the head.
+      break;
+  }
+  if (usage_bytes != nullptr) {
+    *usage_bytes += delta.used_bytes;
+  }
+}
+
+TfLiteStatus MicroAllocator::EnableRecording() {
+  if (!active_) {
+    return kTfLiteError;
+  }
+  if (node_and_registrations_ != nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "EnableRecording() must be called before "
+                         "AllocateNodeAndRegistrations()");
+    return kTfLiteError;
+  }
+  if (node_allocations_ != nullptr) {
+    return kTfLiteOk;
+  }
+  const TailCounters tail = GetTailCounters();
+  const size_t operator_count = subgraph_->operators()->size();
+  node_allocations_ = reinterpret_cast<MicroNodeAllocations*>(
+      memory_allocator_->AllocateFromTail(
+          sizeof(MicroNodeAllocations) * operator_count,
+          alignof(MicroNodeAllocations)));
+  if (node_allocations_ == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate memory for recording, %d bytes "
+                         "required",
+                         sizeof(MicroNodeAllocations) * operator_count);
+    return kTfLiteError;
+  }
+  for (size_t i = 0; i < operator_count; ++i) {
+    node_allocations_[i] = {};
+  }
+  RecordTailAllocations(kMicroAllocationRecording, tail);
+  return kTfLiteOk;
+}
+
+const MicroNodeAllocations* MicroAllocator::node_allocations(
+    int node_index) const {
+  if (node_allocations_ == nullptr || node_index < 0 ||
+      static_cast<size_t>(node_index) >= subgraph_->operators()->size()) {
+    return nullptr;
+  }
+  return &node_allocations_[node_index];
+}
+
+void MicroAllocator::PrintAllocations() const {
+  static const char* const kCategoryNames[kMicroAllocationCategoryCount] = {
+      "SimpleMemoryAllocator",     "TfLiteTensor array",
+      "Quantization params",       "NodeAndRegistration array",
+      "Builtin op data",           "Persistent kernel buffers",
+      "Scratch buffer handles",    "Variable tensors",
+      "Batched tensor dims",       "Allocation records",
+      "Planned tensors and scratch buffers"};
+  TF_LITE_REPORT_ERROR(error_reporter_,
+                       "Arena allocations (used bytes, requested bytes, "
+                       "count):");
+  for (int i = 0; i < kMicroAllocationCategoryCount; ++i) {
+    const MicroAllocationStats& stats = allocation_stats_[i];
+    TF_LITE_REPORT_ERROR(error_reporter_, "  %s: %u, %u, %u",
+                         kCategoryNames[i], stats.used_bytes,
+                         stats.requested_bytes, stats.count);
+  }
+  if (node_allocations_ == nullptr) {
+    return;
+  }
+  TF_LITE_REPORT_ERROR(error_reporter_,
+                       "Node allocations (used bytes, count):");
+  for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
+    const char* name = "";
+    if (node_and_registrations_ != nullptr &&
+        node_and_registrations_[i].registration != nullptr) {
+      const TfLiteRegistration* registration =
+          node_and_registrations_[i].registration;
+      name = registration->builtin_code == BuiltinOperator_CUSTOM
+                 ? registration->custom_name
+                 : EnumNameBuiltinOperator(
+                       BuiltinOperator(registration->builtin_code));
+    }
+    const MicroNodeAllocations& node = node_allocations_[i];
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "  %d %s: builtin data %u, %u; persistent %u, %u; "
+                         "scratch %u, %u",
+                         i, name, node.builtin_data.used_bytes,
+                         node.builtin_data.count,
+                         node.persistent_buffers.used_bytes,
+                         node.persistent_buffers.count,
+                         node.scratch_buffers.used_bytes,
+                         node.scratch_buffers.count);
+  }
+}
+
+void MicroAllocator::SetMemoryPlanner(MemoryPlanner* planner) {
+  memory_planner_ = planner;
+}
+
+void MicroAllocator::SetMemoryPlanWriter(MemoryPlanWriter* writer) {
+  memory_plan_writer_ = writer;
+}
+
+void MicroAllocator::SaveState(MicroSnapshotState* state) const {
+  state->model = model_;
+  state->arena_start =
+      memory_allocator_->GetHead() - memory_allocator_->GetHeadUsedBytes();
+  state->arena_end = tail() + tail_bytes();
+  state->scratch_buffer_handles = scratch_buffer_handles_;
+  state->scratch_buffer_count = scratch_buffer_count_;
+  state->node_and_registrations = node_and_registrations_;
+  memcpy(state->memory_regions, memory_regions_, sizeof(memory_regions_));
+  state->memory_region_count = memory_region_count_;
+  state->arena_usage = arena_usage_;
+  memcpy(state->allocation_stats, allocation_stats_,
+         sizeof(allocation_stats_));
+  state->node_allocations = node_allocations_;
+  state->max_batch_size = max_batch_size_;
+}
+
+TfLiteStatus MicroAllocator::RestoreState(const OpResolver& op_resolver,
+                                          const MicroSnapshotState& state,
+                                          const uint8_t* saved_tail,
+                                          size_t saved_tail_bytes) {
+  if (!active_) {
+    return kTfLiteError;
+  }
+  // Nothing but the constructor allocated so far, so the head is at the
+  // start of the arena.
+  uint8_t* arena_start = memory_allocator_->GetHead();
+  uint8_t* arena_end =
+      memory_allocator_->GetTail() + memory_allocator_->GetTailUsedBytes();
+  if (state.model != model_ || state.arena_start != arena_start ||
+      state.arena_end != arena_end ||
+      saved_tail_bytes > static_cast<size_t>(arena_end - arena_start)) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "The snapshot was made for another model or arena");
+    return kTfLiteError;
+  }
+  if (state.memory_region_count != memory_region_count_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "The snapshot was made with other memory regions");
+    return kTfLiteError;
+  }
+  for (int r = 0; r < memory_region_count_; ++r) {
+    if (state.memory_regions[r].data != memory_regions_[r].data ||
+        state.memory_regions[r].size != memory_regions_[r].size ||
+        state.memory_regions[r].speed != memory_regions_[r].speed) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "The snapshot was made with other memory regions");
+      return kTfLiteError;
+    }
+  }
+
+  // The nodes are read from the snapshot's copy of the tail. Their
+  // registrations point into the op resolver and the firmware, which must
+  // not have changed.
+  uint8_t* tail_start = arena_end - saved_tail_bytes;
+  const size_t node_count = subgraph_->operators()->size();
+  const uint8_t* nodes =
+      reinterpret_cast<const uint8_t*>(state.node_and_registrations);
+  if (nodes < tail_start ||
+      nodes + sizeof(NodeAndRegistration) * node_count > arena_end) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Invalid snapshot");
+    return kTfLiteError;
+  }
+  auto* opcodes = model_->operator_codes();
+  for (size_t i = 0; i < node_count; ++i) {
+    NodeAndRegistration saved;
+    memcpy(&saved, saved_tail + (nodes - tail_start) + sizeof(saved) * i,
+           sizeof(saved));
+    if (IsFusedNode(saved)) {
+      continue;
+    }
+    const size_t index = subgraph_->operators()->Get(i)->opcode_index();
+    const TfLiteRegistration* registration = nullptr;
+    if (index >= opcodes->size() ||
+        GetRegistrationFromOpCode((*opcodes)[index], op_resolver,
+                                  error_reporter_,
+                                  &registration) != kTfLiteOk ||
+        registration != saved.registration) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "The snapshot was made with other kernels");
+      return kTfLiteError;
+    }
+  }
+
+  memcpy(tail_start, saved_tail, saved_tail_bytes);
+  scratch_buffer_handles_ = state.scratch_buffer_handles;
+  scratch_buffer_count_ = state.scratch_buffer_count;
+  node_and_registrations_ = state.node_and_registrations;
+  memcpy(memory_regions_, state.memory_regions, sizeof(memory_regions_));
+  arena_usage_ = state.arena_usage;
+  memcpy(allocation_stats_, state.allocation_stats, sizeof(allocation_stats_));
+  node_allocations_ = state.node_allocations;
+  max_batch_size_ = state.max_batch_size;
+  active_ = false;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroAllocator::AddMemoryRegion(uint8_t* buffer, size_t size,
+                                             int speed) {
+  if (!active_) {
+    return kTfLiteError;
+  }
+  if (memory_region_count_ >= kMaxMemoryRegions) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Too many memory regions (max is %d)",
+                         kMaxMemoryRegions);
+    return kTfLiteError;
+  }
+  uint8_t* aligned_buffer = AlignPointerUp(buffer, kBufferAlignment);
+  if (buffer == nullptr || aligned_buffer >= buffer + size) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Invalid memory region");
+    return kTfLiteError;
+  }
+  MicroMemoryRegion* region = &memory_regions_[memory_region_count_];
+  region->data = aligned_buffer;
+  region->size = buffer + size - aligned_buffer;
+  region->speed = speed;
+  region->used_bytes = 0;
+  ++memory_region_count_;
   return kTfLiteOk;
 }
 
@@ -673,8 +1520,7 @@ void* MicroAllocator::GetScratchBuffer(int buffer_idx) const {
                          buffer_idx, scratch_buffer_count_);
     return nullptr;
   }
-  // scratch_buffer_handles_ is in reverse order.
-  return scratch_buffer_handles_[scratch_buffer_count_ - buffer_idx - 1].data;
+  return scratch_buffer_handles_[buffer_idx].data;
 }
 
 }  // namespace tflite
@@ -18,6 +18,8 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/flatbuffer_conversions.h"
+#include "tensorflow/lite/micro/memory_planner/memory_plan_writer.h"
+#include "tensorflow/lite/micro/memory_planner/memory_planner.h"
 #include "tensorflow/lite/micro/simple_memory_allocator.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
@@ -27,11 +29,16 @@ namespace tflite {
 namespace internal {
 
 // Sets up all of the data structure members for a runtime tensor
-// based on the contents of a serialized tensor.
+// based on the contents of a serialized tensor. The dims, and on
+// little-endian targets the quantization scales, point into the flatbuffer.
+// Quantization params equal to those of one of the `initialized_count`
+// tensors at `initialized_tensors` are shared instead of allocated.
 TfLiteStatus InitializeRuntimeTensor(
     SimpleMemoryAllocator* allocator, const tflite::Tensor& flatbuffer_tensor,
     const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
-    ErrorReporter* error_reporter, TfLiteTensor* result);
+    ErrorReporter* error_reporter, TfLiteTensor* result,
+    const TfLiteTensor* initialized_tensors = nullptr,
+    size_t initialized_count = 0);
 
 // A handle tracking scratch buffer allocation. This handle is created by
 // `RequestScratchBufferInArena`. `data` field is populated in
@@ -50,13 +57,107 @@ typedef struct {
   // have `before` = node_idx and `after` = node_idx.
   int node_idx;
 } ScratchBufferHandle;
+
+// Whether `tensor_index` is one of the inputs, or outputs, of `subgraph`.
+bool IsGraphInput(const SubGraph* subgraph, int tensor_index);
+bool IsGraphOutput(const SubGraph* subgraph, int tensor_index);
 }  // namespace internal
 
+// Name of the model metadata holding a memory plan made offline by
+// tensorflow/lite/micro/tools/plan_memory.cc. Its buffer is an array of
+// int32 values:
+//   [0] format version, 0
+//   [1] subgraph index, 0
+//   [2] number of offsets n
+//   [3 .. n + 2] head offsets of the planned buffers, in the order the
+//       allocator plans them: the tensors that need allocating by tensor
+//       index, then the scratch buffers in the order of their requests.
+//       Tensors sharing the memory of their input, see MicroAllocator, are
+//       not planned.
+// The plan depends on the interpreter settings, such as the batch size, so it
+// is only used when n matches the number of buffers to plan.
+// The name differs from the "OfflineMemoryAllocation" metadata of upstream
+// TensorFlow Lite, which has a different layout.
+constexpr char kPrecomputedMemoryPlanMetadata[] = "PrecomputedMemoryPlan";
+
 typedef struct {
   TfLiteNode node;
   const TfLiteRegistration* registration;
 } NodeAndRegistration;
 
+// Memory besides the tensor arena that the memory plan may use, see
+// MicroAllocator::AddMemoryRegion().
+typedef struct {
+  uint8_t* data;
+  size_t size;
+  // Relative to the other regions and to the head of the arena, which has
+  // speed 0. Higher is faster.
+  int speed;
+  // High-water mark of the planned buffers, set by FinishTensorAllocation.
+  size_t used_bytes;
+} MicroMemoryRegion;
+
+// How many regions can be added with MicroAllocator::AddMemoryRegion().
+constexpr int kMaxMemoryRegions = 3;
+
+// Breakdown of the arena used by a MicroAllocator, in bytes including the
+// alignment padding of every allocation. See MicroAllocator::arena_usage().
+typedef struct {
+  // Head of the arena: tensors and scratch buffers laid out by the memory
+  // planner.
+  size_t planned_bytes;
+  // Tail of the arena, kept for the life time of the allocator.
+  size_t allocator_bytes;              // The in-place SimpleMemoryAllocator.
+  size_t tensor_struct_bytes;          // The TfLiteTensor array.
+  size_t quantization_bytes;           // TfLiteAffineQuantization params.
+  size_t node_and_registration_bytes;  // The NodeAndRegistration array.
+  size_t builtin_data_bytes;           // Parsed builtin op params.
+  size_t persistent_buffer_bytes;      // Kernel data, e.g. OpData.
+  size_t scratch_handle_bytes;         // ScratchBufferHandle structs.
+  size_t variable_bytes;               // Variable tensors.
+  size_t batch_dims_bytes;             // Dims of batched tensors.
+  size_t recording_bytes;              // Per node allocation records.
+  // Temporary memory needed between head and tail while the memory plan is
+  // calculated: the AllocationInfo array and the planner scratch buffer.
+  size_t planning_bytes;
+} MicroArenaUsage;
+
+// What the arena is used for, see MicroAllocator::allocation_stats().
+typedef enum {
+  kMicroAllocationAllocator = 0,         // allocator_bytes
+  kMicroAllocationTensorStructs,         // tensor_struct_bytes
+  kMicroAllocationQuantization,          // quantization_bytes
+  kMicroAllocationNodeAndRegistrations,  // node_and_registration_bytes
+  kMicroAllocationBuiltinData,           // builtin_data_bytes
+  kMicroAllocationPersistentBuffers,     // persistent_buffer_bytes
+  kMicroAllocationScratchHandles,        // scratch_handle_bytes
+  kMicroAllocationVariables,             // variable_bytes
+  kMicroAllocationBatchDims,             // batch_dims_bytes
+  kMicroAllocationRecording,             // recording_bytes
+  kMicroAllocationPlannedBuffers,        // planned_bytes
+  kMicroAllocationCategoryCount,
+} MicroAllocationCategory;
+
+// Allocations of one category, see MicroAllocator::allocation_stats().
+typedef struct {
+  size_t requested_bytes;  // Sum of the sizes asked for.
+  size_t used_bytes;       // Including the alignment padding, as in
+                           // MicroArenaUsage.
+  size_t count;            // Number of allocations.
+} MicroAllocationStats;
+
+// The arena used on behalf of one node, recorded after
+// MicroAllocator::EnableRecording().
+typedef struct {
+  MicroAllocationStats builtin_data;
+  // From the kernel's init and prepare functions.
+  MicroAllocationStats persistent_buffers;
+  // Requested in prepare, planned in the head of the arena.
+  MicroAllocationStats scratch_buffers;
+} MicroNodeAllocations;
+
+struct MicroSnapshotState;
+
 // Allocator responsible for allocating memory for all intermediate tensors
 // necessary to invoke a model.
 
@@ -70,6 +171,11 @@ typedef struct {
 //                                               - ->GetDataSize()
 // persistent area (tail)
 // ************** .memory_allocator->GetBuffer() + ->GetMaxBufferSize()
+//
+// The output of RESHAPE and of unary elementwise operators such as RELU,
+// LOGISTIC or NEG shares the memory of their first input when that input is
+// planned in the head, isn't used by any later node and has the same size.
+// Such a chain of operators then runs in place in a single buffer.
 class MicroAllocator {
  public:
   // The lifetime of the model, tensor allocator and error reporter must be at
@@ -93,6 +199,37 @@ class MicroAllocator {
   // `FinishTensorAllocation`. Otherwise, it will return 0.
   size_t used_bytes() const;
 
+  // Returns the arena usage split by purpose. It's complete after
+  // `FinishTensorAllocation`.
+  const MicroArenaUsage& arena_usage() const { return arena_usage_; }
+
+  // Returns the smallest arena size (for a 16 bytes aligned arena) that fits
+  // both the final layout and the temporary memory used during planning.
+  // Only meaningful after `FinishTensorAllocation`.
+  size_t RequiredArenaBytes() const;
+
+  // Returns the allocations of `category` made so far, so the numbers are
+  // also available after an allocation failed.
+  const MicroAllocationStats& allocation_stats(
+      MicroAllocationCategory category) const {
+    return allocation_stats_[category];
+  }
+
+  // Records the builtin data, persistent buffers and scratch buffers of every
+  // node, at the cost of one MicroNodeAllocations per node in the tail of
+  // the arena. This method needs to be called before
+  // AllocateNodeAndRegistrations method.
+  TfLiteStatus EnableRecording();
+
+  // Returns what was recorded for node `node_index`, or nullptr when
+  // recording isn't enabled.
+  const MicroNodeAllocations* node_allocations(int node_index) const;
+
+  // Prints allocation_stats() for every category and, when recording, the
+  // allocations of every node through the ErrorReporter. Can be called after
+  // a failed allocation to see what fills the arena.
+  void PrintAllocations() const;
+
   // Run through the model to allocate nodes and registrations. We need to keep
   // them for the entire life time of the model to allow persistent tensors.
   // This method needs to be called before FinishTensorAllocation method.
@@ -102,23 +239,104 @@ class MicroAllocator {
 
   // Allocates persistent buffer which has the same life time as the allocator.
   // The memory is immediately available and is allocated from the tail of the
-  // arena.
-  TfLiteStatus AllocatePersistentBuffer(size_t bytes, void** ptr);
+  // arena. When recording, it's attributed to node `node_id` unless it's -1.
+  TfLiteStatus AllocatePersistentBuffer(size_t bytes, void** ptr,
+                                        int node_id = -1);
 
   // Register a scratch buffer of size `bytes` for Node with `node_id`.
   // This method only allocates a BufferHandle holding information for memory
   // planning. The buffer ptr is ready after `FinishTensorAllocation` and can
   // be retrieved by `GetScratchBuffer` method using the returned buffer_idx.
-  // Note that there should be no tail allocation between two consecutive
-  // `RequestScratchBufferInArena` calls.
+  // The handles grow in place in temporary memory above the head, so tail
+  // allocations between two requests don't move them. FinishTensorAllocation
+  // copies them to the tail once, before the temporary memory is released.
   TfLiteStatus RequestScratchBufferInArena(int node_id, size_t bytes,
                                            int* buffer_idx);
   // Returns the pointer to the planned scratch buffer.
   void* GetScratchBuffer(int buffer_idx) const;
 
+  // Makes the memory plan reserve `max_batch_size` rows along the first
+  // dimension of every tensor placed in the head of the arena, which must be
+  // 1 in the model. The dims of those tensors, and of the ones bound to
+  // caller owned buffers (kTfLiteCustom), are copied to the tail, so the
+  // batch size can be changed between invocations. This method needs to be
+  // called before FinishTensorAllocation method.
+  TfLiteStatus ReserveBatchDimension(int max_batch_size);
+
+  // Lays out the head of the arena with `planner` instead of the plan stored
+  // in the model (see kPrecomputedMemoryPlanMetadata) or, if there is
+  // none, an IntervalMemoryPlanner working in the free part of the arena. The
+  // planner must be empty and only needs to live until
+  // FinishTensorAllocation returns. This method needs to be called before
+  // FinishTensorAllocation method.
+  void SetMemoryPlanner(MemoryPlanner* planner);
+
+  // Makes FinishTensorAllocation pass every planned buffer of the committed
+  // plan to `writer`, with the tensor or scratch buffer it holds and its
+  // region and offset. Tensors sharing the memory of their input aren't
+  // planned and aren't written. The writer only needs to live until
+  // FinishTensorAllocation returns. This method needs to be called before
+  // FinishTensorAllocation method.
+  void SetMemoryPlanWriter(MemoryPlanWriter* writer);
+
+  // Lets the memory plan place tensors and scratch buffers in `size` bytes at
+  // `buffer` besides the head of the arena, e.g. DTCM or external SDRAM.
+  // `speed` ranks the region against the others and the arena, which has
+  // speed 0; higher is faster. The buffers that are accessed most per byte
+  // go to the fastest memory and the largest ones spill to the slower
+  // regions, see MultiRegionMemoryPlanner. The persistent tail stays in the
+  // arena. Regions can't be combined with SetMemoryPlanner() and an offline
+  // plan stored in the model is ignored. The buffer must outlive the
+  // allocator. This method needs to be called before FinishTensorAllocation
+  // method.
+  TfLiteStatus AddMemoryRegion(uint8_t* buffer, size_t size, int speed);
+
+  int memory_region_count() const { return memory_region_count_; }
+  // The regions in the order they were added, with their usage after
+  // `FinishTensorAllocation`.
+  const MicroMemoryRegion& memory_region(int index) const {
+    return memory_regions_[index];
+  }
+
+  // The persistent part of the arena after `FinishTensorAllocation`, from the
+  // tail to the end of the arena: the allocator itself, the tensors, the
+  // nodes and everything the kernels allocated.
+  const uint8_t* tail() const { return memory_allocator_->GetTail(); }
+  size_t tail_bytes() const { return memory_allocator_->GetTailUsedBytes(); }
+
+  // Copies the members that describe the finished allocation to `state`, see
+  // MicroInterpreter::SaveSnapshot(). Only valid after
+  // `FinishTensorAllocation`.
+  void SaveState(MicroSnapshotState* state) const;
+
+  // Replaces the tail of the arena with the `saved_tail_bytes` bytes at
+  // `saved_tail` and the members with `state`, as if
+  // `FinishTensorAllocation` had run, instead of allocating again. The
+  // snapshot must come from the same model at the same address, the same
+  // arena and the same memory regions, and its nodes must use the
+  // registrations of `op_resolver`. Otherwise nothing is changed and an error
+  // is returned. This method needs to be called instead of
+  // AllocateNodeAndRegistrations method.
+  TfLiteStatus RestoreState(const OpResolver& op_resolver,
+                            const MicroSnapshotState& state,
+                            const uint8_t* saved_tail,
+                            size_t saved_tail_bytes);
+
  private:
   TfLiteStatus Init();
 
+  // The tail allocator's counters at some point, see RecordTailAllocations.
+  struct TailCounters {
+    size_t used_bytes;
+    size_t requested_bytes;
+    size_t count;
+  };
+  TailCounters GetTailCounters() const;
+  // Attributes the tail allocations made since `since` to `category`, and
+  // when recording to node `node_index` unless it's -1.
+  void RecordTailAllocations(MicroAllocationCategory category,
+                             const TailCounters& since, int node_index = -1);
+
   const Model* model_;
   // A simple memory allocator that always allocate from the arena tail.
   SimpleMemoryAllocator* memory_allocator_;
@@ -127,14 +345,36 @@ class MicroAllocator {
   // Indicating if the allocator is ready for allocation.
   bool active_ = false;
 
-  // In reverse order for efficiency.
-  // i.e. scratch_buffer_handles_[0] is the handle for the last buffer,
-  // corresponding to the last RequestScratchBufferInArena call.
+  // scratch_buffer_handles_[i] is the handle of the buffer with index i. They
+  // are in temporary memory until FinishTensorAllocation moves them to the
+  // tail.
   internal::ScratchBufferHandle* scratch_buffer_handles_ = nullptr;
   // How many scratch buffers have been allocated.
   size_t scratch_buffer_count_ = 0;
 
   const SubGraph* subgraph_;
+
+  // Set by AllocateNodeAndRegistrations. The memory plan follows the inputs
+  // and outputs of these nodes.
+  NodeAndRegistration* node_and_registrations_ = nullptr;
+
+  // Rows reserved for every planned tensor, see ReserveBatchDimension.
+  int max_batch_size_ = 1;
+
+  // Set by SetMemoryPlanner, nullptr for the IntervalMemoryPlanner.
+  MemoryPlanner* memory_planner_ = nullptr;
+
+  // Set by SetMemoryPlanWriter.
+  MemoryPlanWriter* memory_plan_writer_ = nullptr;
+
+  // Set by AddMemoryRegion.
+  MicroMemoryRegion memory_regions_[kMaxMemoryRegions] = {};
+  int memory_region_count_ = 0;
+
+  MicroArenaUsage arena_usage_ = {};
+  MicroAllocationStats allocation_stats_[kMicroAllocationCategoryCount] = {};
+  // Set by EnableRecording, one per operator.
+  MicroNodeAllocations* node_allocations_ = nullptr;
 };
 
 }  // namespace tflite
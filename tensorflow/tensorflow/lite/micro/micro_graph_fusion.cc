@@ -0,0 +1,483 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_graph_fusion.h"
+
+#include <limits>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+
+namespace tflite {
+namespace {
+
+// Registration of the nodes merged into another one. It has no functions, so
+// the interpreter has nothing to initialize, prepare or invoke for them.
+const TfLiteRegistration kFusedRegistration = {
+    /*init=*/nullptr,
+    /*free=*/nullptr,
+    /*prepare=*/nullptr,
+    /*invoke=*/nullptr,
+    /*profiling_string=*/nullptr,
+    /*builtin_code=*/BuiltinOperator_CUSTOM,
+    /*custom_name=*/"FUSED",
+    /*version=*/0};
+
+// Inputs and outputs of fused nodes. Laid out like a flatbuffer vector, the
+// same way the allocator uses the op inputs and outputs as TfLiteIntArray.
+const int32_t kEmptyIntArray[] = {0};
+
+TfLiteIntArray* EmptyIntArray() {
+  return const_cast<TfLiteIntArray*>(
+      reinterpret_cast<const TfLiteIntArray*>(kEmptyIntArray));
+}
+
+void MarkFused(NodeAndRegistration* node_and_registration) {
+  node_and_registration->node.inputs = EmptyIntArray();
+  node_and_registration->node.outputs = EmptyIntArray();
+  node_and_registration->registration = &kFusedRegistration;
+}
+
+TfLiteStatus AllocateIntArray(TfLiteContext* context, int size,
+                              TfLiteIntArray** array) {
+  void* buffer = nullptr;
+  TF_LITE_ENSURE_STATUS(context->AllocatePersistentBuffer(
+      context, TfLiteIntArrayGetSizeInBytes(size), &buffer));
+  *array = reinterpret_cast<TfLiteIntArray*>(buffer);
+  (*array)->size = size;
+  return kTfLiteOk;
+}
+
+// Returns the index of the only node reading `tensor_index`, or -1 if the
+// tensor has several readers or none, or is an output of the model.
+int SoleConsumer(const SubGraph* subgraph,
+                 const NodeAndRegistration* node_and_registrations,
+                 int node_count, int tensor_index) {
+  if (internal::IsGraphOutput(subgraph, tensor_index)) {
+    return -1;
+  }
+  int consumer = -1;
+  for (int i = 0; i < node_count; ++i) {
+    const TfLiteIntArray* inputs = node_and_registrations[i].node.inputs;
+    for (int n = 0; n < inputs->size; ++n) {
+      if (inputs->data[n] != tensor_index) {
+        continue;
+      }
+      if (consumer != -1) {
+        return -1;
+      }
+      consumer = i;
+    }
+  }
+  return consumer;
+}
+
+bool HasSingleOutput(const TfLiteNode& node) {
+  return node.outputs->size == 1;
+}
+
+bool HasSingleInputAndOutput(const TfLiteNode& node) {
+  return node.inputs->size == 1 && node.outputs->size == 1;
+}
+
+// True when `b` can hold the result of `a` without any conversion.
+bool HaveSameLayout(const TfLiteTensor& a, const TfLiteTensor& b) {
+  if (a.type != b.type || !TfLiteIntArrayEqual(a.dims, b.dims)) {
+    return false;
+  }
+  if (a.type == kTfLiteFloat32) {
+    return true;
+  }
+  return a.params.scale == b.params.scale &&
+         a.params.zero_point == b.params.zero_point;
+}
+
+// The standalone activations the fused activations can express.
+bool ActivationOfOperator(int32_t builtin_code,
+                          TfLiteFusedActivation* activation) {
+  switch (builtin_code) {
+    case BuiltinOperator_RELU:
+      *activation = kTfLiteActRelu;
+      return true;
+    case BuiltinOperator_RELU6:
+      *activation = kTfLiteActRelu6;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the fused activation in the builtin params of a node whose kernel
+// applies it for every supported type, or nullptr.
+TfLiteFusedActivation* FusedActivation(TfLiteContext* context,
+                                       const NodeAndRegistration& producer) {
+  void* params = producer.node.builtin_data;
+  if (params == nullptr) {
+    return nullptr;
+  }
+  switch (producer.registration->builtin_code) {
+    case BuiltinOperator_FULLY_CONNECTED:
+      return &static_cast<TfLiteFullyConnectedParams*>(params)->activation;
+    case BuiltinOperator_CONV_2D:
+      return &static_cast<TfLiteConvParams*>(params)->activation;
+    case BuiltinOperator_DEPTHWISE_CONV_2D: {
+      // The int8 kernel ignores the fused activation.
+      const int output_index = producer.node.outputs->data[0];
+      if (context->tensors[output_index].type == kTfLiteInt8) {
+        return nullptr;
+      }
+      return &static_cast<TfLiteDepthwiseConvParams*>(params)->activation;
+    }
+    case BuiltinOperator_ADD:
+      return &static_cast<TfLiteAddParams*>(params)->activation;
+    case BuiltinOperator_SUB:
+      return &static_cast<TfLiteSubParams*>(params)->activation;
+    case BuiltinOperator_MUL:
+      return &static_cast<TfLiteMulParams*>(params)->activation;
+    case BuiltinOperator_AVERAGE_POOL_2D:
+    case BuiltinOperator_MAX_POOL_2D:
+      return &static_cast<TfLitePoolParams*>(params)->activation;
+    default:
+      return nullptr;
+  }
+}
+
+// Clamping activations, as the interval they clamp to.
+bool ActivationRange(TfLiteFusedActivation activation, float* min,
+                     float* max) {
+  const float infinity = std::numeric_limits<float>::infinity();
+  switch (activation) {
+    case kTfLiteActNone:
+      *min = -infinity;
+      *max = infinity;
+      return true;
+    case kTfLiteActRelu:
+      *min = 0.0f;
+      *max = infinity;
+      return true;
+    case kTfLiteActRelu1:
+      *min = -1.0f;
+      *max = 1.0f;
+      return true;
+    case kTfLiteActRelu6:
+      *min = 0.0f;
+      *max = 6.0f;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Finds the activation equal to applying `first` and then `second`. Clamping
+// to two overlapping intervals is the same as clamping to their
+// intersection, which has to be one of the fused activations again.
+bool ComposeActivations(TfLiteFusedActivation first,
+                        TfLiteFusedActivation second,
+                        TfLiteFusedActivation* result) {
+  float first_min, first_max, second_min, second_max;
+  if (!ActivationRange(first, &first_min, &first_max) ||
+      !ActivationRange(second, &second_min, &second_max)) {
+    return false;
+  }
+  const float min = first_min > second_min ? first_min : second_min;
+  const float max = first_max < second_max ? first_max : second_max;
+  if (min > max) {
+    return false;
+  }
+  const TfLiteFusedActivation candidates[] = {kTfLiteActNone, kTfLiteActRelu,
+                                              kTfLiteActRelu1,
+                                              kTfLiteActRelu6};
+  for (TfLiteFusedActivation candidate : candidates) {
+    float candidate_min, candidate_max;
+    if (ActivationRange(candidate, &candidate_min, &candidate_max) &&
+        candidate_min == min && candidate_max == max) {
+      *result = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Folds the standalone activation `consumer` into `producer`.
+bool FuseActivation(TfLiteContext* context, NodeAndRegistration* producer,
+                    NodeAndRegistration* consumer) {
+  TfLiteFusedActivation consumer_activation;
+  if (!ActivationOfOperator(consumer->registration->builtin_code,
+                            &consumer_activation) ||
+      !HasSingleInputAndOutput(consumer->node)) {
+    return false;
+  }
+  const TfLiteTensor& intermediate =
+      context->tensors[producer->node.outputs->data[0]];
+  const TfLiteTensor& output =
+      context->tensors[consumer->node.outputs->data[0]];
+  if (!HaveSameLayout(intermediate, output)) {
+    return false;
+  }
+
+  TfLiteFusedActivation composed;
+  if (TfLiteFusedActivation* activation = FusedActivation(context, *producer)) {
+    if (!ComposeActivations(*activation, consumer_activation, &composed)) {
+      return false;
+    }
+    *activation = composed;
+    producer->node.outputs = consumer->node.outputs;
+    MarkFused(consumer);
+    return true;
+  }
+
+  // Two standalone activations, the one matching the composition is kept.
+  TfLiteFusedActivation producer_activation;
+  if (!ActivationOfOperator(producer->registration->builtin_code,
+                            &producer_activation) ||
+      !HasSingleInputAndOutput(producer->node) ||
+      !ComposeActivations(producer_activation, consumer_activation,
+                          &composed)) {
+    return false;
+  }
+  if (composed == producer_activation) {
+    producer->node.outputs = consumer->node.outputs;
+    MarkFused(consumer);
+    return true;
+  }
+  if (composed == consumer_activation) {
+    consumer->node.inputs = producer->node.inputs;
+    MarkFused(producer);
+    return true;
+  }
+  return false;
+}
+
+// Turns FULLY_CONNECTED without bias followed by an ADD of a constant vector
+// into a FULLY_CONNECTED with that vector as its bias.
+TfLiteStatus FuseBiasAdd(TfLiteContext* context, NodeAndRegistration* producer,
+                         NodeAndRegistration* consumer, bool* fused) {
+  constexpr int kBiasTensor = 2;
+  *fused = false;
+  TfLiteNode* fully_connected = &producer->node;
+  TfLiteNode* add = &consumer->node;
+  if (producer->registration->builtin_code !=
+          BuiltinOperator_FULLY_CONNECTED ||
+      consumer->registration->builtin_code != BuiltinOperator_ADD ||
+      fully_connected->inputs->size < 2 || add->inputs->size != 2 ||
+      !HasSingleOutput(*add)) {
+    return kTfLiteOk;
+  }
+  const bool has_bias = fully_connected->inputs->size > kBiasTensor &&
+                        fully_connected->inputs->data[kBiasTensor] !=
+                            kTfLiteOptionalTensor;
+  auto* fully_connected_params =
+      static_cast<TfLiteFullyConnectedParams*>(fully_connected->builtin_data);
+  auto* add_params = static_cast<TfLiteAddParams*>(add->builtin_data);
+  // The quantized kernels would need the bias requantized to int32.
+  if (has_bias || fully_connected_params == nullptr || add_params == nullptr ||
+      fully_connected_params->activation != kTfLiteActNone) {
+    return kTfLiteOk;
+  }
+
+  const int intermediate_index = fully_connected->outputs->data[0];
+  const int constant_index = add->inputs->data[0] == intermediate_index
+                                 ? add->inputs->data[1]
+                                 : add->inputs->data[0];
+  const TfLiteTensor& intermediate = context->tensors[intermediate_index];
+  const TfLiteTensor& constant = context->tensors[constant_index];
+  const TfLiteTensor& output = context->tensors[add->outputs->data[0]];
+  if (constant_index == intermediate_index || constant_index < 0 ||
+      intermediate.type != kTfLiteFloat32 ||
+      !HaveSameLayout(intermediate, output) ||
+      constant.type != kTfLiteFloat32 ||
+      constant.allocation_type != kTfLiteMmapRo) {
+    return kTfLiteOk;
+  }
+  // The constant must broadcast along the last dimension only, like a bias.
+  const TfLiteIntArray* dims = intermediate.dims;
+  if (dims->size == 0 || constant.dims->size > dims->size ||
+      ElementCount(*constant.dims) != dims->data[dims->size - 1]) {
+    return kTfLiteOk;
+  }
+  for (int i = 0; i + 1 < constant.dims->size; ++i) {
+    if (constant.dims->data[i] != 1) {
+      return kTfLiteOk;
+    }
+  }
+
+  TfLiteIntArray* inputs = nullptr;
+  TF_LITE_ENSURE_STATUS(AllocateIntArray(context, 3, &inputs));
+  inputs->data[0] = fully_connected->inputs->data[0];
+  inputs->data[1] = fully_connected->inputs->data[1];
+  inputs->data[kBiasTensor] = constant_index;
+  fully_connected->inputs = inputs;
+  fully_connected->outputs = add->outputs;
+  fully_connected_params->activation = add_params->activation;
+  MarkFused(consumer);
+  *fused = true;
+  return kTfLiteOk;
+}
+
+// Operators that give the same result on quantized data as on the
+// dequantized values, when input and output share the same parameters.
+bool CommutesWithQuantization(int32_t builtin_code) {
+  switch (builtin_code) {
+    case BuiltinOperator_RESHAPE:
+    case BuiltinOperator_RELU:
+    case BuiltinOperator_RELU6:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Removes DEQUANTIZE followed by QUANTIZE back to the same type and
+// parameters, with an optional operator in between that can run on the
+// quantized data directly.
+TfLiteStatus FuseRequantization(
+    TfLiteContext* context, const SubGraph* subgraph,
+    NodeAndRegistration* node_and_registrations, int node_count,
+    NodeAndRegistration* dequantize, NodeAndRegistration* consumer,
+    int* fused_count) {
+  *fused_count = 0;
+  if (dequantize->registration->builtin_code != BuiltinOperator_DEQUANTIZE ||
+      !HasSingleInputAndOutput(dequantize->node)) {
+    return kTfLiteOk;
+  }
+  NodeAndRegistration* middle = nullptr;
+  NodeAndRegistration* quantize = consumer;
+  if (CommutesWithQuantization(consumer->registration->builtin_code)) {
+    // Only the data input of RESHAPE may be the dequantized tensor.
+    if (!HasSingleOutput(consumer->node) ||
+        consumer->node.inputs->data[0] != dequantize->node.outputs->data[0]) {
+      return kTfLiteOk;
+    }
+    const int next = SoleConsumer(subgraph, node_and_registrations, node_count,
+                                  consumer->node.outputs->data[0]);
+    if (next < 0) {
+      return kTfLiteOk;
+    }
+    middle = consumer;
+    quantize = &node_and_registrations[next];
+  }
+  if (quantize->registration->builtin_code != BuiltinOperator_QUANTIZE ||
+      !HasSingleInputAndOutput(quantize->node)) {
+    return kTfLiteOk;
+  }
+
+  const int input_index = dequantize->node.inputs->data[0];
+  const int output_index = quantize->node.outputs->data[0];
+  const TfLiteTensor& input = context->tensors[input_index];
+  const TfLiteTensor& output = context->tensors[output_index];
+  const TfLiteTensor& dequantized =
+      context->tensors[dequantize->node.outputs->data[0]];
+  if ((input.type != kTfLiteInt8 && input.type != kTfLiteUInt8) ||
+      dequantized.type != kTfLiteFloat32 || input.type != output.type ||
+      input.params.scale != output.params.scale ||
+      input.params.zero_point != output.params.zero_point) {
+    return kTfLiteOk;
+  }
+
+  if (middle != nullptr) {
+    // The operator in between now reads and writes the quantized tensors.
+    TfLiteIntArray* inputs = nullptr;
+    TF_LITE_ENSURE_STATUS(
+        AllocateIntArray(context, middle->node.inputs->size, &inputs));
+    for (int n = 0; n < inputs->size; ++n) {
+      inputs->data[n] = middle->node.inputs->data[n];
+    }
+    inputs->data[0] = input_index;
+    middle->node.inputs = inputs;
+    middle->node.outputs = quantize->node.outputs;
+  } else {
+    // The readers of the requantized tensor read the original one instead.
+    if (internal::IsGraphOutput(subgraph, output_index)) {
+      return kTfLiteOk;
+    }
+    for (int i = 0; i < node_count; ++i) {
+      TfLiteNode* node = &node_and_registrations[i].node;
+      bool reads_output = false;
+      for (int n = 0; n < node->inputs->size; ++n) {
+        reads_output |= node->inputs->data[n] == output_index;
+      }
+      if (!reads_output) {
+        continue;
+      }
+      TfLiteIntArray* inputs = nullptr;
+      TF_LITE_ENSURE_STATUS(
+          AllocateIntArray(context, node->inputs->size, &inputs));
+      for (int n = 0; n < inputs->size; ++n) {
+        inputs->data[n] = node->inputs->data[n] == output_index
+                              ? input_index
+                              : node->inputs->data[n];
+      }
+      node->inputs = inputs;
+    }
+  }
+  MarkFused(dequantize);
+  MarkFused(quantize);
+  *fused_count = 2;
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TfLiteStatus FuseGraph(TfLiteContext* context, const SubGraph* subgraph,
+                       NodeAndRegistration* node_and_registrations,
+                       ErrorReporter* error_reporter, int* fused_node_count) {
+  *fused_node_count = 0;
+  if (context->AllocatePersistentBuffer == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "FuseGraph() needs AllocatePersistentBuffer");
+    return kTfLiteError;
+  }
+  const int node_count = subgraph->operators()->size();
+  for (int i = 0; i < node_count; ++i) {
+    NodeAndRegistration* producer = &node_and_registrations[i];
+    // A node may absorb several consumers in a row, e.g. FULLY_CONNECTED,
+    // ADD and RELU.
+    bool fused = true;
+    while (fused && !IsFusedNode(*producer) &&
+           HasSingleOutput(producer->node)) {
+      fused = false;
+      const int consumer_index =
+          SoleConsumer(subgraph, node_and_registrations, node_count,
+                       producer->node.outputs->data[0]);
+      if (consumer_index < 0) {
+        break;
+      }
+      NodeAndRegistration* consumer = &node_and_registrations[consumer_index];
+
+      if (FuseActivation(context, producer, consumer)) {
+        fused = true;
+        *fused_node_count += 1;
+        continue;
+      }
+      TF_LITE_ENSURE_STATUS(FuseBiasAdd(context, producer, consumer, &fused));
+      if (fused) {
+        *fused_node_count += 1;
+        continue;
+      }
+      int requantization_count = 0;
+      TF_LITE_ENSURE_STATUS(FuseRequantization(
+          context, subgraph, node_and_registrations, node_count, producer,
+          consumer, &requantization_count));
+      *fused_node_count += requantization_count;
+    }
+  }
+  return kTfLiteOk;
+}
+
+bool IsFusedNode(const NodeAndRegistration& node_and_registration) {
+  return node_and_registration.registration == &kFusedRegistration;
+}
+
+}  // namespace tflite
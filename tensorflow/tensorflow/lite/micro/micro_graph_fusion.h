@@ -0,0 +1,59 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_GRAPH_FUSION_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_GRAPH_FUSION_H_
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Rewrites the runtime nodes of `subgraph` so that chains of operators run as
+// a single kernel invocation, and the tensors between them need no arena
+// memory. Only the TfLiteNode inputs, outputs and builtin params are changed,
+// the flatbuffer is left untouched. Supported patterns:
+//
+// * FULLY_CONNECTED, CONV_2D, DEPTHWISE_CONV_2D, ADD, SUB, MUL,
+//   AVERAGE_POOL_2D or MAX_POOL_2D followed by RELU or RELU6: the activation
+//   becomes the fused activation of the first operator.
+// * Float FULLY_CONNECTED without bias followed by an ADD of a constant
+//   vector: the constant becomes the bias.
+// * Consecutive RELU and RELU6 operators: only the stricter one is kept.
+// * DEQUANTIZE followed by QUANTIZE with the same parameters: both are
+//   removed, optionally with a RESHAPE, RELU or RELU6 in between, which then
+//   runs on the quantized data.
+//
+// Every rewrite gives bit-exact results. An intermediate tensor is only
+// removed when the second operator is its sole reader and it's not an output
+// of the model. Quantized activations are only fused when the quantization
+// parameters on both sides are the same.
+//
+// Must be called after MicroAllocator::AllocateNodeAndRegistrations() and
+// before the kernels are initialized. Memory for rewritten node inputs comes
+// from context->AllocatePersistentBuffer(). `fused_node_count` returns how
+// many nodes were removed.
+TfLiteStatus FuseGraph(TfLiteContext* context, const SubGraph* subgraph,
+                       NodeAndRegistration* node_and_registrations,
+                       ErrorReporter* error_reporter, int* fused_node_count);
+
+// Returns true for a node that FuseGraph() merged into another one. Such a
+// node has no inputs, outputs or kernel functions and is skipped.
+bool IsFusedNode(const NodeAndRegistration& node_and_registration);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_GRAPH_FUSION_H_
@@ -14,11 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/micro/micro_interpreter.h"
 
+#include <cstring>
+
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/flatbuffer_conversions.h"
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/micro/compatibility.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_graph_fusion.h"
 #include "tensorflow/lite/micro/micro_optional_debug_tools.h"
 
 namespace tflite {
@@ -32,14 +35,46 @@ const char* OpNameFromRegistration(const TfLiteRegistration* registration) {
   }
 }
 
+// Operators that compute every row of their input independently, using only
+// state computed in Prepare that doesn't depend on the number of rows.
+bool SupportsBatching(int32_t builtin_code) {
+  switch (builtin_code) {
+    case BuiltinOperator_FULLY_CONNECTED:
+    case BuiltinOperator_RELU:
+    case BuiltinOperator_RELU6:
+    case BuiltinOperator_LOGISTIC:
+    case BuiltinOperator_QUANTIZE:
+    case BuiltinOperator_DEQUANTIZE:
+    case BuiltinOperator_ABS:
+    case BuiltinOperator_SIN:
+    case BuiltinOperator_COS:
+    case BuiltinOperator_LOG:
+    case BuiltinOperator_SQRT:
+    case BuiltinOperator_RSQRT:
+    case BuiltinOperator_SQUARE:
+    case BuiltinOperator_NEG:
+    case BuiltinOperator_FLOOR:
+    case BuiltinOperator_CEIL:
+    case BuiltinOperator_ROUND:
+      return true;
+    default:
+      return false;
+  }
+}
+
 }  // namespace
 
 namespace internal {
 
 TfLiteStatus ContextHelper::AllocatePersistentBuffer(TfLiteContext* ctx,
                                                      size_t bytes, void** ptr) {
-  return reinterpret_cast<ContextHelper*>(ctx->impl_)
-      ->allocator_->AllocatePersistentBuffer(bytes, ptr);
+  ContextHelper* helper = reinterpret_cast<ContextHelper*>(ctx->impl_);
+  TfLiteStatus status = helper->allocator_->AllocatePersistentBuffer(
+      bytes, ptr, helper->current_node_idx_);
+  if (status != kTfLiteOk) {
+    helper->persistent_allocation_failed_ = true;
+  }
+  return status;
 }
 
 TfLiteStatus ContextHelper::RequestScratchBufferInArena(TfLiteContext* ctx,
@@ -70,14 +105,16 @@ MicroInterpreter::MicroInterpreter(const Model* model,
                                    const OpResolver& op_resolver,
                                    uint8_t* tensor_arena,
                                    size_t tensor_arena_size,
-                                   ErrorReporter* error_reporter)
+                                   ErrorReporter* error_reporter,
+                                   MicroProfiler* profiler)
     : model_(model),
       op_resolver_(op_resolver),
       error_reporter_(error_reporter),
       allocator_(&context_, model_, tensor_arena, tensor_arena_size,
                  error_reporter_),
       tensors_allocated_(false),
-      context_helper_(error_reporter_, &allocator_) {
+      context_helper_(error_reporter_, &allocator_),
+      profiler_(profiler) {
   const flatbuffers::Vector<flatbuffers::Offset<SubGraph>>* subgraphs =
       model->subgraphs();
   if (subgraphs->size() != 1) {
@@ -109,6 +146,10 @@ MicroInterpreter::MicroInterpreter(const Model* model,
 }
 
 MicroInterpreter::~MicroInterpreter() {
+  // A prefetch for the next invocation may still be writing to the arena.
+  if (weight_copier_ != nullptr) {
+    weight_streamer_.Wait();
+  }
   if (node_and_registrations_ != nullptr) {
     for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
       TfLiteNode* node = &(node_and_registrations_[i].node);
@@ -169,6 +210,14 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
   context_.RequestScratchBufferInArena = nullptr;
   context_.GetScratchBuffer = nullptr;
 
+  // The graph is rewritten before any kernel sees its nodes.
+  if (graph_fusion_enabled_) {
+    int fused_node_count = 0;
+    TF_LITE_ENSURE_OK(&context_,
+                      FuseGraph(&context_, subgraph_, node_and_registrations_,
+                                error_reporter_, &fused_node_count));
+  }
+
   for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
     context_helper_.SetNodeIndex(i);
     auto* node = &(node_and_registrations_[i].node);
@@ -188,6 +237,11 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
     }
   }
   context_helper_.SetNodeIndex(-1);
+  if (context_helper_.persistent_allocation_failed()) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate persistent buffers during init.");
+    return kTfLiteError;
+  }
 
   // Both AllocatePersistentBuffer and RequestScratchBufferInArena is available
   // in Prepare stage.
@@ -211,6 +265,30 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
   }
   context_helper_.SetNodeIndex(-1);
 
+  if (max_batch_size_ > 1) {
+    for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
+      const TfLiteRegistration* registration =
+          node_and_registrations_[i].registration;
+      if (!IsFusedNode(node_and_registrations_[i]) &&
+          !SupportsBatching(registration->builtin_code)) {
+        TF_LITE_REPORT_ERROR(error_reporter_,
+                             "Node %s (number %d) doesn't support batching",
+                             OpNameFromRegistration(registration), i);
+        return kTfLiteError;
+      }
+    }
+    TF_LITE_ENSURE_OK(&context_,
+                      allocator_.ReserveBatchDimension(max_batch_size_));
+  }
+
+  if (weight_copier_ != nullptr) {
+    TF_LITE_ENSURE_OK(
+        &context_,
+        weight_streamer_.Init(error_reporter_, &allocator_, &context_,
+                              node_and_registrations_,
+                              subgraph_->operators()->size(), weight_copier_));
+  }
+
   // Prepare is done, we're ready for Invoke. Memory allocation is no longer
   // allowed. Kernels can only fetch scratch buffers via GetScratchBuffer.
   context_.AllocatePersistentBuffer = nullptr;
@@ -222,6 +300,107 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
   return kTfLiteOk;
 }
 
+TfLiteStatus MicroInterpreter::SaveSnapshot(uint32_t model_hash,
+                                            MicroSnapshotWriter* writer) {
+  if (!tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "SaveSnapshot() must be called after "
+                         "AllocateTensors()");
+    return kTfLiteError;
+  }
+  if (weight_copier_ != nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Snapshots aren't supported with weight streaming");
+    return kTfLiteError;
+  }
+  // Cleared first, since the padding is part of the checksum.
+  MicroSnapshotState state;
+  memset(&state, 0, sizeof(state));
+  allocator_.SaveState(&state);
+  state.batch_size = batch_size_;
+
+  MicroSnapshotHeader header;
+  header.magic = kMicroSnapshotMagic;
+  header.version = kMicroSnapshotVersion;
+  header.model_hash = model_hash;
+  header.state_bytes = sizeof(state);
+  header.tail_bytes = allocator_.tail_bytes();
+  header.checksum =
+      MicroSnapshotHash(allocator_.tail(), header.tail_bytes,
+                        MicroSnapshotHash(&state, sizeof(state)));
+  TF_LITE_ENSURE_STATUS(writer->Write(&header, sizeof(header)));
+  TF_LITE_ENSURE_STATUS(writer->Write(&state, sizeof(state)));
+  return writer->Write(allocator_.tail(), header.tail_bytes);
+}
+
+size_t MicroInterpreter::snapshot_bytes() const {
+  return sizeof(MicroSnapshotHeader) + sizeof(MicroSnapshotState) +
+         allocator_.tail_bytes();
+}
+
+TfLiteStatus MicroInterpreter::RestoreSnapshot(uint32_t model_hash,
+                                               const uint8_t* snapshot,
+                                               size_t snapshot_size) {
+  if (initialization_status_ != kTfLiteOk) {
+    return kTfLiteError;
+  }
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "RestoreSnapshot() must be called instead of "
+                         "AllocateTensors()");
+    return kTfLiteError;
+  }
+  if (weight_copier_ != nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Snapshots aren't supported with weight streaming");
+    return kTfLiteError;
+  }
+
+  // The snapshot may be in flash and unaligned, so it's only read with
+  // memcpy().
+  MicroSnapshotHeader header;
+  MicroSnapshotState state;
+  if (snapshot == nullptr || snapshot_size < sizeof(header)) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "No valid snapshot");
+    return kTfLiteError;
+  }
+  memcpy(&header, snapshot, sizeof(header));
+  if (header.magic != kMicroSnapshotMagic ||
+      header.version != kMicroSnapshotVersion ||
+      header.state_bytes != sizeof(state) ||
+      snapshot_size < sizeof(header) + sizeof(state) ||
+      snapshot_size - sizeof(header) - sizeof(state) < header.tail_bytes) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "No valid snapshot");
+    return kTfLiteError;
+  }
+  if (header.model_hash != model_hash) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "The snapshot was made for another model");
+    return kTfLiteError;
+  }
+  const uint8_t* state_data = snapshot + sizeof(header);
+  const uint8_t* tail = state_data + sizeof(state);
+  if (MicroSnapshotHash(tail, header.tail_bytes,
+                        MicroSnapshotHash(state_data, sizeof(state))) !=
+      header.checksum) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "The snapshot is corrupted");
+    return kTfLiteError;
+  }
+  memcpy(&state, state_data, sizeof(state));
+  TF_LITE_ENSURE_STATUS(
+      allocator_.RestoreState(op_resolver_, state, tail, header.tail_bytes));
+
+  node_and_registrations_ = state.node_and_registrations;
+  max_batch_size_ = state.max_batch_size;
+  batch_size_ = state.batch_size;
+  // Like at the end of AllocateTensors().
+  context_.AllocatePersistentBuffer = nullptr;
+  context_.RequestScratchBufferInArena = nullptr;
+  context_.GetScratchBuffer = context_helper_.GetScratchBuffer;
+  tensors_allocated_ = true;
+  return kTfLiteOk;
+}
+
 TfLiteStatus MicroInterpreter::Invoke() {
   if (initialization_status_ != kTfLiteOk) {
     TF_LITE_REPORT_ERROR(error_reporter_,
@@ -235,12 +414,29 @@ TfLiteStatus MicroInterpreter::Invoke() {
     TF_LITE_ENSURE_OK(&context_, AllocateTensors());
   }
 
+  if (profiler_ != nullptr) {
+    profiler_->BeginInvoke();
+  }
+
   for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
     auto* node = &(node_and_registrations_[i].node);
     auto* registration = node_and_registrations_[i].registration;
 
     if (registration->invoke) {
-      TfLiteStatus invoke_status = registration->invoke(&context_, node);
+      if (weight_copier_ != nullptr) {
+        TF_LITE_ENSURE_OK(&context_, weight_streamer_.PrepareNode(i));
+      }
+      TfLiteStatus invoke_status;
+      // Only a single pointer check is paid per node when no profiler is
+      // attached.
+      if (profiler_ != nullptr) {
+        const uint32_t event_handle =
+            profiler_->BeginEvent(OpNameFromRegistration(registration), i);
+        invoke_status = registration->invoke(&context_, node);
+        profiler_->EndEvent(event_handle);
+      } else {
+        invoke_status = registration->invoke(&context_, node);
+      }
       if (invoke_status == kTfLiteError) {
         TF_LITE_REPORT_ERROR(
             error_reporter_,
@@ -252,6 +448,193 @@ TfLiteStatus MicroInterpreter::Invoke() {
       }
     }
   }
+
+  if (profiler_ != nullptr) {
+    profiler_->EndInvoke();
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::SetMaxBatchSize(int max_batch_size) {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "SetMaxBatchSize() must be called before "
+                         "AllocateTensors()");
+    return kTfLiteError;
+  }
+  if (max_batch_size < 1) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Invalid max batch size %d",
+                         max_batch_size);
+    return kTfLiteError;
+  }
+  // The tensors are missing if the arena is too small to initialize the
+  // allocator, then AllocateTensors() fails anyway.
+  for (size_t i = 0; context_.tensors != nullptr && i < tensors_size(); ++i) {
+    if (context_.tensors[i].allocation_type == kTfLiteCustom) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "SetMaxBatchSize() must be called before binding "
+                           "buffers");
+      return kTfLiteError;
+    }
+  }
+  max_batch_size_ = max_batch_size;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::EnableGraphFusion() {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "EnableGraphFusion() must be called before "
+                         "AllocateTensors()");
+    return kTfLiteError;
+  }
+  graph_fusion_enabled_ = true;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::SetMemoryPlanner(MemoryPlanner* planner) {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "SetMemoryPlanner() must be called before "
+                         "AllocateTensors()");
+    return kTfLiteError;
+  }
+  allocator_.SetMemoryPlanner(planner);
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::SetMemoryPlanWriter(MemoryPlanWriter* writer) {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "SetMemoryPlanWriter() must be called before "
+                         "AllocateTensors()");
+    return kTfLiteError;
+  }
+  allocator_.SetMemoryPlanWriter(writer);
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::AddMemoryRegion(uint8_t* buffer, size_t size,
+                                              int speed) {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "AddMemoryRegion() must be called before "
+                         "AllocateTensors()");
+    return kTfLiteError;
+  }
+  return allocator_.AddMemoryRegion(buffer, size, speed);
+}
+
+TfLiteStatus MicroInterpreter::EnableWeightStreaming(
+    MicroMemoryCopier* copier) {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "EnableWeightStreaming() must be called before "
+                         "AllocateTensors()");
+    return kTfLiteError;
+  }
+  if (copier == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Weight streaming needs a copier");
+    return kTfLiteError;
+  }
+  weight_copier_ = copier;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::EnableAllocationRecording() {
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "EnableAllocationRecording() must be called before "
+                         "AllocateTensors()");
+    return kTfLiteError;
+  }
+  return allocator_.EnableRecording();
+}
+
+TfLiteStatus MicroInterpreter::InvokeBatch(int batch_size) {
+  if (initialization_status_ != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "InvokeBatch() called after initialization failed\n");
+    return kTfLiteError;
+  }
+  if (!tensors_allocated_) {
+    TF_LITE_ENSURE_OK(&context_, AllocateTensors());
+  }
+  if (batch_size < 1 || batch_size > max_batch_size_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Batch size %d out of range (max batch size is %d)",
+                         batch_size, max_batch_size_);
+    return kTfLiteError;
+  }
+  SetBatchSize(batch_size);
+  const TfLiteStatus status = Invoke();
+  // Invoke() and the tensor accessors keep seeing a single row.
+  SetBatchSize(1);
+  return status;
+}
+
+void MicroInterpreter::SetBatchSize(int batch_size) {
+  if (batch_size == batch_size_) {
+    return;
+  }
+  for (size_t i = 0; i < tensors_size(); ++i) {
+    TfLiteTensor* tensor = &context_.tensors[i];
+    // The tensors the allocator reserved rows for, see
+    // MicroAllocator::ReserveBatchDimension().
+    if ((tensor->allocation_type != kTfLiteArenaRw &&
+         tensor->allocation_type != kTfLiteCustom) ||
+        tensor->is_variable) {
+      continue;
+    }
+    tensor->bytes = tensor->bytes / batch_size_ * batch_size;
+    tensor->dims->data[0] = batch_size;
+  }
+  batch_size_ = batch_size;
+}
+
+TfLiteStatus MicroInterpreter::BindInput(size_t index, void* data,
+                                         size_t bytes) {
+  return BindTensor(input(index), data, bytes);
+}
+
+TfLiteStatus MicroInterpreter::BindOutput(size_t index, void* data,
+                                          size_t bytes) {
+  return BindTensor(output(index), data, bytes);
+}
+
+TfLiteStatus MicroInterpreter::BindTensor(TfLiteTensor* tensor, void* data,
+                                          size_t bytes) {
+  // input() and output() already reported an invalid index.
+  if (tensor == nullptr) {
+    return kTfLiteError;
+  }
+  if (data == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Can't bind a null buffer");
+    return kTfLiteError;
+  }
+  if (tensor->allocation_type == kTfLiteMmapRo || tensor->is_variable) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Constant and variable tensors can't be bound");
+    return kTfLiteError;
+  }
+  // A tensor planned in the arena may share its memory with others, and
+  // keeping the arena space would defeat the purpose anyway.
+  if (tensors_allocated_ && tensor->allocation_type != kTfLiteCustom) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Buffers must be bound before AllocateTensors()");
+    return kTfLiteError;
+  }
+  // Binding only happens between invocations, when the tensors hold a single
+  // row.
+  const size_t required_bytes = tensor->bytes * max_batch_size_;
+  if (bytes < required_bytes) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Bound buffer has %d bytes, but %d are required",
+                         bytes, required_bytes);
+    return kTfLiteError;
+  }
+  tensor->data.data = data;
+  tensor->allocation_type = kTfLiteCustom;
   return kTfLiteOk;
 }
 
@@ -20,6 +20,10 @@ limitations under the License.
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/memory_planner/memory_planner.h"
+#include "tensorflow/lite/micro/micro_profiler.h"
+#include "tensorflow/lite/micro/micro_snapshot.h"
+#include "tensorflow/lite/micro/micro_weight_streamer.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/type_to_tflitetype.h"
 
@@ -50,10 +54,17 @@ class ContextHelper {
 
   void SetNodeIndex(int idx) { current_node_idx_ = idx; }
 
+  // Kernels may not check the result of AllocatePersistentBuffer in their
+  // init function, so failures are remembered here and checked afterwards.
+  bool persistent_allocation_failed() const {
+    return persistent_allocation_failed_;
+  }
+
  private:
   MicroAllocator* allocator_;
   ErrorReporter* error_reporter_;
   int current_node_idx_ = -1;
+  bool persistent_allocation_failed_ = false;
 };
 
 }  // namespace internal
@@ -68,9 +79,11 @@ class MicroInterpreter {
   // function.
   // The interpreter doesn't do any deallocation of any of the pointed-to
   // objects, ownership remains with the caller.
+  // The profiler is optional, see set_profiler().
   MicroInterpreter(const Model* model, const OpResolver& op_resolver,
                    uint8_t* tensor_arena, size_t tensor_arena_size,
-                   ErrorReporter* error_reporter);
+                   ErrorReporter* error_reporter,
+                   MicroProfiler* profiler = nullptr);
 
   ~MicroInterpreter();
 
@@ -78,11 +91,119 @@ class MicroInterpreter {
   // intermediate tensors.
   TfLiteStatus AllocateTensors();
 
+  // Writes what AllocateTensors() prepared to `writer`: the persistent tail
+  // of the arena, with the tensors, the parsed nodes and the data the kernels
+  // allocated in init and prepare, and the pointers of the memory plan.
+  // RestoreSnapshot() then skips all of that on the next boot. `model_hash`
+  // keys the snapshot, see MicroSnapshotHash(). It should cover the firmware
+  // build as well as the model, since the snapshot holds pointers into both.
+  // Must be called after AllocateTensors() and before Invoke(), as kernels
+  // and variable tensors keep their state in the tail. Not supported with
+  // EnableWeightStreaming().
+  TfLiteStatus SaveSnapshot(uint32_t model_hash, MicroSnapshotWriter* writer);
+
+  // The size of what SaveSnapshot() writes. Only available after
+  // AllocateTensors().
+  size_t snapshot_bytes() const;
+
+  // Restores the `snapshot_size` bytes at `snapshot` written by
+  // SaveSnapshot() instead of calling AllocateTensors(), e.g. from flash. No
+  // kernel is initialized or prepared and no memory plan is made. The
+  // interpreter must be built with the same model, op resolver and arena at
+  // the same addresses, and configured with the same memory regions. Bound
+  // buffers and the max batch size are restored as they were saved. If the
+  // hash, the addresses, the registrations or the checksum don't match,
+  // nothing is changed and an error is returned, so the caller can fall back
+  // to AllocateTensors().
+  TfLiteStatus RestoreSnapshot(uint32_t model_hash, const uint8_t* snapshot,
+                               size_t snapshot_size);
+
   // In order to support partial graph runs for strided models, this can return
   // values other than kTfLiteOk and kTfLiteError.
   // TODO(b/149795762): Add this to the TfLiteStatus enum.
   TfLiteStatus Invoke();
 
+  // Sets how many independent inputs InvokeBatch() can evaluate in one call.
+  // Must be called before AllocateTensors(), which then reserves arena space
+  // for that many rows in every non-constant tensor. Only models whose
+  // non-constant tensors have a first (batch) dimension of 1 and that only use
+  // operators that treat rows independently, such as FULLY_CONNECTED,
+  // activations and elementwise ops, can be batched.
+  TfLiteStatus SetMaxBatchSize(int max_batch_size);
+  int max_batch_size() const { return max_batch_size_; }
+
+  // Runs the model once on `batch_size` inputs. The inputs are stored one
+  // after the other in the input tensors, e.g. input(0)->data.f[i] for a
+  // model with a single float input, and the outputs are returned the same
+  // way. Every node processes the whole batch before the next one runs, so
+  // per-node overhead is paid once per batch and kernels like
+  // FULLY_CONNECTED see a real batch dimension.
+  TfLiteStatus InvokeBatch(int batch_size);
+
+  // Makes AllocateTensors() merge chains of operators, such as
+  // FULLY_CONNECTED followed by RELU, into single kernel invocations before
+  // the memory plan is made, see micro_graph_fusion.h. This saves the time of
+  // the removed nodes and the arena space of the tensors between them, and
+  // gives the same results. The flatbuffer is not modified. Must be called
+  // before AllocateTensors().
+  TfLiteStatus EnableGraphFusion();
+
+  // Makes AllocateTensors() lay out the tensors and scratch buffers with
+  // `planner` instead of the default IntervalMemoryPlanner, e.g. a
+  // PrecomputedMemoryPlanner holding a plan made offline by
+  // tensorflow/lite/micro/tools/plan_memory.cc. The planner must be empty and
+  // is only used during AllocateTensors(). Must be called before
+  // AllocateTensors().
+  TfLiteStatus SetMemoryPlanner(MemoryPlanner* planner);
+
+  // Makes AllocateTensors() write the memory plan to `writer`, one record per
+  // planned buffer with its tensor, lifetime, region and offset, see
+  // MemoryPlanWriter. tensorflow/lite/micro/tools/export_memory_plan.cc does
+  // the same on the host. The writer is only used during AllocateTensors().
+  // Must be called before AllocateTensors().
+  TfLiteStatus SetMemoryPlanWriter(MemoryPlanWriter* writer);
+
+  // Lets AllocateTensors() place tensors and scratch buffers in `size` bytes
+  // at `buffer` as well as in the arena, e.g. DTCM with a positive `speed` or
+  // external SDRAM with a negative one, the arena having speed 0. Small,
+  // often used tensors go to the fastest memory and the largest activations
+  // spill to the slowest, see MicroAllocator::AddMemoryRegion(). Up to
+  // kMaxMemoryRegions can be added. The buffer must outlive the interpreter.
+  // Must be called before AllocateTensors().
+  TfLiteStatus AddMemoryRegion(uint8_t* buffer, size_t size, int speed);
+
+  // The regions added with AddMemoryRegion(), with the bytes they use after
+  // AllocateTensors().
+  int memory_region_count() const { return allocator_.memory_region_count(); }
+  const MicroMemoryRegion& memory_region(int index) const {
+    return allocator_.memory_region(index);
+  }
+
+  // Keeps the constant tensors where the model is, e.g. in QSPI flash or
+  // SDRAM, and copies the constant inputs of every node into one of two
+  // staging buffers in the arena with `copier` while the node before runs,
+  // see MicroWeightStreamer. The arena needs room for both buffers, each as
+  // large as the constant inputs of the largest node. `copier` must outlive
+  // the interpreter. Must be called before AllocateTensors().
+  TfLiteStatus EnableWeightStreaming(MicroMemoryCopier* copier);
+
+  // Records the arena used by every node, see
+  // MicroAllocator::EnableRecording(). Must be called before
+  // AllocateTensors().
+  TfLiteStatus EnableAllocationRecording();
+
+  // Makes the input or output tensor at `index` use the caller owned buffer
+  // `data` of `bytes` bytes instead of memory in the arena, so the caller can
+  // fill and read it without copies. Binding is done before
+  // AllocateTensors(), which then leaves the tensor out of the memory plan.
+  // Afterwards a bound tensor can be bound to another buffer between
+  // invocations, e.g. to swap DMA buffers, without calling AllocateTensors()
+  // again. The buffer must stay valid while it is bound, hold
+  // max_batch_size() rows (so call SetMaxBatchSize() first) and should be 16
+  // bytes aligned like the arena.
+  TfLiteStatus BindInput(size_t index, void* data, size_t bytes);
+  TfLiteStatus BindOutput(size_t index, void* data, size_t bytes);
+
   size_t tensors_size() const { return context_.tensors_size; }
   TfLiteTensor* tensor(size_t tensor_index);
   template <class T>
@@ -132,6 +253,12 @@ class MicroInterpreter {
 
   TfLiteStatus initialization_status() const { return initialization_status_; }
 
+  // Attaches a profiler that is notified around every kernel invocation, or
+  // detaches it when passed nullptr. The profiler is not owned and must
+  // outlive its use by the interpreter.
+  void set_profiler(MicroProfiler* profiler) { profiler_ = profiler; }
+  MicroProfiler* profiler() const { return profiler_; }
+
   size_t operators_size() const { return subgraph_->operators()->size(); }
 
   // For debugging only.
@@ -147,12 +274,46 @@ class MicroInterpreter {
   // arena_used_bytes() + 16.
   size_t arena_used_bytes() const { return allocator_.used_bytes(); }
 
+  // Returns the arena usage split into the planned head and the different
+  // kinds of tail allocations. It's only complete after `AllocateTensors`.
+  const MicroArenaUsage& arena_usage() const {
+    return allocator_.arena_usage();
+  }
+
+  // Returns the size and number of the allocations of `category`. Also
+  // available after `AllocateTensors` failed.
+  const MicroAllocationStats& allocation_stats(
+      MicroAllocationCategory category) const {
+    return allocator_.allocation_stats(category);
+  }
+
+  // Returns what node `node_index` allocated, or nullptr without
+  // EnableAllocationRecording().
+  const MicroNodeAllocations* node_allocations(int node_index) const {
+    return allocator_.node_allocations(node_index);
+  }
+
+  // Prints the allocations of the arena through the ErrorReporter.
+  void PrintAllocations() const { allocator_.PrintAllocations(); }
+
+  // Returns the exact arena size this model needs with a 16 bytes aligned
+  // tensor_arena, including the temporary memory used while planning. It's
+  // only available after `AllocateTensors` has been called.
+  size_t required_arena_bytes() const {
+    return allocator_.RequiredArenaBytes();
+  }
+
  private:
   void CorrectTensorEndianness(TfLiteTensor* tensorCorr);
 
   template <class T>
   void CorrectTensorDataEndianness(T* data, int32_t size);
 
+  // Updates the first dimension and the size of every batched tensor.
+  void SetBatchSize(int batch_size);
+
+  TfLiteStatus BindTensor(TfLiteTensor* tensor, void* data, size_t bytes);
+
   NodeAndRegistration* node_and_registrations_ = nullptr;
 
   const Model* model_;
@@ -166,6 +327,13 @@ class MicroInterpreter {
 
   const SubGraph* subgraph_;
   internal::ContextHelper context_helper_;
+  MicroProfiler* profiler_;
+
+  int max_batch_size_ = 1;
+  int batch_size_ = 1;
+  bool graph_fusion_enabled_ = false;
+  MicroMemoryCopier* weight_copier_ = nullptr;
+  MicroWeightStreamer weight_streamer_;
 };
 
 }  // namespace tflite
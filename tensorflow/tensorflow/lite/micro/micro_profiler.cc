@@ -0,0 +1,145 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_profiler.h"
+
+#include <cstdint>
+
+#include "tensorflow/lite/micro/micro_time.h"
+
+namespace tflite {
+namespace {
+
+// The tick counter may wrap around, so the difference is computed in unsigned
+// arithmetic, which is well defined on overflow.
+int32_t ElapsedTicks(int32_t start_ticks, int32_t end_ticks) {
+  return static_cast<int32_t>(static_cast<uint32_t>(end_ticks) -
+                              static_cast<uint32_t>(start_ticks));
+}
+
+// MicroVsnprintf() has no 64-bit conversions, so totals are clamped.
+int32_t SaturateToInt32(int64_t value) {
+  if (value > INT32_MAX) {
+    return INT32_MAX;
+  }
+  return static_cast<int32_t>(value);
+}
+
+}  // namespace
+
+MicroOpProfiler::MicroOpProfiler()
+    : event_count_(0), node_stats_count_(0), invoke_count_(0) {}
+
+void MicroOpProfiler::BeginInvoke() { event_count_ = 0; }
+
+void MicroOpProfiler::EndInvoke() {
+  for (int i = 0; i < event_count_; ++i) {
+    const Event& event = events_[i];
+    if (event.node_index < 0 || event.node_index >= kMaxEvents) {
+      continue;
+    }
+    // Grow the statistics table to cover every node seen so far.
+    while (node_stats_count_ <= event.node_index) {
+      NodeStats* stats = &node_stats_[node_stats_count_];
+      stats->tag = nullptr;
+      stats->count = 0;
+      stats->total_ticks = 0;
+      stats->min_ticks = INT32_MAX;
+      stats->max_ticks = 0;
+      ++node_stats_count_;
+    }
+    const int32_t ticks = ElapsedTicks(event.start_ticks, event.end_ticks);
+    NodeStats* stats = &node_stats_[event.node_index];
+    stats->tag = event.tag;
+    stats->count += 1;
+    stats->total_ticks += ticks;
+    if (ticks < stats->min_ticks) {
+      stats->min_ticks = ticks;
+    }
+    if (ticks > stats->max_ticks) {
+      stats->max_ticks = ticks;
+    }
+  }
+  ++invoke_count_;
+}
+
+uint32_t MicroOpProfiler::BeginEvent(const char* tag, int node_index) {
+  if (event_count_ >= kMaxEvents) {
+    // The handle is out of range, so EndEvent() will ignore it.
+    return kMaxEvents;
+  }
+  Event* event = &events_[event_count_];
+  event->tag = tag;
+  event->node_index = node_index;
+  event->start_ticks = GetCurrentTimeTicks();
+  event->end_ticks = event->start_ticks;
+  return event_count_++;
+}
+
+void MicroOpProfiler::EndEvent(uint32_t event_handle) {
+  if (event_handle >= static_cast<uint32_t>(event_count_)) {
+    return;
+  }
+  events_[event_handle].end_ticks = GetCurrentTimeTicks();
+}
+
+int32_t MicroOpProfiler::last_invoke_ticks() const {
+  int64_t total = 0;
+  for (int i = 0; i < event_count_; ++i) {
+    total += ElapsedTicks(events_[i].start_ticks, events_[i].end_ticks);
+  }
+  return SaturateToInt32(total);
+}
+
+void MicroOpProfiler::LogPerInvoke(ErrorReporter* error_reporter) const {
+  for (int i = 0; i < event_count_; ++i) {
+    const Event& event = events_[i];
+    TF_LITE_REPORT_ERROR(error_reporter, "Node %d %s took %d ticks",
+                         event.node_index, event.tag,
+                         ElapsedTicks(event.start_ticks, event.end_ticks));
+  }
+  TF_LITE_REPORT_ERROR(error_reporter, "Invoke took %d ticks in %d nodes",
+                       last_invoke_ticks(), event_count_);
+}
+
+void MicroOpProfiler::LogAggregated(ErrorReporter* error_reporter) const {
+  TF_LITE_REPORT_ERROR(error_reporter, "Profile over %d invokes:",
+                       invoke_count_);
+  int64_t total = 0;
+  for (int i = 0; i < node_stats_count_; ++i) {
+    const NodeStats& stats = node_stats_[i];
+    if (stats.count == 0) {
+      continue;
+    }
+    total += stats.total_ticks;
+    TF_LITE_REPORT_ERROR(
+        error_reporter,
+        "Node %d %s: total %d ticks, avg %d, min %d, max %d over %d runs", i,
+        stats.tag, SaturateToInt32(stats.total_ticks),
+        SaturateToInt32(stats.total_ticks / stats.count), stats.min_ticks,
+        stats.max_ticks, stats.count);
+  }
+  if (invoke_count_ > 0) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Average invoke: %d ticks",
+                         SaturateToInt32(total / invoke_count_));
+  }
+}
+
+void MicroOpProfiler::ResetAggregates() {
+  node_stats_count_ = 0;
+  invoke_count_ = 0;
+}
+
+}  // namespace tflite
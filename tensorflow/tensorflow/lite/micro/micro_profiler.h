@@ -0,0 +1,106 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_PROFILER_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_PROFILER_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/compatibility.h"
+
+namespace tflite {
+
+// Interface the MicroInterpreter calls around every kernel invocation. Attach
+// an implementation with MicroInterpreter::set_profiler(). When no profiler is
+// attached the interpreter skips all of these calls, so the hooks can be left
+// in production builds.
+class MicroProfiler {
+ public:
+  virtual ~MicroProfiler() {}
+
+  // Called at the start and at the end of every successful
+  // MicroInterpreter::Invoke().
+  virtual void BeginInvoke() {}
+  virtual void EndInvoke() {}
+
+  // Called right before registration->invoke() of the node with index
+  // `node_index`. `tag` is the operator name. The returned handle is passed
+  // back to EndEvent() right after the kernel returns.
+  virtual uint32_t BeginEvent(const char* tag, int node_index) = 0;
+  virtual void EndEvent(uint32_t event_handle) = 0;
+};
+
+// Profiler that records the elapsed ticks (see micro_time.h) of every node in
+// the most recent Invoke(), and aggregates them per node over all Invoke()
+// calls since the last ResetAggregates(). All storage is fixed size, so it can
+// be allocated statically alongside the interpreter.
+class MicroOpProfiler : public MicroProfiler {
+ public:
+  MicroOpProfiler();
+  ~MicroOpProfiler() override {}
+
+  void BeginInvoke() override;
+  void EndInvoke() override;
+  uint32_t BeginEvent(const char* tag, int node_index) override;
+  void EndEvent(uint32_t event_handle) override;
+
+  // Prints the time spent in each node during the most recent Invoke().
+  void LogPerInvoke(ErrorReporter* error_reporter) const;
+
+  // Prints, for every node, the total, average, minimum and maximum ticks
+  // over all Invoke() calls recorded so far.
+  void LogAggregated(ErrorReporter* error_reporter) const;
+
+  // Clears the aggregated statistics and the invoke counter.
+  void ResetAggregates();
+
+  // Number of completed Invoke() calls included in the aggregates.
+  int invoke_count() const { return invoke_count_; }
+
+  // Sum of all event durations in the most recent Invoke().
+  int32_t last_invoke_ticks() const;
+
+  // Events or nodes beyond this limit are ignored.
+  static constexpr int kMaxEvents = 64;
+
+ private:
+  struct Event {
+    const char* tag;
+    int node_index;
+    int32_t start_ticks;
+    int32_t end_ticks;
+  };
+
+  struct NodeStats {
+    const char* tag;
+    int count;
+    int64_t total_ticks;
+    int32_t min_ticks;
+    int32_t max_ticks;
+  };
+
+  Event events_[kMaxEvents];
+  int event_count_;
+
+  NodeStats node_stats_[kMaxEvents];
+  int node_stats_count_;
+  int invoke_count_;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_PROFILER_H_
@@ -0,0 +1,89 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_SNAPSHOT_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_SNAPSHOT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+
+namespace tflite {
+
+// A snapshot of a prepared interpreter, see MicroInterpreter::SaveSnapshot(),
+// is laid out as a MicroSnapshotHeader, a MicroSnapshotState and the bytes of
+// the arena tail.
+constexpr uint32_t kMicroSnapshotMagic = 0x534d4654;  // "TFMS"
+constexpr uint32_t kMicroSnapshotVersion = 1;
+
+struct MicroSnapshotHeader {
+  uint32_t magic;
+  uint32_t version;
+  // The key passed to SaveSnapshot(), see MicroSnapshotHash().
+  uint32_t model_hash;
+  // sizeof(MicroSnapshotState) of the build that saved it.
+  uint32_t state_bytes;
+  uint32_t tail_bytes;
+  // MicroSnapshotHash() of the state and the tail, so a blob that was only
+  // partly written, e.g. on a reset while programming flash, isn't used.
+  uint32_t checksum;
+};
+
+// What the interpreter and its allocator keep outside the arena once the
+// tensors are allocated. The pointers are only valid for the arena, model
+// and firmware the snapshot was made with.
+struct MicroSnapshotState {
+  // The key of the snapshot besides the model hash.
+  const Model* model;
+  const uint8_t* arena_start;
+  const uint8_t* arena_end;
+
+  // MicroAllocator.
+  internal::ScratchBufferHandle* scratch_buffer_handles;
+  size_t scratch_buffer_count;
+  NodeAndRegistration* node_and_registrations;
+  MicroMemoryRegion memory_regions[kMaxMemoryRegions];
+  int memory_region_count;
+  MicroArenaUsage arena_usage;
+  MicroAllocationStats allocation_stats[kMicroAllocationCategoryCount];
+  MicroNodeAllocations* node_allocations;
+
+  // MicroInterpreter.
+  int max_batch_size;
+  int batch_size;
+};
+
+// Hashes `size` bytes with 32-bit FNV-1a. Calls can be chained through
+// `hash`, e.g. to key a snapshot with both the model flatbuffer and a build
+// id of the firmware:
+//   uint32_t hash = MicroSnapshotHash(model_data, model_size);
+//   hash = MicroSnapshotHash(kBuildId, sizeof(kBuildId), hash);
+constexpr uint32_t kMicroSnapshotHashSeed = 2166136261u;
+uint32_t MicroSnapshotHash(const void* data, size_t size,
+                           uint32_t hash = kMicroSnapshotHashSeed);
+
+// Receives a snapshot in pieces, e.g. to program it into flash or to write it
+// to a file.
+class MicroSnapshotWriter {
+ public:
+  virtual ~MicroSnapshotWriter() {}
+
+  virtual TfLiteStatus Write(const void* data, size_t bytes) = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_SNAPSHOT_H_
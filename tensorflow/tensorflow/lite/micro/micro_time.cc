@@ -13,22 +13,92 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
-// Reference implementation of timer functions.  Platforms are not required to
-// implement these timer methods, but they are required to enable profiling.
+// Timer functions used for profiling and benchmarking. The time source is
+// picked at build time:
+//  - TF_LITE_MICRO_TIME_DWT uses the Cortex-M DWT cycle counter (CYCCNT), so
+//    a tick is one core clock cycle. This is the default for STM32F746 builds.
+//  - TF_LITE_MICRO_TIME_POSIX uses clock_gettime(CLOCK_MONOTONIC), with one
+//    tick per microsecond. This is the default for Linux and macOS hosts.
+//  - Otherwise both functions return 0, since timing is an optional feature
+//    that builds without errors on platforms that do not need it.
+// Define one of the macros above to override the default choice.
 
-// On platforms that have a POSIX stack or C library, it can be written using
-// methods from <sys/time.h> or clock() from <time.h>.
+#include "tensorflow/lite/micro/micro_time.h"
 
-// To add an equivalent function for your own platform, create your own
-// implementation file, and place it in a subfolder with named after the OS
-// you're targeting. For example, see the Cortex M bare metal version in
-// tensorflow/lite/micro/bluepill/micro_time.cc or the mbed one on
-// tensorflow/lite/micro/mbed/micro_time.cc.
+#if !defined(TF_LITE_MICRO_TIME_DWT) && !defined(TF_LITE_MICRO_TIME_POSIX)
+#if defined(STM32F746xx)
+#define TF_LITE_MICRO_TIME_DWT
+#elif defined(__linux__) || defined(__APPLE__)
+#define TF_LITE_MICRO_TIME_POSIX
+#endif
+#endif
 
-#include "tensorflow/lite/micro/micro_time.h"
+#if defined(TF_LITE_MICRO_TIME_DWT)
+// Provides the CMSIS core definitions (DWT, CoreDebug) and SystemCoreClock.
+#include "stm32f7xx.h"
+#elif defined(TF_LITE_MICRO_TIME_POSIX)
+#include <time.h>
+#endif
 
 namespace tflite {
 
+#if defined(TF_LITE_MICRO_TIME_DWT)
+
+namespace {
+
+// The cycle counter is disabled out of reset. It is started on first use so
+// that applications don't need any extra setup call.
+void EnableCycleCounter() {
+  static bool enabled = false;
+  if (enabled) {
+    return;
+  }
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  // The Cortex-M7 DWT is locked until this key is written to the Lock Access
+  // Register.
+  DWT->LAR = 0xC5ACCE55;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  enabled = true;
+}
+
+}  // namespace
+
+int32_t ticks_per_second() { return static_cast<int32_t>(SystemCoreClock); }
+
+int32_t GetCurrentTimeTicks() {
+  EnableCycleCounter();
+  return static_cast<int32_t>(DWT->CYCCNT);
+}
+
+#elif defined(TF_LITE_MICRO_TIME_POSIX)
+
+namespace {
+
+constexpr int64_t kTicksPerSecond = 1000000;
+
+int64_t MonotonicMicroseconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * kTicksPerSecond +
+         now.tv_nsec / (1000000000 / kTicksPerSecond);
+}
+
+}  // namespace
+
+int32_t ticks_per_second() { return static_cast<int32_t>(kTicksPerSecond); }
+
+// Truncated to 32 bits, so differences between two readings must be computed
+// with wraparound in mind, or use GetCurrentTimeTicks64() instead.
+int32_t GetCurrentTimeTicks() {
+  return static_cast<int32_t>(
+      static_cast<uint32_t>(MonotonicMicroseconds()));
+}
+
+int64_t GetCurrentTimeTicks64() { return MonotonicMicroseconds(); }
+
+#else
+
 // Reference implementation of the ticks_per_second() function that's required
 // for a platform to support Tensorflow Lite for Microcontrollers profiling.
 // This returns 0 by default because timing is an optional feature that builds
@@ -41,4 +111,23 @@ int32_t ticks_per_second() { return 0; }
 // that builds without errors on platforms that do not need it.
 int32_t GetCurrentTimeTicks() { return 0; }
 
+#endif
+
+#if !defined(TF_LITE_MICRO_TIME_POSIX)
+
+// Extends the 32-bit tick counter by counting how often it wrapped around
+// between two consecutive calls.
+int64_t GetCurrentTimeTicks64() {
+  static uint32_t last_ticks = 0;
+  static uint64_t wrapped_ticks = 0;
+  const uint32_t ticks = static_cast<uint32_t>(GetCurrentTimeTicks());
+  if (ticks < last_ticks) {
+    wrapped_ticks += static_cast<uint64_t>(1) << 32;
+  }
+  last_ticks = ticks;
+  return static_cast<int64_t>(wrapped_ticks + ticks);
+}
+
+#endif
+
 }  // namespace tflite
@@ -26,6 +26,12 @@ int32_t ticks_per_second();
 // Return time in ticks.  The meaning of a tick varies per platform.
 int32_t GetCurrentTimeTicks();
 
+// Return time in ticks as a 64-bit count, so that differences between two
+// readings don't overflow on long runs. On platforms with a 32-bit counter
+// this extends GetCurrentTimeTicks() in software, which requires it to be
+// called at least once per counter wrap period.
+int64_t GetCurrentTimeTicks64();
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_MICRO_MICRO_TIME_H_
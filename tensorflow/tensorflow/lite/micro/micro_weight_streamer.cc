@@ -0,0 +1,189 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_weight_streamer.h"
+
+#include <cstring>
+
+#include "tensorflow/lite/micro/memory_helpers.h"
+
+namespace tflite {
+
+namespace {
+
+// The cache line size of the Cortex-M7.
+constexpr size_t kStagingAlignment = 32;
+
+// Whether input `input_index` of `inputs` is a constant tensor that isn't
+// also an earlier input of the same node.
+bool IsStreamedInput(const TfLiteContext* context, const TfLiteIntArray* inputs,
+                     int input_index) {
+  const int tensor_index = inputs->data[input_index];
+  // Optional inputs are -1.
+  if (tensor_index < 0 ||
+      context->tensors[tensor_index].allocation_type != kTfLiteMmapRo) {
+    return false;
+  }
+  for (int i = 0; i < input_index; ++i) {
+    if (inputs->data[i] == tensor_index) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The inputs of a node that is invoked, or nullptr.
+const TfLiteIntArray* InvokedNodeInputs(
+    const NodeAndRegistration& node_and_registration) {
+  if (node_and_registration.registration == nullptr ||
+      node_and_registration.registration->invoke == nullptr) {
+    return nullptr;
+  }
+  return node_and_registration.node.inputs;
+}
+
+}  // namespace
+
+TfLiteStatus MemcpyMemoryCopier::StartCopy(void* destination,
+                                           const void* source, size_t bytes) {
+  std::memcpy(destination, source, bytes);
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroWeightStreamer::Init(
+    ErrorReporter* error_reporter, MicroAllocator* allocator,
+    TfLiteContext* context, const NodeAndRegistration* node_and_registrations,
+    size_t node_count, MicroMemoryCopier* copier) {
+  copier_ = copier;
+  node_count_ = node_count;
+
+  // Counts the constant inputs and the largest staging buffer first.
+  int staged_count = 0;
+  for (size_t i = 0; i < node_count; ++i) {
+    const TfLiteIntArray* inputs =
+        InvokedNodeInputs(node_and_registrations[i]);
+    if (inputs == nullptr) {
+      continue;
+    }
+    size_t node_bytes = 0;
+    for (int j = 0; j < inputs->size; ++j) {
+      if (IsStreamedInput(context, inputs, j)) {
+        node_bytes += AlignSizeUp(context->tensors[inputs->data[j]].bytes,
+                                  kStagingAlignment);
+        ++staged_count;
+      }
+    }
+    if (node_bytes > staging_bytes_) {
+      staging_bytes_ = node_bytes;
+    }
+  }
+  if (staged_count == 0) {
+    return kTfLiteOk;
+  }
+
+  void* first_staged;
+  void* staged;
+  void* staging;
+  TF_LITE_ENSURE_STATUS(allocator->AllocatePersistentBuffer(
+      sizeof(int) * (node_count + 1), &first_staged));
+  TF_LITE_ENSURE_STATUS(allocator->AllocatePersistentBuffer(
+      sizeof(StagedTensor) * staged_count, &staged));
+  TF_LITE_ENSURE_STATUS(allocator->AllocatePersistentBuffer(
+      2 * staging_bytes_ + kStagingAlignment, &staging));
+  first_staged_ = static_cast<int*>(first_staged);
+  staged_ = static_cast<StagedTensor*>(staged);
+  staging_buffers_[0] =
+      AlignPointerUp(static_cast<uint8_t*>(staging), kStagingAlignment);
+  staging_buffers_[1] = staging_buffers_[0] + staging_bytes_;
+
+  int staged_index = 0;
+  for (size_t i = 0; i < node_count; ++i) {
+    first_staged_[i] = staged_index;
+    const TfLiteIntArray* inputs =
+        InvokedNodeInputs(node_and_registrations[i]);
+    if (inputs == nullptr) {
+      continue;
+    }
+    size_t offset = 0;
+    for (int j = 0; j < inputs->size; ++j) {
+      if (!IsStreamedInput(context, inputs, j)) {
+        continue;
+      }
+      TfLiteTensor* tensor = &context->tensors[inputs->data[j]];
+      StagedTensor* current = &staged_[staged_index];
+      current->tensor = tensor;
+      current->source = tensor->data.data;
+      current->offset = offset;
+      offset += AlignSizeUp(tensor->bytes, kStagingAlignment);
+      ++staged_index;
+    }
+  }
+  first_staged_[node_count] = staged_index;
+  fetching_node_ = -1;
+  fetch_buffer_ = 0;
+  return kTfLiteOk;
+}
+
+int MicroWeightStreamer::NextStreamedNode(int node_index) const {
+  for (int i = 1; i <= node_count_; ++i) {
+    const int next = (node_index + i) % node_count_;
+    if (HasStagedTensors(next)) {
+      return next;
+    }
+  }
+  return node_index;
+}
+
+TfLiteStatus MicroWeightStreamer::StartFetch(int node_index,
+                                             int buffer_index) {
+  uint8_t* buffer = staging_buffers_[buffer_index];
+  for (int i = first_staged_[node_index]; i < first_staged_[node_index + 1];
+       ++i) {
+    const StagedTensor& current = staged_[i];
+    TF_LITE_ENSURE_STATUS(copier_->StartCopy(
+        buffer + current.offset, current.source, current.tensor->bytes));
+  }
+  fetching_node_ = node_index;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroWeightStreamer::PrepareNode(int node_index) {
+  if (first_staged_ == nullptr || !HasStagedTensors(node_index)) {
+    return kTfLiteOk;
+  }
+  if (fetching_node_ != node_index) {
+    // Only before the first invocation, or after one that stopped early.
+    TF_LITE_ENSURE_STATUS(copier_->Wait());
+    TF_LITE_ENSURE_STATUS(StartFetch(node_index, fetch_buffer_));
+  }
+  TF_LITE_ENSURE_STATUS(copier_->Wait());
+
+  uint8_t* buffer = staging_buffers_[fetch_buffer_];
+  for (int i = first_staged_[node_index]; i < first_staged_[node_index + 1];
+       ++i) {
+    staged_[i].tensor->data.data = buffer + staged_[i].offset;
+  }
+  fetch_buffer_ = 1 - fetch_buffer_;
+  return StartFetch(NextStreamedNode(node_index), fetch_buffer_);
+}
+
+TfLiteStatus MicroWeightStreamer::Wait() {
+  if (fetching_node_ == -1) {
+    return kTfLiteOk;
+  }
+  return copier_->Wait();
+}
+
+}  // namespace tflite
@@ -0,0 +1,118 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_WEIGHT_STREAMER_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_WEIGHT_STREAMER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+
+namespace tflite {
+
+// Copies memory in the background for the MicroWeightStreamer, e.g. with a
+// DMA channel on the target.
+class MicroMemoryCopier {
+ public:
+  virtual ~MicroMemoryCopier() {}
+
+  // Starts copying `bytes` bytes from `source` to `destination` and may
+  // return before the copy is done. The copies started before the next Wait()
+  // never overlap and may run in any order.
+  virtual TfLiteStatus StartCopy(void* destination, const void* source,
+                                 size_t bytes) = 0;
+
+  // Returns when all the copies started so far are done.
+  virtual TfLiteStatus Wait() = 0;
+};
+
+// Copies synchronously with memcpy(). There is nothing to overlap, so it's
+// only useful on hosts and as a reference.
+class MemcpyMemoryCopier : public MicroMemoryCopier {
+ public:
+  TfLiteStatus StartCopy(void* destination, const void* source,
+                         size_t bytes) override;
+  TfLiteStatus Wait() override { return kTfLiteOk; }
+};
+
+// Streams the constant tensors of a model that is kept in slow memory, such
+// as QSPI flash or SDRAM, through two staging buffers in the arena. While a
+// node runs on its constant inputs in one buffer, the copier fetches the
+// constant inputs of the next node that has any into the other one, so the
+// copy overlaps with the computation. After the last node, the first node's
+// inputs are fetched for the next invocation.
+//
+// A staging buffer holds the largest set of constant inputs of a single
+// node. Each tensor starts at a 32 bytes boundary, the cache line size of
+// the Cortex-M7, so a DMA copier can invalidate the cache lines of a tensor
+// without touching its neighbours.
+//
+// Kernels read the constants where the model is during Prepare. During
+// Invoke a constant tensor points to the staging buffer of the node that ran
+// last with it, so its data is only valid while that node runs.
+class MicroWeightStreamer {
+ public:
+  // Finds the constant inputs of every node, and allocates the schedule and
+  // the staging buffers from the tail of the arena. Must be called after the
+  // kernels are prepared. `copier` must outlive the streamer.
+  TfLiteStatus Init(ErrorReporter* error_reporter, MicroAllocator* allocator,
+                    TfLiteContext* context,
+                    const NodeAndRegistration* node_and_registrations,
+                    size_t node_count, MicroMemoryCopier* copier);
+
+  // Points the constant inputs of node `node_index` to their staged copy,
+  // waiting for the fetch if needed, and starts fetching the next node's.
+  TfLiteStatus PrepareNode(int node_index);
+
+  // Waits for the fetch in flight, if any.
+  TfLiteStatus Wait();
+
+  // The bytes of one staging buffer, 0 when there is nothing to stream.
+  size_t staging_bytes() const { return staging_bytes_; }
+
+ private:
+  struct StagedTensor {
+    TfLiteTensor* tensor;
+    const void* source;
+    // Offset in the staging buffer.
+    size_t offset;
+  };
+
+  bool HasStagedTensors(int node_index) const {
+    return first_staged_[node_index] != first_staged_[node_index + 1];
+  }
+  // The next node after `node_index` with constant inputs, wrapping around.
+  int NextStreamedNode(int node_index) const;
+  TfLiteStatus StartFetch(int node_index, int buffer_index);
+
+  MicroMemoryCopier* copier_ = nullptr;
+  int node_count_ = 0;
+  // The tensors of node i are staged_[first_staged_[i]] up to
+  // staged_[first_staged_[i + 1] - 1]. Null when there is nothing to stream.
+  int* first_staged_ = nullptr;
+  StagedTensor* staged_ = nullptr;
+  uint8_t* staging_buffers_[2] = {};
+  size_t staging_bytes_ = 0;
+  // The node whose inputs are fetched into staging_buffers_[fetch_buffer_],
+  // or -1.
+  int fetching_node_ = -1;
+  int fetch_buffer_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_WEIGHT_STREAMER_H_
@@ -35,6 +35,12 @@ SimpleMemoryAllocator* CreateInPlaceSimpleMemoryAllocator(
 
 uint8_t* SimpleMemoryAllocator::AllocateFromHead(size_t size,
                                                  size_t alignment) {
+  if (temp_ != head_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Temporary allocations must be reset before "
+                         "allocating from the head");
+    return nullptr;
+  }
   uint8_t* const aligned_result = AlignPointerUp(head_, alignment);
   const size_t available_memory = tail_ - aligned_result;
   if (available_memory < size) {
@@ -45,14 +51,15 @@ uint8_t* SimpleMemoryAllocator::AllocateFromHead(size_t size,
     return nullptr;
   }
   head_ = aligned_result + size;
+  temp_ = head_;
   return aligned_result;
 }
 
 uint8_t* SimpleMemoryAllocator::AllocateFromTail(size_t size,
                                                  size_t alignment) {
   uint8_t* const aligned_result = AlignPointerDown(tail_ - size, alignment);
-  if (aligned_result < head_) {
-    const size_t missing_memory = head_ - aligned_result;
+  if (aligned_result < temp_) {
+    const size_t missing_memory = temp_ - aligned_result;
     TF_LITE_REPORT_ERROR(
         error_reporter_,
         "Failed to allocate memory. Requested: %u, available %u, missing: %u",
@@ -60,6 +67,22 @@ uint8_t* SimpleMemoryAllocator::AllocateFromTail(size_t size,
     return nullptr;
   }
   tail_ = aligned_result;
+  ++tail_allocation_count_;
+  tail_requested_bytes_ += size;
+  return aligned_result;
+}
+
+uint8_t* SimpleMemoryAllocator::AllocateTemp(size_t size, size_t alignment) {
+  uint8_t* const aligned_result = AlignPointerUp(temp_, alignment);
+  const size_t available_memory = tail_ - aligned_result;
+  if (available_memory < size) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Failed to allocate temporary memory. Requested: %u, "
+                         "available %u, missing: %u",
+                         size, available_memory, size - available_memory);
+    return nullptr;
+  }
+  temp_ = aligned_result + size;
   return aligned_result;
 }
 
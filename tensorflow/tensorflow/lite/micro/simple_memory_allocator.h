@@ -34,26 +34,39 @@ class SimpleMemoryAllocator {
         buffer_head_(buffer_head),
         buffer_tail_(buffer_tail),
         head_(buffer_head),
-        tail_(buffer_tail) {}
+        tail_(buffer_tail),
+        temp_(buffer_head) {}
   SimpleMemoryAllocator(ErrorReporter* error_reporter, uint8_t* buffer,
                         size_t buffer_size)
       : SimpleMemoryAllocator(error_reporter, buffer, buffer + buffer_size) {}
 
   // Allocates memory starting at the head of the arena (lowest address and
-  // moving upwards).
+  // moving upwards). Fails while there are temporary allocations.
   uint8_t* AllocateFromHead(size_t size, size_t alignment);
   // Allocates memory starting at the tail of the arena (highest address and
   // moving downwards).
   uint8_t* AllocateFromTail(size_t size, size_t alignment);
 
+  // Allocates memory above the head that stays valid until
+  // ResetTempAllocations(). Temporary allocations are contiguous: after a
+  // reset, the first one starts at the same address again, so a temporary
+  // array can be grown by resetting and allocating it again with its new size.
+  uint8_t* AllocateTemp(size_t size, size_t alignment);
+  void ResetTempAllocations() { temp_ = head_; }
+
   uint8_t* GetHead() const { return head_; }
   uint8_t* GetTail() const { return tail_; }
-  size_t GetAvailableMemory() const { return tail_ - head_; }
+  size_t GetAvailableMemory() const { return tail_ - temp_; }
   size_t GetUsedBytes() const { return GetBufferSize() - GetAvailableMemory(); }
 
   size_t GetHeadUsedBytes() const { return head_ - buffer_head_; }
   size_t GetTailUsedBytes() const { return buffer_tail_ - tail_; }
 
+  // Number of successful tail allocations, and the sum of their requested
+  // sizes. GetTailUsedBytes() also counts the alignment padding.
+  size_t GetTailAllocationCount() const { return tail_allocation_count_; }
+  size_t GetTailRequestedBytes() const { return tail_requested_bytes_; }
+
  private:
   size_t GetBufferSize() const { return buffer_tail_ - buffer_head_; }
 
@@ -62,6 +75,10 @@ class SimpleMemoryAllocator {
   uint8_t* buffer_tail_;
   uint8_t* head_;
   uint8_t* tail_;
+  // The end of the temporary allocations, head_ when there are none.
+  uint8_t* temp_;
+  size_t tail_allocation_count_ = 0;
+  size_t tail_requested_bytes_ = 0;
 };
 
 // Allocate a SimpleMemoryAllocator from the buffer and then return the pointer
@@ -33,27 +33,28 @@ extern tflite::ErrorReporter* reporter;
   int main(int argc, char** argv) {              \
     tflite::MicroErrorReporter error_reporter;   \
     micro_benchmark::reporter = &error_reporter; \
-    int32_t start_ticks;                         \
-    int32_t duration_ticks;                      \
-    int32_t duration_ms;
+    int64_t start_ticks;                         \
+    int64_t duration_ticks;                      \
+    int64_t duration_ms;
 
 #define TF_LITE_MICRO_BENCHMARKS_END \
   return 0;                          \
   }
 
+// Durations are measured with the 64-bit tick counter, so runs longer than one
+// wrap period of the 32-bit counter are reported correctly. The logged values
+// are clamped to INT_MAX since the ErrorReporter can only print 32-bit ints.
 #define TF_LITE_MICRO_BENCHMARK(func)                                         \
   if (tflite::ticks_per_second() == 0) {                                      \
     return 0;                                                                 \
   }                                                                           \
-  start_ticks = tflite::GetCurrentTimeTicks();                                \
+  start_ticks = tflite::GetCurrentTimeTicks64();                              \
   func();                                                                     \
-  duration_ticks = tflite::GetCurrentTimeTicks() - start_ticks;               \
-  if (duration_ticks > INT_MAX / 1000) {                                      \
-    duration_ms = duration_ticks / (tflite::ticks_per_second() / 1000);       \
-  } else {                                                                    \
-    duration_ms = (duration_ticks * 1000) / tflite::ticks_per_second();       \
-  }                                                                           \
-  TF_LITE_REPORT_ERROR(micro_benchmark::reporter, "%s took %d ticks (%d ms)", \
-                       #func, duration_ticks, duration_ms);
+  duration_ticks = tflite::GetCurrentTimeTicks64() - start_ticks;             \
+  duration_ms = (duration_ticks * 1000) / tflite::ticks_per_second();         \
+  TF_LITE_REPORT_ERROR(                                                       \
+      micro_benchmark::reporter, "%s took %d ticks (%d ms)", #func,           \
+      static_cast<int>(duration_ticks > INT_MAX ? INT_MAX : duration_ticks),  \
+      static_cast<int>(duration_ms > INT_MAX ? INT_MAX : duration_ms));
 
 #endif  // TENSORFLOW_LITE_MICRO_TESTING_MICRO_BENCHMARK_H_
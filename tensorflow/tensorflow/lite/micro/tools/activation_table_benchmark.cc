@@ -0,0 +1,255 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that checks the int8 LOGISTIC and TANH kernels of TFLite Micro,
+// which look their outputs up in a table, against
+// reference_integer_ops::Logistic() and reference_integer_ops::Tanh(). For
+// --cases random input scales and zero points per operator, it runs the
+// kernel through its registration on all 256 int8 inputs and compares the
+// outputs bit for bit. It also prints the time of both for 4096 inputs.
+//
+// Build it like tensorflow/lite/micro/tools/arena_size.cc, with
+// activation_table_benchmark.cc instead of arena_size.cc.
+//
+// Usage:
+//   activation_table_benchmark [--cases=<n>] [--seed=<n>]
+//
+// --cases is 500 by default.
+
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/logistic.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/tanh.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/tools/model_file.h"
+
+namespace {
+
+// Every int8 value appears kInputCount / 256 times.
+constexpr int kInputCount = 4096;
+
+// Each measurement repeats the kernel for at least this long.
+constexpr double kMinMeasureUs = 50000.0;
+
+enum class Operator { kLogistic, kTanh };
+
+// A small deterministic generator, so runs are comparable across hosts.
+uint32_t NextRandom(uint32_t* state) {
+  *state = *state * 1664525u + 1013904223u;
+  return *state >> 8;
+}
+
+// Calls `run` until kMinMeasureUs have passed and returns the microseconds
+// per call.
+template <typename F>
+double Measure(F run) {
+  int calls = 0;
+  const auto start = std::chrono::steady_clock::now();
+  double elapsed_us = 0.0;
+  do {
+    run();
+    ++calls;
+    elapsed_us = std::chrono::duration<double, std::micro>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  } while (elapsed_us < kMinMeasureUs);
+  return elapsed_us / calls;
+}
+
+TfLiteStatus AllocatePersistentBuffer(TfLiteContext* context, size_t bytes,
+                                      void** ptr) {
+  *ptr = malloc(bytes);
+  return *ptr != nullptr ? kTfLiteOk : kTfLiteError;
+}
+
+void ReportError(TfLiteContext* context, const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fprintf(stderr, "\n");
+}
+
+// One node of the operator on kInputCount int8 inputs, run through the
+// kernel's registration the way the interpreter does. The persistent buffers
+// of the kernel are leaked, the tool only makes a few thousand.
+class KernelRunner {
+ public:
+  KernelRunner(Operator op, float input_scale, int input_zero_point,
+               const int8_t* input, int8_t* output)
+      : registration_(op == Operator::kLogistic
+                          ? tflite::ops::micro::Register_LOGISTIC()
+                          : tflite::ops::micro::Register_TANH()) {
+    dims_ = TfLiteIntArrayCreate(1);
+    dims_->data[0] = kInputCount;
+    memset(tensors_, 0, sizeof(tensors_));
+    for (TfLiteTensor& tensor : tensors_) {
+      tensor.type = kTfLiteInt8;
+      tensor.dims = dims_;
+      tensor.bytes = kInputCount;
+      tensor.allocation_type = kTfLiteArenaRw;
+    }
+    tensors_[0].data.int8 = const_cast<int8_t*>(input);
+    tensors_[0].params.scale = input_scale;
+    tensors_[0].params.zero_point = input_zero_point;
+    tensors_[1].data.int8 = output;
+    // The fixed output quantization of the operators.
+    tensors_[1].params.scale =
+        op == Operator::kLogistic ? 1.f / 256 : 1.f / 128;
+    tensors_[1].params.zero_point = op == Operator::kLogistic ? -128 : 0;
+
+    memset(&context_, 0, sizeof(context_));
+    context_.tensors = tensors_;
+    context_.tensors_size = 2;
+    context_.AllocatePersistentBuffer = AllocatePersistentBuffer;
+    context_.ReportError = ReportError;
+
+    inputs_ = TfLiteIntArrayCreate(1);
+    inputs_->data[0] = 0;
+    outputs_ = TfLiteIntArrayCreate(1);
+    outputs_->data[0] = 1;
+    memset(&node_, 0, sizeof(node_));
+    node_.inputs = inputs_;
+    node_.outputs = outputs_;
+  }
+
+  ~KernelRunner() {
+    TfLiteIntArrayFree(dims_);
+    TfLiteIntArrayFree(inputs_);
+    TfLiteIntArrayFree(outputs_);
+  }
+
+  TfLiteStatus Prepare() {
+    node_.user_data = registration_->init(&context_, nullptr, 0);
+    return registration_->prepare(&context_, &node_);
+  }
+
+  TfLiteStatus Invoke() { return registration_->invoke(&context_, &node_); }
+
+ private:
+  TfLiteRegistration* registration_;
+  TfLiteIntArray* dims_;
+  TfLiteIntArray* inputs_;
+  TfLiteIntArray* outputs_;
+  TfLiteTensor tensors_[2];
+  TfLiteContext context_;
+  TfLiteNode node_;
+};
+
+// Runs the reference kernel with the input parameters that LOGISTIC and TANH
+// computed in Prepare() before they used a table.
+void RunReference(Operator op, float input_scale, int input_zero_point,
+                  const int8_t* input, int8_t* output) {
+  static constexpr int kInputIntegerBits = 4;
+  const double input_real_multiplier =
+      static_cast<double>(input_scale) *
+      static_cast<double>(1 << (31 - kInputIntegerBits));
+  int input_left_shift;
+  const double q = std::frexp(input_real_multiplier, &input_left_shift);
+  const int32_t input_multiplier =
+      static_cast<int32_t>(tflite::TfLiteRound(q * (1ll << 31)));
+  const int32_t input_range_radius =
+      tflite::CalculateInputRadius(kInputIntegerBits, input_left_shift, 31);
+  if (op == Operator::kLogistic) {
+    tflite::reference_integer_ops::Logistic(
+        input_zero_point, input_range_radius, input_multiplier,
+        input_left_shift, kInputCount, input, output);
+  } else {
+    tflite::reference_integer_ops::Tanh(
+        input_zero_point, input_range_radius, input_multiplier,
+        input_left_shift, kInputCount, input, output);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int cases = 500;
+  uint32_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (const char* value = tflite::tools::FlagValue(argv[i], "cases")) {
+      cases = atoi(value);
+    } else if (const char* value = tflite::tools::FlagValue(argv[i], "seed")) {
+      seed = strtoul(value, nullptr, 10);
+    } else {
+      fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  std::vector<int8_t> input(kInputCount);
+  for (int i = 0; i < kInputCount; ++i) {
+    input[i] = static_cast<int8_t>(i * 37);
+  }
+  std::vector<int8_t> kernel_output(kInputCount);
+  std::vector<int8_t> reference_output(kInputCount);
+
+  bool all_equal = true;
+  uint32_t state = seed;
+  for (Operator op : {Operator::kLogistic, Operator::kTanh}) {
+    const char* name = op == Operator::kLogistic ? "LOGISTIC" : "TANH";
+    int mismatches = 0;
+    for (int i = 0; i < cases; ++i) {
+      // Input scales from about 0.0025 to 7.4, so both the saturated and the
+      // linear parts of the curves are covered.
+      const float input_scale =
+          std::exp(static_cast<float>(NextRandom(&state) % 8001) / 1000.f -
+                   6.f);
+      const int input_zero_point =
+          static_cast<int>(NextRandom(&state) % 256) - 128;
+      KernelRunner kernel(op, input_scale, input_zero_point, input.data(),
+                          kernel_output.data());
+      if (kernel.Prepare() != kTfLiteOk || kernel.Invoke() != kTfLiteOk) {
+        fprintf(stderr, "%s failed for input scale %g\n", name, input_scale);
+        return 1;
+      }
+      RunReference(op, input_scale, input_zero_point, input.data(),
+                   reference_output.data());
+      if (memcmp(kernel_output.data(), reference_output.data(),
+                 kInputCount) != 0) {
+        fprintf(stderr,
+                "The outputs of %s differ for input scale %g, zero point %d\n",
+                name, input_scale, input_zero_point);
+        ++mismatches;
+      }
+    }
+
+    const float input_scale = 0.05f;
+    KernelRunner kernel(op, input_scale, 0, input.data(),
+                        kernel_output.data());
+    if (kernel.Prepare() != kTfLiteOk) {
+      return 1;
+    }
+    const double reference_us = Measure([&]() {
+      RunReference(op, input_scale, 0, input.data(), reference_output.data());
+    });
+    const double kernel_us = Measure([&]() { kernel.Invoke(); });
+    printf("%s: %d random input quantizations, %d with different outputs\n",
+           name, cases, mismatches);
+    printf("%s: %d inputs, reference %.3f us, table %.3f us, %.2fx\n", name,
+           kInputCount, reference_us, kernel_us, reference_us / kernel_us);
+    all_equal = all_equal && mismatches == 0;
+  }
+  return all_equal ? 0 : 1;
+}
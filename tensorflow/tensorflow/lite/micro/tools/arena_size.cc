@@ -0,0 +1,240 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that finds the exact tensor arena size a model needs, instead of
+// finding kTensorArenaSize by trial and error on the device.
+//
+// It does a dry run of MicroInterpreter::AllocateTensors() with a large arena,
+// prints how the arena is used, and then searches for the smallest arena that
+// AllocateTensors() accepts. Optionally it writes a header with that size.
+//
+// The sizes of the runtime structs depend on the pointer size, so build the
+// tool for a 32-bit host to get the numbers of a 32-bit target such as the
+// Cortex-M7. From the repository root, with <sources> being all .cc files
+// under tensorflow/ except the ones in micro/tools and micro/benchmarks:
+//
+//   g++ -m32 -std=c++11 -O2 -Itensorflow -Ithird_party/flatbuffers/include
+//     -Ithird_party/gemmlowp -Ithird_party/ruy <sources>
+//     tensorflow/tensorflow/lite/micro/tools/arena_size.cc
+//     tensorflow/tensorflow/lite/micro/tools/model_file.cc
+//     tensorflow/tensorflow/lite/micro/tools/host_debug_log.cc
+//     -x c tensorflow/tensorflow/lite/c/common.c -o arena_size
+//
+// Usage:
+//   arena_size <model.tflite> [--header=<path>] [--name=<constant name>]
+//       [--max_batch_size=<n>] [--bind_inputs_outputs] [--fuse_graph]
+//       [--stream_weights] [--per_node]
+//
+// --max_batch_size sizes the arena for MicroInterpreter::InvokeBatch() with up
+// to n inputs, see MicroInterpreter::SetMaxBatchSize().
+// --bind_inputs_outputs leaves the input and output tensors out of the arena,
+// for applications that bind them with MicroInterpreter::BindInput() and
+// BindOutput().
+// --fuse_graph sizes the arena for MicroInterpreter::EnableGraphFusion().
+// --stream_weights adds the staging buffers of
+// MicroInterpreter::EnableWeightStreaming().
+// --per_node also prints the allocation counts and what every node allocates,
+// see MicroInterpreter::EnableAllocationRecording(). The recording itself is
+// left out of the arena size.
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "tensorflow/lite/micro/kernels/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/tools/model_file.h"
+
+namespace {
+
+using tflite::tools::InterpreterOptions;
+
+// Big enough for any model that fits on a microcontroller.
+constexpr size_t kDryRunArenaSize = 64 * 1024 * 1024;
+
+// The interpreter reports every failed allocation, which is expected while
+// searching for the minimum, so those messages are dropped.
+class SilentErrorReporter : public tflite::ErrorReporter {
+ public:
+  int Report(const char* format, va_list args) override { return 0; }
+};
+
+bool AllocationSucceeds(const tflite::Model* model,
+                        const tflite::OpResolver& resolver, uint8_t* arena,
+                        size_t arena_size, const InterpreterOptions& options) {
+  SilentErrorReporter error_reporter;
+  tflite::MicroInterpreter interpreter(model, resolver, arena, arena_size,
+                                       &error_reporter);
+  return interpreter.initialization_status() == kTfLiteOk &&
+         tflite::tools::ConfigureInterpreter(options, &interpreter) ==
+             kTfLiteOk &&
+         interpreter.AllocateTensors() == kTfLiteOk;
+}
+
+void PrintUsage(const tflite::MicroArenaUsage& usage) {
+  const size_t tail = usage.allocator_bytes + usage.tensor_struct_bytes +
+                      usage.quantization_bytes +
+                      usage.node_and_registration_bytes +
+                      usage.builtin_data_bytes + usage.persistent_buffer_bytes +
+                      usage.scratch_handle_bytes + usage.variable_bytes +
+                      usage.batch_dims_bytes + usage.recording_bytes;
+  printf("Head (planned tensors and scratch buffers): %zu bytes\n",
+         usage.planned_bytes);
+  printf("Tail (persistent): %zu bytes\n", tail);
+  printf("  SimpleMemoryAllocator:      %8zu\n", usage.allocator_bytes);
+  printf("  TfLiteTensor array:         %8zu\n", usage.tensor_struct_bytes);
+  printf("  Quantization params:        %8zu\n", usage.quantization_bytes);
+  printf("  NodeAndRegistration array:  %8zu\n",
+         usage.node_and_registration_bytes);
+  printf("  Builtin op data:            %8zu\n", usage.builtin_data_bytes);
+  printf("  Persistent kernel buffers:  %8zu\n", usage.persistent_buffer_bytes);
+  printf("  Scratch buffer handles:     %8zu\n", usage.scratch_handle_bytes);
+  printf("  Variable tensors:           %8zu\n", usage.variable_bytes);
+  printf("  Batched tensor dims:        %8zu\n", usage.batch_dims_bytes);
+  printf("  Allocation records:         %8zu\n", usage.recording_bytes);
+  printf("Temporary memory used while planning: %zu bytes\n",
+         usage.planning_bytes);
+}
+
+bool WriteHeader(const char* path, const char* name, const char* model_path,
+                 const InterpreterOptions& options, size_t arena_size) {
+  FILE* file = fopen(path, "w");
+  if (file == nullptr) {
+    fprintf(stderr, "Couldn't open %s for writing\n", path);
+    return false;
+  }
+  fprintf(file,
+          "// Generated by tensorflow/lite/micro/tools/arena_size.cc from\n"
+          "// %s with --max_batch_size=%d%s%s%s.\n"
+          "// Do not edit.\n"
+          "// The size is a host-computed upper bound for a 16 bytes aligned\n"
+          "// tensor arena. Only a build of the tool with the pointer size of\n"
+          "// the target gives the exact size.\n\n"
+          "#pragma once\n\n"
+          "#include <stdint.h>\n\n"
+          "constexpr uint32_t %s = %zu;\n",
+          model_path, options.max_batch_size,
+          options.bind_inputs_outputs ? " --bind_inputs_outputs" : "",
+          options.fuse_graph ? " --fuse_graph" : "",
+          options.stream_weights ? " --stream_weights" : "", name, arena_size);
+  fclose(file);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr,
+            "Usage: %s <model.tflite> [--header=<path>] [--name=<name>]\n",
+            argv[0]);
+    return 1;
+  }
+  const char* header_path = nullptr;
+  const char* constant_name = "kTensorArenaSize";
+  InterpreterOptions options;
+  bool per_node = false;
+  for (int i = 2; i < argc; ++i) {
+    if (const char* value = tflite::tools::FlagValue(argv[i], "header")) {
+      header_path = value;
+    } else if (const char* value = tflite::tools::FlagValue(argv[i], "name")) {
+      constant_name = value;
+    } else if (strcmp(argv[i], "--per_node") == 0) {
+      per_node = true;
+    } else if (!tflite::tools::ParseInterpreterFlag(argv[i], &options)) {
+      fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  size_t model_size = 0;
+  uint8_t* model_data = tflite::tools::ReadModelFile(argv[1], &model_size);
+  if (model_data == nullptr) {
+    return 1;
+  }
+  const tflite::Model* model =
+      tflite::tools::VerifyModel(model_data, model_size);
+  if (model == nullptr) {
+    return 1;
+  }
+  if (sizeof(void*) != 4) {
+    printf("Warning: this is a %zu-bit build, the sizes of the runtime "
+           "structs differ from a 32-bit target.\n",
+           sizeof(void*) * 8);
+  }
+
+  static tflite::ops::micro::AllOpsResolver resolver;
+  uint8_t* arena = static_cast<uint8_t*>(aligned_alloc(16, kDryRunArenaSize));
+
+  // Dry run with plenty of memory to get the breakdown.
+  tflite::MicroErrorReporter error_reporter;
+  size_t estimate = 0;
+  size_t tail_bytes = 0;
+  {
+    tflite::MicroInterpreter interpreter(model, resolver, arena,
+                                         kDryRunArenaSize, &error_reporter);
+    if (tflite::tools::ConfigureInterpreter(options, &interpreter) !=
+            kTfLiteOk ||
+        (per_node && interpreter.EnableAllocationRecording() != kTfLiteOk) ||
+        interpreter.AllocateTensors() != kTfLiteOk) {
+      fprintf(stderr, "AllocateTensors() failed even with %zu bytes\n",
+              kDryRunArenaSize);
+      return 1;
+    }
+    PrintUsage(interpreter.arena_usage());
+    if (per_node) {
+      interpreter.PrintAllocations();
+    }
+    estimate = interpreter.required_arena_bytes() -
+               interpreter.arena_usage().recording_bytes;
+    tail_bytes = interpreter.arena_usage().allocator_bytes +
+                 interpreter.arena_usage().tensor_struct_bytes;
+  }
+
+  // The estimate is checked by searching for the smallest arena that
+  // actually works, since alignment padding depends on the arena size.
+  // Anything smaller than the allocator and the tensor structs fails early.
+  size_t low = tail_bytes;
+  size_t high = estimate;
+  while (!AllocationSucceeds(model, resolver, arena, high, options)) {
+    low = high;
+    high *= 2;
+    if (high > kDryRunArenaSize) {
+      fprintf(stderr, "No working arena size found\n");
+      return 1;
+    }
+  }
+  while (low + 1 < high) {
+    const size_t middle = low + (high - low) / 2;
+    if (AllocationSucceeds(model, resolver, arena, middle, options)) {
+      high = middle;
+    } else {
+      low = middle;
+    }
+  }
+  printf("Minimum tensor arena size: %zu bytes (estimate %zu)\n", high,
+         estimate);
+
+  if (header_path != nullptr &&
+      !WriteHeader(header_path, constant_name, argv[1], options, high)) {
+    return 1;
+  }
+  free(arena);
+  free(model_data);
+  return 0;
+}
@@ -0,0 +1,197 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that writes the memory plan of a model as CSV or JSON Lines, one
+// record per planned buffer: tensor or scratch buffer id, size, first and
+// last use and offset, see MemoryPlanWriter. It runs
+// MicroInterpreter::AllocateTensors() like the firmware does, so no target is
+// needed.
+//
+// Build it like tensorflow/lite/micro/tools/arena_size.cc, with
+// export_memory_plan.cc instead of arena_size.cc.
+//
+// Usage:
+//   export_memory_plan <model.tflite> [--arena_size=<bytes>]
+//       [--format=csv|json] [--output=<path>]
+//       [--planner=default|greedy|linear|optimal] [--max_batch_size=<n>]
+//       [--bind_inputs_outputs] [--fuse_graph] [--stream_weights]
+//
+// --arena_size is the tensor arena of the firmware. The default is large
+// enough for any model; a plan that doesn't fit fails like on the target.
+// --output writes the plan to a file instead of stdout.
+// --planner compares another planner with the IntervalMemoryPlanner used by
+// default, or with the plan stored in the model if there is one. optimal
+// searches for 10 seconds, see tensorflow/lite/micro/tools/plan_memory.cc.
+// The other flags are the ones of arena_size.cc, see
+// tflite::tools::InterpreterOptions.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/lite/micro/kernels/all_ops_resolver.h"
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/linear_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/memory_plan_writer.h"
+#include "tensorflow/lite/micro/memory_planner/optimal_memory_planner.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/tools/model_file.h"
+
+namespace {
+
+using tflite::tools::InterpreterOptions;
+
+// Big enough for any model that fits on a microcontroller.
+constexpr size_t kDryRunArenaSize = 64 * 1024 * 1024;
+constexpr int kMaxBufferCount = 64 * 1024;
+constexpr int32_t kOptimalTimeBudgetMs = 10000;
+
+class FileMemoryPlanWriter : public tflite::MemoryPlanWriter {
+ public:
+  FileMemoryPlanWriter(FILE* file, tflite::MemoryPlanFormat format)
+      : tflite::MemoryPlanWriter(format), file_(file) {}
+
+ protected:
+  void WriteLine(const char* line) override { fprintf(file_, "%s\n", line); }
+
+ private:
+  FILE* file_;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr,
+            "Usage: %s <model.tflite> [--arena_size=<bytes>] "
+            "[--format=csv|json] [--output=<path>] "
+            "[--planner=default|greedy|linear|optimal]\n",
+            argv[0]);
+    return 1;
+  }
+  size_t arena_size = kDryRunArenaSize;
+  tflite::MemoryPlanFormat format = tflite::MemoryPlanFormat::kCsv;
+  const char* output_path = nullptr;
+  const char* planner_name = "default";
+  InterpreterOptions options;
+  for (int i = 2; i < argc; ++i) {
+    if (const char* value = tflite::tools::FlagValue(argv[i], "arena_size")) {
+      arena_size = strtoul(value, nullptr, 10);
+    } else if (const char* value =
+                   tflite::tools::FlagValue(argv[i], "format")) {
+      if (strcmp(value, "csv") == 0) {
+        format = tflite::MemoryPlanFormat::kCsv;
+      } else if (strcmp(value, "json") == 0) {
+        format = tflite::MemoryPlanFormat::kJson;
+      } else {
+        fprintf(stderr, "Unknown format %s\n", value);
+        return 1;
+      }
+    } else if (const char* value =
+                   tflite::tools::FlagValue(argv[i], "output")) {
+      output_path = value;
+    } else if (const char* value =
+                   tflite::tools::FlagValue(argv[i], "planner")) {
+      planner_name = value;
+    } else if (!tflite::tools::ParseInterpreterFlag(argv[i], &options)) {
+      fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  // Only the chosen planner gets scratch memory.
+  const bool use_greedy = strcmp(planner_name, "greedy") == 0;
+  const bool use_optimal = strcmp(planner_name, "optimal") == 0;
+  std::vector<uint8_t> greedy_scratch(
+      use_greedy ? kMaxBufferCount *
+                       tflite::GreedyMemoryPlanner::per_buffer_size()
+                 : 0);
+  tflite::GreedyMemoryPlanner greedy_planner(greedy_scratch.data(),
+                                             greedy_scratch.size());
+  tflite::LinearMemoryPlanner linear_planner;
+  std::vector<uint8_t> optimal_scratch(
+      use_optimal ? kMaxBufferCount *
+                        tflite::OptimalMemoryPlanner::per_buffer_size()
+                  : 0);
+  tflite::OptimalMemoryPlanner optimal_planner(
+      optimal_scratch.data(), optimal_scratch.size(), kOptimalTimeBudgetMs,
+      INT64_MAX);
+  tflite::MemoryPlanner* planner = nullptr;
+  if (use_greedy) {
+    planner = &greedy_planner;
+  } else if (use_optimal) {
+    planner = &optimal_planner;
+  } else if (strcmp(planner_name, "linear") == 0) {
+    planner = &linear_planner;
+  } else if (strcmp(planner_name, "default") != 0) {
+    fprintf(stderr, "Unknown planner %s\n", planner_name);
+    return 1;
+  }
+
+  size_t model_size = 0;
+  uint8_t* model_data = tflite::tools::ReadModelFile(argv[1], &model_size);
+  if (model_data == nullptr) {
+    return 1;
+  }
+  const tflite::Model* model =
+      tflite::tools::VerifyModel(model_data, model_size);
+  if (model == nullptr) {
+    return 1;
+  }
+
+  FILE* file = stdout;
+  if (output_path != nullptr) {
+    file = fopen(output_path, "w");
+    if (file == nullptr) {
+      fprintf(stderr, "Couldn't open %s for writing\n", output_path);
+      return 1;
+    }
+  }
+
+  static tflite::ops::micro::AllOpsResolver resolver;
+  tflite::MicroErrorReporter error_reporter;
+  uint8_t* arena = static_cast<uint8_t*>(
+      aligned_alloc(16, (arena_size + 15) & ~static_cast<size_t>(15)));
+  FileMemoryPlanWriter writer(file, format);
+  int status = 0;
+  {
+    tflite::MicroInterpreter interpreter(model, resolver, arena, arena_size,
+                                         &error_reporter);
+    if (interpreter.initialization_status() != kTfLiteOk ||
+        tflite::tools::ConfigureInterpreter(options, &interpreter) !=
+            kTfLiteOk ||
+        (planner != nullptr &&
+         interpreter.SetMemoryPlanner(planner) != kTfLiteOk) ||
+        interpreter.SetMemoryPlanWriter(&writer) != kTfLiteOk ||
+        interpreter.AllocateTensors() != kTfLiteOk) {
+      fprintf(stderr, "AllocateTensors() failed with %zu bytes\n",
+              arena_size);
+      status = 1;
+    } else {
+      fprintf(stderr, "Planned %zu bytes with the %s planner\n",
+              interpreter.arena_usage().planned_bytes, planner_name);
+    }
+  }
+
+  if (file != stdout) {
+    fclose(file);
+  }
+  free(arena);
+  free(model_data);
+  return status;
+}
@@ -0,0 +1,152 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that compares the time per layer of the reference and the
+// optimized float fully connected kernels, and checks that both give the
+// same outputs. The first three layers are the ones of the sine model, the
+// others are larger layers of e.g. a keyword spotting model.
+//
+// Build it like tensorflow/lite/micro/tools/arena_size.cc, with
+// fully_connected_benchmark.cc instead of arena_size.cc. Built for a host
+// without SSE, e.g. with -m32 -mno-sse, it times the portable code that the
+// Cortex-M7 runs.
+//
+// Usage:
+//   fully_connected_benchmark [--batches=<n>] [--seed=<n>]
+//
+// --batches is the number of input rows per call, 1 by default. The sine
+// model in Core/main.cpp runs 71.
+
+#include <cfloat>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/lite/kernels/internal/optimized/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/reference/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/tools/model_file.h"
+
+namespace {
+
+struct Layer {
+  int input_depth;
+  int output_depth;
+  bool relu;
+};
+
+constexpr Layer kLayers[] = {
+    {1, 16, true},      {16, 16, true},     {16, 1, false},
+    {64, 64, true},     {256, 128, true},   {1024, 256, false},
+};
+
+// Each measurement repeats the kernel for at least this long.
+constexpr double kMinMeasureUs = 50000.0;
+
+// A small deterministic generator, so runs are comparable across hosts.
+float NextRandom(uint32_t* state) {
+  *state = *state * 1664525u + 1013904223u;
+  return static_cast<float>(*state >> 8) / (1 << 24) * 2.0f - 1.0f;
+}
+
+// Calls `run` until kMinMeasureUs have passed and returns the microseconds
+// per call.
+template <typename F>
+double Measure(F run) {
+  int calls = 0;
+  const auto start = std::chrono::steady_clock::now();
+  double elapsed_us = 0.0;
+  do {
+    run();
+    ++calls;
+    elapsed_us = std::chrono::duration<double, std::micro>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  } while (elapsed_us < kMinMeasureUs);
+  return elapsed_us / calls;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int batches = 1;
+  uint32_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (const char* value = tflite::tools::FlagValue(argv[i], "batches")) {
+      batches = atoi(value);
+    } else if (const char* value = tflite::tools::FlagValue(argv[i], "seed")) {
+      seed = strtoul(value, nullptr, 10);
+    } else {
+      fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  printf("%12s %16s %16s %8s\n", "layer", "reference (us)", "optimized (us)",
+         "speedup");
+  bool all_equal = true;
+  uint32_t state = seed;
+  for (const Layer& layer : kLayers) {
+    const tflite::RuntimeShape input_shape({batches, layer.input_depth});
+    const tflite::RuntimeShape weights_shape(
+        {layer.output_depth, layer.input_depth});
+    const tflite::RuntimeShape bias_shape({layer.output_depth});
+    const tflite::RuntimeShape output_shape({batches, layer.output_depth});
+
+    std::vector<float> input(input_shape.FlatSize());
+    std::vector<float> weights(weights_shape.FlatSize());
+    std::vector<float> bias(layer.output_depth);
+    for (float& value : input) value = NextRandom(&state);
+    for (float& value : weights) value = NextRandom(&state);
+    for (float& value : bias) value = NextRandom(&state);
+    std::vector<float> packed(
+        tflite::optimized_ops::FullyConnectedPackedSize(weights_shape));
+    tflite::optimized_ops::PackFullyConnectedWeights(
+        weights_shape, weights.data(), packed.data());
+
+    tflite::FullyConnectedParams params;
+    params.float_activation_min = layer.relu ? 0.0f : -FLT_MAX;
+    params.float_activation_max = FLT_MAX;
+
+    std::vector<float> reference_output(output_shape.FlatSize());
+    std::vector<float> optimized_output(output_shape.FlatSize());
+    const double reference_us = Measure([&]() {
+      tflite::reference_ops::FullyConnected(
+          params, input_shape, input.data(), weights_shape, weights.data(),
+          bias_shape, bias.data(), output_shape, reference_output.data());
+    });
+    const double optimized_us = Measure([&]() {
+      tflite::optimized_ops::FullyConnected(
+          params, input_shape, input.data(), weights_shape, weights.data(),
+          packed.data(), bias_shape, bias.data(), output_shape,
+          optimized_output.data());
+    });
+
+    char name[32];
+    snprintf(name, sizeof(name), "%dx%d", layer.input_depth,
+             layer.output_depth);
+    printf("%12s %16.3f %16.3f %7.2fx\n", name, reference_us, optimized_us,
+           reference_us / optimized_us);
+    if (memcmp(reference_output.data(), optimized_output.data(),
+               reference_output.size() * sizeof(float)) != 0) {
+      fprintf(stderr, "The outputs differ for %s\n", name);
+      all_equal = false;
+    }
+  }
+  return all_equal ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that compares the time per layer of the reference and the
+// optimized int8 fully connected kernels, and checks that both give the same
+// outputs. The first three layers are the ones of the int8 sine model, the
+// others are larger layers of e.g. a keyword spotting model. After the timed
+// layers it checks --cases more layers of random shapes, zero points and
+// output scales, which also cover the outputs left over by the four-row loop.
+//
+// Build it like tensorflow/lite/micro/tools/arena_size.cc, with
+// fully_connected_int8_benchmark.cc instead of arena_size.cc. Built for a host
+// without SSE, e.g. with -m32 -mno-sse, it times the portable code. With
+// -msse4.1 or -mavx2, plus -DTF_LITE_DISABLE_X86_NEON for the headers that
+// would otherwise need NEON_2_SSE.h, it checks the x86 code paths.
+//
+// Usage:
+//   fully_connected_int8_benchmark [--batches=<n>] [--cases=<n>] [--seed=<n>]
+//
+// --batches is the number of input rows per call of the timed layers, 1 by
+// default. The sine model in Core/main.cpp runs 71. --cases is 1000 by
+// default.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/tools/model_file.h"
+
+namespace {
+
+struct Layer {
+  int input_depth;
+  int output_depth;
+  bool relu;
+};
+
+constexpr Layer kLayers[] = {
+    {1, 16, true},      {16, 16, true},     {16, 1, false},
+    {64, 64, true},     {256, 128, true},   {1024, 256, false},
+};
+
+// Each measurement repeats the kernel for at least this long.
+constexpr double kMinMeasureUs = 50000.0;
+
+// A small deterministic generator, so runs are comparable across hosts.
+uint32_t NextRandom(uint32_t* state) {
+  *state = *state * 1664525u + 1013904223u;
+  return *state >> 8;
+}
+
+int RandomInt(uint32_t* state, int min, int max) {
+  return min + static_cast<int>(NextRandom(state) % (max - min + 1));
+}
+
+// Calls `run` until kMinMeasureUs have passed and returns the microseconds
+// per call.
+template <typename F>
+double Measure(F run) {
+  int calls = 0;
+  const auto start = std::chrono::steady_clock::now();
+  double elapsed_us = 0.0;
+  do {
+    run();
+    ++calls;
+    elapsed_us = std::chrono::duration<double, std::micro>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  } while (elapsed_us < kMinMeasureUs);
+  return elapsed_us / calls;
+}
+
+// The inputs and parameters of one layer, with random values.
+struct LayerData {
+  LayerData(uint32_t* state, int batches, int input_depth, int output_depth,
+            bool relu)
+      : input_shape({batches, input_depth}),
+        filter_shape({output_depth, input_depth}),
+        bias_shape({output_depth}),
+        output_shape({batches, output_depth}),
+        input(input_shape.FlatSize()),
+        filter(filter_shape.FlatSize()),
+        bias(output_depth),
+        folded_bias(output_depth) {
+    for (int8_t& value : input) value = RandomInt(state, -128, 127);
+    for (int8_t& value : filter) value = RandomInt(state, -127, 127);
+    for (int32_t& value : bias) value = RandomInt(state, -20000, 20000);
+    params.input_offset = RandomInt(state, -127, 128);
+    // Symmetric weights have no zero point, but the kernel supports one.
+    params.weights_offset =
+        NextRandom(state) % 2 ? 0 : RandomInt(state, -127, 128);
+    params.output_offset = RandomInt(state, -128, 127);
+    // Output scales small enough to keep most outputs in range.
+    const double output_scale =
+        1.0 / (input_depth * RandomInt(state, 64, 4096));
+    tflite::QuantizeMultiplier(output_scale, &params.output_multiplier,
+                               &params.output_shift);
+    params.quantized_activation_min = relu ? params.output_offset : -128;
+    params.quantized_activation_max = 127;
+    tflite::optimized_integer_ops::PrecomputeFullyConnectedBias(
+        params.input_offset, params.weights_offset, filter_shape,
+        filter.data(), bias.data(), folded_bias.data());
+  }
+
+  void RunReference(int8_t* output) const {
+    tflite::reference_integer_ops::FullyConnected(
+        params, input_shape, input.data(), filter_shape, filter.data(),
+        bias_shape, bias.data(), output_shape, output);
+  }
+
+  void RunOptimized(int8_t* output) const {
+    tflite::optimized_integer_ops::FullyConnected(
+        params, input_shape, input.data(), filter_shape, filter.data(),
+        folded_bias.data(), output_shape, output);
+  }
+
+  tflite::RuntimeShape input_shape;
+  tflite::RuntimeShape filter_shape;
+  tflite::RuntimeShape bias_shape;
+  tflite::RuntimeShape output_shape;
+  std::vector<int8_t> input;
+  std::vector<int8_t> filter;
+  std::vector<int32_t> bias;
+  std::vector<int32_t> folded_bias;
+  tflite::FullyConnectedParams params;
+};
+
+bool OutputsMatch(const LayerData& layer) {
+  std::vector<int8_t> reference_output(layer.output_shape.FlatSize());
+  std::vector<int8_t> optimized_output(layer.output_shape.FlatSize());
+  layer.RunReference(reference_output.data());
+  layer.RunOptimized(optimized_output.data());
+  return memcmp(reference_output.data(), optimized_output.data(),
+                reference_output.size()) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int batches = 1;
+  int cases = 1000;
+  uint32_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (const char* value = tflite::tools::FlagValue(argv[i], "batches")) {
+      batches = atoi(value);
+    } else if (const char* value =
+                   tflite::tools::FlagValue(argv[i], "cases")) {
+      cases = atoi(value);
+    } else if (const char* value = tflite::tools::FlagValue(argv[i], "seed")) {
+      seed = strtoul(value, nullptr, 10);
+    } else {
+      fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  printf("%12s %16s %16s %8s\n", "layer", "reference (us)", "optimized (us)",
+         "speedup");
+  bool all_equal = true;
+  uint32_t state = seed;
+  for (const Layer& layer : kLayers) {
+    const LayerData data(&state, batches, layer.input_depth,
+                         layer.output_depth, layer.relu);
+    std::vector<int8_t> output(data.output_shape.FlatSize());
+    const double reference_us =
+        Measure([&]() { data.RunReference(output.data()); });
+    const double optimized_us =
+        Measure([&]() { data.RunOptimized(output.data()); });
+
+    char name[32];
+    snprintf(name, sizeof(name), "%dx%d", layer.input_depth,
+             layer.output_depth);
+    printf("%12s %16.3f %16.3f %7.2fx\n", name, reference_us, optimized_us,
+           reference_us / optimized_us);
+    if (!OutputsMatch(data)) {
+      fprintf(stderr, "The outputs differ for %s\n", name);
+      all_equal = false;
+    }
+  }
+
+  int mismatches = 0;
+  for (int i = 0; i < cases; ++i) {
+    const int case_batches = RandomInt(&state, 1, 4);
+    const int input_depth = RandomInt(&state, 1, 300);
+    const int output_depth = RandomInt(&state, 1, 70);
+    const bool relu = NextRandom(&state) % 2;
+    const LayerData data(&state, case_batches, input_depth, output_depth,
+                         relu);
+    if (!OutputsMatch(data)) {
+      fprintf(stderr, "The outputs differ for %d batches of %dx%d\n",
+              case_batches, input_depth, output_depth);
+      ++mismatches;
+    }
+  }
+  printf("%d random layers, %d with different outputs\n", cases, mismatches);
+  return all_equal && mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,779 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that compiles a .tflite model ahead of time into a C++ class with
+// the same input()/output()/Invoke() API as MicroInterpreter.
+//
+// For tiny models most of the time of MicroInterpreter::Invoke() is spent on
+// the interpreter itself rather than on the math. The generated code has none
+// of that overhead: every node becomes a direct call into a reference kernel,
+// tensor offsets in the arena come from the interpreter's memory plan, shapes
+// and quantization parameters are constants, and the weights are const arrays
+// that end up in flash. Where the interpreter runs an optimized kernel
+// instead, e.g. for FULLY_CONNECTED with constant weights, the results are
+// still bit-exact because the optimized kernels give the same outputs as the
+// reference ones, see fully_connected_benchmark.cc.
+//
+// Only the subset of operators below is supported. The tool stops with an
+// error for anything else, so a model that compiles always runs.
+//   FULLY_CONNECTED  float32, int8 and uint8
+//   QUANTIZE         float32 to int8 or uint8
+//   DEQUANTIZE       int8, uint8 or int16 to float32
+//   RELU, RELU6      float32
+//   RESHAPE
+//
+// Build it like arena_size.cc, with model_compiler.cc in place of
+// arena_size.cc. Usage:
+//   model_compiler <model.tflite> --header=<path.h> --source=<path.cpp>
+//       [--name=<class name>]
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/all_ops_resolver.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+#include "tensorflow/lite/micro/tools/model_file.h"
+
+namespace {
+
+// Big enough for any model that fits on a microcontroller. It's static
+// because the interpreter still uses it in its destructor.
+constexpr size_t kDryRunArenaSize = 64 * 1024 * 1024;
+alignas(16) uint8_t dry_run_arena[kDryRunArenaSize];
+
+
+// GetQuantizedConvolutionMultipler() and friends only use the context to
+// report errors.
+void ReportToStderr(TfLiteContext* context, const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fprintf(stderr, "\n");
+}
+
+// Prints a float so that it parses back to exactly the same value.
+void FormatFloat(float value, char* buffer, size_t buffer_size) {
+  snprintf(buffer, buffer_size, "%.9g", value);
+  if (strpbrk(buffer, ".e") == nullptr) {
+    strncat(buffer, ".0", buffer_size - strlen(buffer) - 1);
+  }
+  strncat(buffer, "f", buffer_size - strlen(buffer) - 1);
+}
+
+const char* CTypeName(TfLiteType type) {
+  switch (type) {
+    case kTfLiteFloat32:
+      return "float";
+    case kTfLiteInt32:
+      return "int32_t";
+    case kTfLiteInt16:
+      return "int16_t";
+    case kTfLiteInt8:
+      return "int8_t";
+    case kTfLiteUInt8:
+      return "uint8_t";
+    default:
+      return nullptr;
+  }
+}
+
+// Values per line in the emitted weight arrays, so that lines stay within 80
+// columns.
+size_t ValuesPerLine(TfLiteType type) {
+  switch (type) {
+    case kTfLiteFloat32:
+      return 4;
+    case kTfLiteInt32:
+      return 6;
+    default:
+      return 12;
+  }
+}
+
+const char* TypeEnumName(TfLiteType type) {
+  switch (type) {
+    case kTfLiteFloat32:
+      return "kTfLiteFloat32";
+    case kTfLiteInt32:
+      return "kTfLiteInt32";
+    case kTfLiteInt16:
+      return "kTfLiteInt16";
+    case kTfLiteInt8:
+      return "kTfLiteInt8";
+    case kTfLiteUInt8:
+      return "kTfLiteUInt8";
+    default:
+      return nullptr;
+  }
+}
+
+bool ConvertActivation(tflite::ActivationFunctionType activation,
+                       TfLiteFusedActivation* result) {
+  switch (activation) {
+    case tflite::ActivationFunctionType_NONE:
+      *result = kTfLiteActNone;
+      return true;
+    case tflite::ActivationFunctionType_RELU:
+      *result = kTfLiteActRelu;
+      return true;
+    case tflite::ActivationFunctionType_RELU_N1_TO_1:
+      *result = kTfLiteActRelu1;
+      return true;
+    case tflite::ActivationFunctionType_RELU6:
+      *result = kTfLiteActRelu6;
+      return true;
+    default:
+      return false;
+  }
+}
+
+class ModelCompiler {
+ public:
+  ModelCompiler(const tflite::Model* model,
+                tflite::MicroInterpreter* interpreter, size_t arena_size,
+                const uint8_t* arena)
+      : model_(model),
+        subgraph_(model->subgraphs()->Get(0)),
+        interpreter_(interpreter),
+        arena_size_(arena_size),
+        arena_(arena) {
+    memset(&context_, 0, sizeof(context_));
+    context_.ReportError = ReportToStderr;
+  }
+
+  // Checks that every operator and tensor is supported.
+  bool Check();
+
+  void WriteHeader(FILE* file, const char* model_path, const char* name);
+  void WriteSource(FILE* file, const char* model_path, const char* name,
+                   const char* header_include);
+
+ private:
+  tflite::BuiltinOperator OpCode(const tflite::Operator* op) const {
+    return model_->operator_codes()->Get(op->opcode_index())->builtin_code();
+  }
+  TfLiteTensor* Tensor(int index) const {
+    return interpreter_->tensor(index);
+  }
+  bool IsConstant(int index) const {
+    return Tensor(index)->allocation_type == kTfLiteMmapRo;
+  }
+  size_t Offset(int index) const {
+    return static_cast<size_t>(
+        reinterpret_cast<const uint8_t*>(Tensor(index)->data.raw) - arena_);
+  }
+  bool CheckOperator(int node_index, const tflite::Operator* op);
+  bool UsedBySupportedOps(int index) const;
+
+  // The expressions the generated code uses for a tensor.
+  void ShapeExpression(int index, char* buffer, size_t buffer_size) const;
+  void DataExpression(int index, bool is_const, char* buffer,
+                      size_t buffer_size) const;
+
+  void WriteTensorConstants(FILE* file, int index);
+  void WriteNode(FILE* file, int node_index, const tflite::Operator* op);
+  void WriteFullyConnected(FILE* file, const tflite::Operator* op);
+  void WriteQuantize(FILE* file, const tflite::Operator* op);
+  void WriteDequantize(FILE* file, const tflite::Operator* op);
+  void WriteRelu(FILE* file, const tflite::Operator* op, bool relu6);
+  void WriteReshape(FILE* file, const tflite::Operator* op);
+
+  const tflite::Model* model_;
+  const tflite::SubGraph* subgraph_;
+  tflite::MicroInterpreter* interpreter_;
+  size_t arena_size_;
+  const uint8_t* arena_;
+  TfLiteContext context_;
+};
+
+bool ModelCompiler::CheckOperator(int node_index, const tflite::Operator* op) {
+  const tflite::BuiltinOperator op_code = OpCode(op);
+  const char* op_name = tflite::EnumNameBuiltinOperator(op_code);
+  const TfLiteTensor* input = Tensor(op->inputs()->Get(0));
+  const TfLiteTensor* output = Tensor(op->outputs()->Get(0));
+  bool supported = false;
+  switch (op_code) {
+    case tflite::BuiltinOperator_FULLY_CONNECTED: {
+      const auto* options = op->builtin_options_as_FullyConnectedOptions();
+      TfLiteFusedActivation activation = kTfLiteActNone;
+      supported =
+          options != nullptr &&
+          options->weights_format() ==
+              tflite::FullyConnectedOptionsWeightsFormat_DEFAULT &&
+          ConvertActivation(options->fused_activation_function(),
+                            &activation) &&
+          IsConstant(op->inputs()->Get(1)) &&
+          (op->inputs()->size() < 3 || op->inputs()->Get(2) < 0 ||
+           IsConstant(op->inputs()->Get(2))) &&
+          input->type == output->type &&
+          (input->type == kTfLiteFloat32 || input->type == kTfLiteInt8 ||
+           input->type == kTfLiteUInt8);
+      break;
+    }
+    case tflite::BuiltinOperator_QUANTIZE:
+      supported = input->type == kTfLiteFloat32 &&
+                  (output->type == kTfLiteInt8 || output->type == kTfLiteUInt8);
+      break;
+    case tflite::BuiltinOperator_DEQUANTIZE:
+      supported = output->type == kTfLiteFloat32 &&
+                  (input->type == kTfLiteInt8 || input->type == kTfLiteUInt8 ||
+                   input->type == kTfLiteInt16);
+      break;
+    case tflite::BuiltinOperator_RELU:
+    case tflite::BuiltinOperator_RELU6:
+      supported =
+          input->type == kTfLiteFloat32 && output->type == kTfLiteFloat32;
+      break;
+    case tflite::BuiltinOperator_RESHAPE:
+      supported = input->bytes == output->bytes;
+      break;
+    default:
+      break;
+  }
+  if (!supported) {
+    fprintf(stderr, "Node %d: %s with input type %s is not supported\n",
+            node_index, op_name, TfLiteTypeGetName(input->type));
+  }
+  return supported;
+}
+
+bool ModelCompiler::Check() {
+  if (model_->subgraphs()->size() != 1) {
+    fprintf(stderr, "Only models with a single subgraph are supported\n");
+    return false;
+  }
+  for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
+    if (!CheckOperator(i, subgraph_->operators()->Get(i))) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < interpreter_->tensors_size(); ++i) {
+    const TfLiteTensor* tensor = Tensor(i);
+    if (!UsedBySupportedOps(i)) {
+      continue;
+    }
+    if (tensor->is_variable) {
+      fprintf(stderr, "Tensor %zu: variable tensors are not supported\n", i);
+      return false;
+    }
+    if (CTypeName(tensor->type) == nullptr) {
+      fprintf(stderr, "Tensor %zu: type %s is not supported\n", i,
+              TfLiteTypeGetName(tensor->type));
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ModelCompiler::UsedBySupportedOps(int index) const {
+  for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
+    const tflite::Operator* op = subgraph_->operators()->Get(i);
+    // The shape input of RESHAPE is only read by Prepare().
+    const size_t input_count =
+        OpCode(op) == tflite::BuiltinOperator_RESHAPE ? 1 : op->inputs()->size();
+    for (size_t j = 0; j < input_count; ++j) {
+      if (op->inputs()->Get(j) == index) {
+        return true;
+      }
+    }
+    for (size_t j = 0; j < op->outputs()->size(); ++j) {
+      if (op->outputs()->Get(j) == index) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void ModelCompiler::ShapeExpression(int index, char* buffer,
+                                    size_t buffer_size) const {
+  const TfLiteIntArray* dims = Tensor(index)->dims;
+  if (dims->size == 0) {
+    snprintf(buffer, buffer_size, "tflite::RuntimeShape()");
+  } else {
+    snprintf(buffer, buffer_size, "tflite::RuntimeShape(%d, kTensor%dShape)",
+             dims->size, index);
+  }
+}
+
+void ModelCompiler::DataExpression(int index, bool is_const, char* buffer,
+                                   size_t buffer_size) const {
+  if (index < 0) {
+    snprintf(buffer, buffer_size, "nullptr");
+  } else if (IsConstant(index)) {
+    snprintf(buffer, buffer_size, "kTensor%dData", index);
+  } else {
+    snprintf(buffer, buffer_size,
+             "reinterpret_cast<%s%s*>(&arena_[kTensor%dOffset])",
+             is_const ? "const " : "", CTypeName(Tensor(index)->type), index);
+  }
+}
+
+void ModelCompiler::WriteTensorConstants(FILE* file, int index) {
+  const TfLiteTensor* tensor = Tensor(index);
+  const char* name = subgraph_->tensors()->Get(index)->name() != nullptr
+                         ? subgraph_->tensors()->Get(index)->name()->c_str()
+                         : "";
+  fprintf(file, "// Tensor %d: %s\n", index, name);
+  if (tensor->dims->size > 0) {
+    fprintf(file, "constexpr int32_t kTensor%dShape[] = {", index);
+    for (int i = 0; i < tensor->dims->size; ++i) {
+      fprintf(file, "%s%d", i == 0 ? "" : ", ", tensor->dims->data[i]);
+    }
+    fprintf(file, "};\n");
+  }
+  if (!IsConstant(index)) {
+    fprintf(file, "constexpr size_t kTensor%dOffset = %zu;\n\n", index,
+            Offset(index));
+    return;
+  }
+  const char* type_name = CTypeName(tensor->type);
+  size_t type_size = 1;
+  tflite::TfLiteTypeSizeOf(tensor->type, &type_size, nullptr);
+  const size_t count = tensor->bytes / type_size;
+  fprintf(file, "alignas(16) const %s kTensor%dData[%zu] = {", type_name,
+          index, count);
+  for (size_t i = 0; i < count; ++i) {
+    fprintf(file, i % ValuesPerLine(tensor->type) == 0 ? "\n    " : " ");
+    switch (tensor->type) {
+      case kTfLiteFloat32: {
+        char value[32];
+        FormatFloat(tensor->data.f[i], value, sizeof(value));
+        fprintf(file, "%s,", value);
+        break;
+      }
+      case kTfLiteInt32:
+        fprintf(file, "%" PRId32 ",", tensor->data.i32[i]);
+        break;
+      case kTfLiteInt16:
+        fprintf(file, "%d,", tensor->data.i16[i]);
+        break;
+      case kTfLiteInt8:
+        fprintf(file, "%d,", tensor->data.int8[i]);
+        break;
+      case kTfLiteUInt8:
+        fprintf(file, "%u,", tensor->data.uint8[i]);
+        break;
+      default:
+        break;
+    }
+  }
+  fprintf(file, "\n};\n\n");
+}
+
+void ModelCompiler::WriteFullyConnected(FILE* file,
+                                        const tflite::Operator* op) {
+  const int input_index = op->inputs()->Get(0);
+  const int filter_index = op->inputs()->Get(1);
+  const int bias_index =
+      op->inputs()->size() < 3 ? -1 : op->inputs()->Get(2);
+  const int output_index = op->outputs()->Get(0);
+  TfLiteTensor* input = Tensor(input_index);
+  TfLiteTensor* filter = Tensor(filter_index);
+  TfLiteTensor* bias = bias_index < 0 ? nullptr : Tensor(bias_index);
+  TfLiteTensor* output = Tensor(output_index);
+  TfLiteFusedActivation activation = kTfLiteActNone;
+  ConvertActivation(op->builtin_options_as_FullyConnectedOptions()
+                        ->fused_activation_function(),
+                    &activation);
+
+  if (input->type == kTfLiteFloat32) {
+    float activation_min, activation_max;
+    tflite::CalculateActivationRange(activation, &activation_min,
+                                     &activation_max);
+    char min_value[32], max_value[32];
+    FormatFloat(activation_min, min_value, sizeof(min_value));
+    FormatFloat(activation_max, max_value, sizeof(max_value));
+    fprintf(file,
+            "    tflite::FullyConnectedParams op_params;\n"
+            "    op_params.float_activation_min = %s;\n"
+            "    op_params.float_activation_max = %s;\n",
+            min_value, max_value);
+  } else {
+    // Same computation as CalculateOpData() in kernels/fully_connected.cc.
+    double real_multiplier = 0.0;
+    int32_t output_multiplier;
+    int exponent;
+    int32_t activation_min, activation_max;
+    tflite::GetQuantizedConvolutionMultipler(&context_, input, filter, bias,
+                                             output, &real_multiplier);
+    tflite::QuantizeMultiplier(real_multiplier, &output_multiplier, &exponent);
+    tflite::CalculateActivationRangeQuantized(&context_, activation, output,
+                                              &activation_min, &activation_max);
+    fprintf(file,
+            "    tflite::FullyConnectedParams op_params;\n"
+            "    op_params.input_offset = %d;\n"
+            "    op_params.weights_offset = %d;\n"
+            "    op_params.output_offset = %d;\n"
+            "    op_params.output_multiplier = %" PRId32 ";\n"
+            "    op_params.output_shift = %d;\n"
+            "    op_params.quantized_activation_min = %" PRId32 ";\n"
+            "    op_params.quantized_activation_max = %" PRId32 ";\n",
+            -input->params.zero_point, -filter->params.zero_point,
+            output->params.zero_point, output_multiplier, exponent,
+            activation_min, activation_max);
+  }
+
+  char input_shape[64], filter_shape[64], bias_shape[64], output_shape[64];
+  char input_data[96], filter_data[96], bias_data[96], output_data[96];
+  ShapeExpression(input_index, input_shape, sizeof(input_shape));
+  ShapeExpression(filter_index, filter_shape, sizeof(filter_shape));
+  if (bias_index < 0) {
+    snprintf(bias_shape, sizeof(bias_shape), "tflite::RuntimeShape()");
+  } else {
+    ShapeExpression(bias_index, bias_shape, sizeof(bias_shape));
+  }
+  ShapeExpression(output_index, output_shape, sizeof(output_shape));
+  DataExpression(input_index, true, input_data, sizeof(input_data));
+  DataExpression(filter_index, true, filter_data, sizeof(filter_data));
+  DataExpression(bias_index, true, bias_data, sizeof(bias_data));
+  DataExpression(output_index, false, output_data, sizeof(output_data));
+  fprintf(file,
+          "    %s(\n"
+          "        op_params,\n"
+          "        %s,\n"
+          "        %s,\n"
+          "        %s, %s,\n"
+          "        %s, %s,\n"
+          "        %s,\n"
+          "        %s);\n",
+          input->type == kTfLiteInt8
+              ? "tflite::reference_integer_ops::FullyConnected"
+              : "tflite::reference_ops::FullyConnected",
+          input_shape, input_data, filter_shape, filter_data, bias_shape,
+          bias_data, output_shape, output_data);
+}
+
+void ModelCompiler::WriteQuantize(FILE* file, const tflite::Operator* op) {
+  const int input_index = op->inputs()->Get(0);
+  const int output_index = op->outputs()->Get(0);
+  const TfLiteTensor* output = Tensor(output_index);
+  char input_shape[64], output_shape[64], input_data[96], output_data[96];
+  ShapeExpression(input_index, input_shape, sizeof(input_shape));
+  ShapeExpression(output_index, output_shape, sizeof(output_shape));
+  DataExpression(input_index, true, input_data, sizeof(input_data));
+  DataExpression(output_index, false, output_data, sizeof(output_data));
+  fprintf(file,
+          "    tflite::QuantizationParams op_params;\n"
+          "    op_params.zero_point = %d;\n"
+          "    op_params.scale = %.17g;\n"
+          "    tflite::reference_ops::AffineQuantize(\n"
+          "        op_params, %s,\n"
+          "        %s,\n"
+          "        %s,\n"
+          "        %s);\n",
+          output->params.zero_point,
+          static_cast<double>(output->params.scale), input_shape, input_data,
+          output_shape, output_data);
+}
+
+void ModelCompiler::WriteDequantize(FILE* file, const tflite::Operator* op) {
+  const int input_index = op->inputs()->Get(0);
+  const int output_index = op->outputs()->Get(0);
+  const TfLiteTensor* input = Tensor(input_index);
+  char input_shape[64], output_shape[64], input_data[96], output_data[96];
+  ShapeExpression(input_index, input_shape, sizeof(input_shape));
+  ShapeExpression(output_index, output_shape, sizeof(output_shape));
+  DataExpression(input_index, true, input_data, sizeof(input_data));
+  DataExpression(output_index, false, output_data, sizeof(output_data));
+  fprintf(file,
+          "    tflite::DequantizationParams op_params;\n"
+          "    op_params.zero_point = %d;\n"
+          "    op_params.scale = %.17g;\n"
+          "    tflite::reference_ops::Dequantize(\n"
+          "        op_params, %s,\n"
+          "        %s,\n"
+          "        %s,\n"
+          "        %s);\n",
+          input->params.zero_point, static_cast<double>(input->params.scale),
+          input_shape, input_data, output_shape, output_data);
+}
+
+void ModelCompiler::WriteRelu(FILE* file, const tflite::Operator* op,
+                              bool relu6) {
+  const int input_index = op->inputs()->Get(0);
+  const int output_index = op->outputs()->Get(0);
+  char input_data[96], output_data[96];
+  DataExpression(input_index, true, input_data, sizeof(input_data));
+  DataExpression(output_index, false, output_data, sizeof(output_data));
+  // Same clamping as ReluFloat() and Relu6Float() in kernels/activations.cc.
+  fprintf(file,
+          "    const float* input_data =\n"
+          "        %s;\n"
+          "    float* output_data =\n"
+          "        %s;\n"
+          "    for (int i = 0; i < %d; ++i) {\n"
+          "      const float val = input_data[i];\n"
+          "      output_data[i] = %s;\n"
+          "    }\n",
+          input_data, output_data,
+          tflite::ElementCount(*Tensor(input_index)->dims),
+          relu6 ? "val > 6.0f ? 6.0f : val < 0.0f ? 0.0f : val"
+                : "val < 0.0f ? 0.0f : val");
+}
+
+void ModelCompiler::WriteReshape(FILE* file, const tflite::Operator* op) {
+  const int input_index = op->inputs()->Get(0);
+  const int output_index = op->outputs()->Get(0);
+  if (!IsConstant(input_index) && Offset(input_index) == Offset(output_index)) {
+    fprintf(file, "    // The output shares the input's buffer.\n");
+    return;
+  }
+  char input_data[96], output_data[96];
+  DataExpression(input_index, true, input_data, sizeof(input_data));
+  DataExpression(output_index, false, output_data, sizeof(output_data));
+  fprintf(file,
+          "    memcpy(%s,\n"
+          "           %s, %zu);\n",
+          output_data, input_data, Tensor(output_index)->bytes);
+}
+
+void ModelCompiler::WriteNode(FILE* file, int node_index,
+                              const tflite::Operator* op) {
+  const tflite::BuiltinOperator op_code = OpCode(op);
+  fprintf(file, "  // Node %d: %s\n  {\n", node_index,
+          tflite::EnumNameBuiltinOperator(op_code));
+  switch (op_code) {
+    case tflite::BuiltinOperator_FULLY_CONNECTED:
+      WriteFullyConnected(file, op);
+      break;
+    case tflite::BuiltinOperator_QUANTIZE:
+      WriteQuantize(file, op);
+      break;
+    case tflite::BuiltinOperator_DEQUANTIZE:
+      WriteDequantize(file, op);
+      break;
+    case tflite::BuiltinOperator_RELU:
+      WriteRelu(file, op, /*relu6=*/false);
+      break;
+    case tflite::BuiltinOperator_RELU6:
+      WriteRelu(file, op, /*relu6=*/true);
+      break;
+    case tflite::BuiltinOperator_RESHAPE:
+      WriteReshape(file, op);
+      break;
+    default:
+      break;
+  }
+  fprintf(file, "  }\n");
+}
+
+void ModelCompiler::WriteHeader(FILE* file, const char* model_path,
+                                const char* name) {
+  fprintf(file,
+          "// Generated by tensorflow/lite/micro/tools/model_compiler.cc from\n"
+          "// %s. Do not edit.\n\n"
+          "#pragma once\n\n"
+          "#include <stddef.h>\n"
+          "#include <stdint.h>\n\n"
+          "#include \"tensorflow/lite/c/common.h\"\n\n"
+          "// Runs the model without the interpreter. The API matches the\n"
+          "// subset of tflite::MicroInterpreter needed to run inference. It\n"
+          "// calls the reference kernels, which give the same results as the\n"
+          "// optimized kernels of the interpreter, bit for bit.\n"
+          "class %s {\n"
+          " public:\n"
+          "  %s();\n\n"
+          "  TfLiteTensor* input(size_t index) {\n"
+          "    return index < kInputCount ? &inputs_[index] : nullptr;\n"
+          "  }\n"
+          "  size_t inputs_size() const { return kInputCount; }\n"
+          "  TfLiteTensor* output(size_t index) {\n"
+          "    return index < kOutputCount ? &outputs_[index] : nullptr;\n"
+          "  }\n"
+          "  size_t outputs_size() const { return kOutputCount; }\n\n"
+          "  TfLiteStatus Invoke();\n\n"
+          "  // Bytes of RAM used for the input, output and intermediate\n"
+          "  // tensors.\n"
+          "  static constexpr size_t kArenaSize = %zu;\n\n"
+          " private:\n"
+          "  static constexpr size_t kInputCount = %u;\n"
+          "  static constexpr size_t kOutputCount = %u;\n\n"
+          "  alignas(16) uint8_t arena_[kArenaSize];\n"
+          "  TfLiteTensor inputs_[kInputCount];\n"
+          "  TfLiteTensor outputs_[kOutputCount];\n"
+          "};\n",
+          model_path, name, name, arena_size_ > 0 ? arena_size_ : 1,
+          subgraph_->inputs()->size(), subgraph_->outputs()->size());
+}
+
+void ModelCompiler::WriteSource(FILE* file, const char* model_path,
+                                const char* name, const char* header_include) {
+  fprintf(file,
+          "// Generated by tensorflow/lite/micro/tools/model_compiler.cc from\n"
+          "// %s. Do not edit.\n\n"
+          "#include \"%s\"\n\n"
+          "#include <string.h>\n\n"
+          "#include \"tensorflow/lite/kernels/internal/reference/"
+          "fully_connected.h\"\n"
+          "#include \"tensorflow/lite/kernels/internal/reference/"
+          "integer_ops/fully_connected.h\"\n"
+          "#include \"tensorflow/lite/kernels/internal/reference/"
+          "quantize.h\"\n"
+          "#include \"tensorflow/lite/kernels/internal/types.h\"\n\n"
+          "namespace {\n\n",
+          model_path, header_include);
+
+  for (size_t i = 0; i < interpreter_->tensors_size(); ++i) {
+    if (UsedBySupportedOps(i)) {
+      WriteTensorConstants(file, i);
+    }
+  }
+
+  // TfLiteIntArray layout: size followed by the dimensions.
+  const auto* inputs = subgraph_->inputs();
+  const auto* outputs = subgraph_->outputs();
+  for (int pass = 0; pass < 2; ++pass) {
+    const auto* indices = pass == 0 ? inputs : outputs;
+    for (size_t i = 0; i < indices->size(); ++i) {
+      const TfLiteIntArray* dims = Tensor(indices->Get(i))->dims;
+      fprintf(file, "int k%sDims%zu[] = {%d", pass == 0 ? "Input" : "Output",
+              i, dims->size);
+      for (int j = 0; j < dims->size; ++j) {
+        fprintf(file, ", %d", dims->data[j]);
+      }
+      fprintf(file, "};\n");
+    }
+  }
+
+  fprintf(file,
+          "\n"
+          "void InitTensor(TfLiteType type, uint8_t* data, int* dims, size_t "
+          "bytes,\n"
+          "                float scale, int32_t zero_point, TfLiteTensor* "
+          "tensor) {\n"
+          "  memset(tensor, 0, sizeof(*tensor));\n"
+          "  tensor->type = type;\n"
+          "  tensor->data.raw = reinterpret_cast<char*>(data);\n"
+          "  tensor->dims = reinterpret_cast<TfLiteIntArray*>(dims);\n"
+          "  tensor->params.scale = scale;\n"
+          "  tensor->params.zero_point = zero_point;\n"
+          "  tensor->allocation_type = kTfLiteArenaRw;\n"
+          "  tensor->bytes = bytes;\n"
+          "}\n\n"
+          "}  // namespace\n\n"
+          "%s::%s() {\n",
+          name, name);
+  for (int pass = 0; pass < 2; ++pass) {
+    const auto* indices = pass == 0 ? inputs : outputs;
+    for (size_t i = 0; i < indices->size(); ++i) {
+      const int index = indices->Get(i);
+      const TfLiteTensor* tensor = Tensor(index);
+      char scale[32];
+      FormatFloat(tensor->params.scale, scale, sizeof(scale));
+      fprintf(file,
+              "  InitTensor(%s, &arena_[kTensor%dOffset], k%sDims%zu, %zu, "
+              "%s, %d,\n"
+              "             &%s_[%zu]);\n",
+              TypeEnumName(tensor->type), index,
+              pass == 0 ? "Input" : "Output", i, tensor->bytes, scale,
+              tensor->params.zero_point, pass == 0 ? "inputs" : "outputs", i);
+    }
+  }
+  fprintf(file, "}\n\nTfLiteStatus %s::Invoke() {\n", name);
+  for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
+    WriteNode(file, i, subgraph_->operators()->Get(i));
+  }
+  fprintf(file, "  return kTfLiteOk;\n}\n");
+}
+
+const char* BaseName(const char* path) {
+  const char* slash = strrchr(path, '/');
+  return slash == nullptr ? path : slash + 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr,
+            "Usage: %s <model.tflite> --header=<path.h> --source=<path.cpp> "
+            "[--name=<class name>]\n",
+            argv[0]);
+    return 1;
+  }
+  const char* header_path = nullptr;
+  const char* source_path = nullptr;
+  const char* class_name = "CompiledModel";
+  for (int i = 2; i < argc; ++i) {
+    if (const char* value = tflite::tools::FlagValue(argv[i], "header")) {
+      header_path = value;
+    } else if (const char* value =
+                   tflite::tools::FlagValue(argv[i], "source")) {
+      source_path = value;
+    } else if (const char* value = tflite::tools::FlagValue(argv[i], "name")) {
+      class_name = value;
+    } else {
+      fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+  if (header_path == nullptr || source_path == nullptr) {
+    fprintf(stderr, "Both --header and --source are required\n");
+    return 1;
+  }
+
+  size_t model_size = 0;
+  uint8_t* model_data = tflite::tools::ReadModelFile(argv[1], &model_size);
+  if (model_data == nullptr) {
+    return 1;
+  }
+  const tflite::Model* model =
+      tflite::tools::VerifyModel(model_data, model_size);
+  if (model == nullptr) {
+    return 1;
+  }
+
+  // Let the interpreter parse the model and plan the arena, the generated
+  // code reuses the resulting offsets.
+  static tflite::ops::micro::AllOpsResolver resolver;
+  tflite::MicroErrorReporter error_reporter;
+  tflite::MicroInterpreter interpreter(model, resolver, dry_run_arena,
+                                       kDryRunArenaSize, &error_reporter);
+  if (interpreter.AllocateTensors() != kTfLiteOk) {
+    fprintf(stderr, "AllocateTensors() failed\n");
+    return 1;
+  }
+
+  ModelCompiler compiler(model, &interpreter,
+                         interpreter.arena_usage().planned_bytes,
+                         dry_run_arena);
+  if (!compiler.Check()) {
+    return 1;
+  }
+  FILE* header = fopen(header_path, "w");
+  FILE* source = fopen(source_path, "w");
+  if (header == nullptr || source == nullptr) {
+    fprintf(stderr, "Couldn't open the output files\n");
+    return 1;
+  }
+  compiler.WriteHeader(header, argv[1], class_name);
+  compiler.WriteSource(source, argv[1], class_name, BaseName(header_path));
+  fclose(header);
+  fclose(source);
+  printf("Wrote %s and %s, arena size %zu bytes\n", header_path, source_path,
+         interpreter.arena_usage().planned_bytes);
+  return 0;
+}
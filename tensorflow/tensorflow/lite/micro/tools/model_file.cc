@@ -0,0 +1,135 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/tools/model_file.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "tensorflow/lite/version.h"
+
+namespace tflite {
+namespace tools {
+
+uint8_t* ReadModelFile(const char* path, size_t* size) {
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) {
+    fprintf(stderr, "Couldn't open %s\n", path);
+    return nullptr;
+  }
+  fseek(file, 0, SEEK_END);
+  const long file_size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  if (file_size <= 0) {
+    fprintf(stderr, "%s is empty\n", path);
+    fclose(file);
+    return nullptr;
+  }
+  // Flatbuffers need their buffer to be aligned for the largest scalar they
+  // contain, and the interpreter expects 16 bytes aligned tensor data.
+  const size_t aligned_size = (static_cast<size_t>(file_size) + 15) & ~15;
+  uint8_t* data = static_cast<uint8_t*>(aligned_alloc(16, aligned_size));
+  if (data == nullptr ||
+      fread(data, 1, file_size, file) != static_cast<size_t>(file_size)) {
+    fprintf(stderr, "Couldn't read %s\n", path);
+    free(data);
+    fclose(file);
+    return nullptr;
+  }
+  fclose(file);
+  *size = static_cast<size_t>(file_size);
+  return data;
+}
+
+bool WriteFile(const char* path, const uint8_t* data, size_t size) {
+  FILE* file = fopen(path, "wb");
+  if (file == nullptr || fwrite(data, 1, size, file) != size) {
+    fprintf(stderr, "Couldn't write %s\n", path);
+    if (file != nullptr) {
+      fclose(file);
+    }
+    return false;
+  }
+  fclose(file);
+  return true;
+}
+
+const Model* VerifyModel(const uint8_t* data, size_t size) {
+  flatbuffers::Verifier verifier(data, size);
+  if (!VerifyModelBuffer(verifier)) {
+    fprintf(stderr, "The file is not a valid TensorFlow Lite model\n");
+    return nullptr;
+  }
+  const Model* model = GetModel(data);
+  if (model->version() != TFLITE_SCHEMA_VERSION) {
+    fprintf(stderr,
+            "Model provided is schema version %d not equal to supported "
+            "version %d\n",
+            model->version(), TFLITE_SCHEMA_VERSION);
+    return nullptr;
+  }
+  return model;
+}
+
+const char* FlagValue(const char* arg, const char* name) {
+  const size_t name_length = strlen(name);
+  if (strncmp(arg, "--", 2) != 0 || strncmp(arg + 2, name, name_length) != 0 ||
+      arg[2 + name_length] != '=') {
+    return nullptr;
+  }
+  return arg + 2 + name_length + 1;
+}
+
+bool ParseInterpreterFlag(const char* arg, InterpreterOptions* options) {
+  if (const char* value = FlagValue(arg, "max_batch_size")) {
+    options->max_batch_size = atoi(value);
+  } else if (strcmp(arg, "--bind_inputs_outputs") == 0) {
+    options->bind_inputs_outputs = true;
+  } else if (strcmp(arg, "--fuse_graph") == 0) {
+    options->fuse_graph = true;
+  } else if (strcmp(arg, "--stream_weights") == 0) {
+    options->stream_weights = true;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+TfLiteStatus ConfigureInterpreter(const InterpreterOptions& options,
+                                  MicroInterpreter* interpreter) {
+  static uint8_t bound_buffer[16];
+  static MemcpyMemoryCopier copier;
+  TF_LITE_ENSURE_STATUS(interpreter->SetMaxBatchSize(options.max_batch_size));
+  if (options.fuse_graph) {
+    TF_LITE_ENSURE_STATUS(interpreter->EnableGraphFusion());
+  }
+  if (options.stream_weights) {
+    TF_LITE_ENSURE_STATUS(interpreter->EnableWeightStreaming(&copier));
+  }
+  if (options.bind_inputs_outputs) {
+    for (size_t i = 0; i < interpreter->inputs_size(); ++i) {
+      TF_LITE_ENSURE_STATUS(interpreter->BindInput(i, bound_buffer, SIZE_MAX));
+    }
+    for (size_t i = 0; i < interpreter->outputs_size(); ++i) {
+      TF_LITE_ENSURE_STATUS(
+          interpreter->BindOutput(i, bound_buffer, SIZE_MAX));
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tools
+}  // namespace tflite
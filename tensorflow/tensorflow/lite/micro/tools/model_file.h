@@ -0,0 +1,70 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_TOOLS_MODEL_FILE_H_
+#define TENSORFLOW_LITE_MICRO_TOOLS_MODEL_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace tools {
+
+// Reads a .tflite file into a 16 bytes aligned buffer allocated with malloc().
+// Returns nullptr and prints the reason to stderr on failure. The caller owns
+// the returned buffer.
+uint8_t* ReadModelFile(const char* path, size_t* size);
+
+// Writes `size` bytes to a new file. Returns false and prints the reason to
+// stderr on failure.
+bool WriteFile(const char* path, const uint8_t* data, size_t size);
+
+// Checks that `data` holds a valid flatbuffer model of the supported schema
+// version and returns it, or returns nullptr and prints the reason to stderr.
+const Model* VerifyModel(const uint8_t* data, size_t size);
+
+// Returns the value of a `--name=value` argument, or nullptr if `arg` is a
+// different argument.
+const char* FlagValue(const char* arg, const char* name);
+
+// The MicroInterpreter settings that change the memory plan, so the tools
+// can reproduce what the application does before AllocateTensors():
+//   --max_batch_size=<n>   MicroInterpreter::SetMaxBatchSize()
+//   --bind_inputs_outputs  MicroInterpreter::BindInput() and BindOutput() for
+//                          all inputs and outputs
+//   --fuse_graph           MicroInterpreter::EnableGraphFusion()
+//   --stream_weights       MicroInterpreter::EnableWeightStreaming()
+struct InterpreterOptions {
+  int max_batch_size = 1;
+  bool bind_inputs_outputs = false;
+  bool fuse_graph = false;
+  bool stream_weights = false;
+};
+
+// Stores `arg` in `options` and returns true if it's one of the flags above.
+bool ParseInterpreterFlag(const char* arg, InterpreterOptions* options);
+
+// Applies `options` to an interpreter that hasn't allocated its tensors yet.
+// The bound buffers are never used, so they all point to the same dummy
+// memory, and weights are streamed with a MemcpyMemoryCopier.
+TfLiteStatus ConfigureInterpreter(const InterpreterOptions& options,
+                                  MicroInterpreter* interpreter);
+
+}  // namespace tools
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_TOOLS_MODEL_FILE_H_
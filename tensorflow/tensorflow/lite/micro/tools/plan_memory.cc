@@ -0,0 +1,357 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that searches for a smaller memory plan than the one of the
+// GreedyMemoryPlanner, and writes it to a header for the firmware.
+//
+// It runs MicroInterpreter::AllocateTensors() with an OptimalMemoryPlanner,
+// checks the resulting offsets by allocating again with a
+// PrecomputedMemoryPlanner, and searches for the smallest arena that works
+// with the plan.
+//
+// With --output the plan is stored in a copy of the model, as the
+// kPrecomputedMemoryPlanMetadata described in micro_allocator.h. The
+// allocator then commits it directly instead of planning at boot, which also
+// saves the arena space of the planner. Otherwise the firmware loads the plan
+// from the header written with --header:
+//
+//   #include "model_plan.h"
+//   ...
+//   alignas(16) static uint8_t tensor_arena[kModelPlanArenaSize];
+//   static uint8_t plan_scratch[kModelPlanBufferCount *
+//       tflite::PrecomputedMemoryPlanner::per_buffer_size()];
+//   tflite::PrecomputedMemoryPlanner planner(
+//       kModelPlan, kModelPlanBufferCount, plan_scratch, sizeof(plan_scratch));
+//   interpreter.SetMemoryPlanner(&planner);
+//   interpreter.AllocateTensors();
+//
+// The plan is only valid for the model and the interpreter settings it was
+// made with. AllocateTensors() fails if they don't match.
+//
+// Build it like tensorflow/lite/micro/tools/arena_size.cc, with plan_memory.cc
+// instead of arena_size.cc.
+//
+// Usage:
+//   plan_memory <model.tflite> [--output=<model.tflite>] [--header=<path>]
+//       [--name=<constant name>] [--time_budget_ms=<ms>]
+//       [--max_batch_size=<n>] [--bind_inputs_outputs] [--fuse_graph]
+//
+// --time_budget_ms limits the search, 10 seconds by default. The plan found
+// so far is used when the budget runs out.
+// The other flags are the ones of arena_size.cc, see
+// tflite::tools::InterpreterOptions.
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/micro/kernels/all_ops_resolver.h"
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/optimal_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/precomputed_memory_planner.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/tools/model_file.h"
+
+namespace {
+
+using tflite::tools::InterpreterOptions;
+
+// Big enough for any model that fits on a microcontroller.
+constexpr size_t kDryRunArenaSize = 64 * 1024 * 1024;
+constexpr int kMaxBufferCount = 64 * 1024;
+
+class SilentErrorReporter : public tflite::ErrorReporter {
+ public:
+  int Report(const char* format, va_list args) override { return 0; }
+};
+
+// Allocates the tensors of `model` with `planner`, or like the firmware does
+// by default if it's nullptr.
+TfLiteStatus Allocate(const tflite::Model* model,
+                      const tflite::OpResolver& resolver, uint8_t* arena,
+                      size_t arena_size, const InterpreterOptions& options,
+                      tflite::MemoryPlanner* planner,
+                      tflite::ErrorReporter* error_reporter,
+                      tflite::MicroArenaUsage* usage) {
+  tflite::MicroInterpreter interpreter(model, resolver, arena, arena_size,
+                                       error_reporter);
+  TF_LITE_ENSURE_STATUS(interpreter.initialization_status());
+  TF_LITE_ENSURE_STATUS(
+      tflite::tools::ConfigureInterpreter(options, &interpreter));
+  if (planner != nullptr) {
+    TF_LITE_ENSURE_STATUS(interpreter.SetMemoryPlanner(planner));
+  }
+  TF_LITE_ENSURE_STATUS(interpreter.AllocateTensors());
+  *usage = interpreter.arena_usage();
+  return kTfLiteOk;
+}
+
+// Allocates with the plan, like the firmware does, or with the plan stored in
+// the model if `offsets` is nullptr.
+TfLiteStatus AllocateWithPlan(const tflite::Model* model,
+                              const tflite::OpResolver& resolver,
+                              uint8_t* arena, size_t arena_size,
+                              const InterpreterOptions& options,
+                              const int32_t* offsets, int offset_count,
+                              tflite::ErrorReporter* error_reporter) {
+  const size_t scratch_size =
+      kMaxBufferCount * tflite::PrecomputedMemoryPlanner::per_buffer_size();
+  static uint8_t* scratch = static_cast<uint8_t*>(malloc(scratch_size));
+  tflite::PrecomputedMemoryPlanner planner(offsets, offset_count, scratch,
+                                           scratch_size);
+  tflite::MicroArenaUsage usage;
+  return Allocate(model, resolver, arena, arena_size, options,
+                  offsets != nullptr ? &planner : nullptr, error_reporter,
+                  &usage);
+}
+
+// Checks that the plan loads, and finds the smallest arena for it, since
+// alignment padding depends on the arena size. Returns 0 on failure.
+size_t MinimumArenaSize(const tflite::Model* model,
+                        const tflite::OpResolver& resolver, uint8_t* arena,
+                        const InterpreterOptions& options,
+                        const int32_t* offsets, int offset_count) {
+  tflite::MicroErrorReporter error_reporter;
+  if (AllocateWithPlan(model, resolver, arena, kDryRunArenaSize, options,
+                       offsets, offset_count, &error_reporter) != kTfLiteOk) {
+    return 0;
+  }
+  SilentErrorReporter silent_reporter;
+  size_t low = 0;
+  size_t high = kDryRunArenaSize;
+  while (low + 1 < high) {
+    const size_t middle = low + (high - low) / 2;
+    if (AllocateWithPlan(model, resolver, arena, middle, options, offsets,
+                         offset_count, &silent_reporter) == kTfLiteOk) {
+      high = middle;
+    } else {
+      low = middle;
+    }
+  }
+  return high;
+}
+
+// Returns a copy of `model` with the offsets in its
+// kPrecomputedMemoryPlanMetadata, replacing any previous plan.
+std::vector<uint8_t> AddOfflinePlan(const tflite::Model* model,
+                                    const int32_t* offsets, int offset_count) {
+  std::unique_ptr<tflite::ModelT> model_t(model->UnPack());
+  std::vector<int32_t> values = {0, 0, offset_count};
+  values.insert(values.end(), offsets, offsets + offset_count);
+  std::unique_ptr<tflite::BufferT> buffer(new tflite::BufferT);
+  buffer->data.resize(values.size() * sizeof(int32_t));
+  memcpy(buffer->data.data(), values.data(), buffer->data.size());
+
+  tflite::MetadataT* metadata = nullptr;
+  for (auto& entry : model_t->metadata) {
+    if (entry->name == tflite::kPrecomputedMemoryPlanMetadata &&
+        entry->buffer < model_t->buffers.size()) {
+      metadata = entry.get();
+    }
+  }
+  if (metadata != nullptr) {
+    model_t->buffers[metadata->buffer] = std::move(buffer);
+  } else {
+    model_t->metadata.emplace_back(new tflite::MetadataT);
+    model_t->metadata.back()->name = tflite::kPrecomputedMemoryPlanMetadata;
+    model_t->metadata.back()->buffer = model_t->buffers.size();
+    model_t->buffers.push_back(std::move(buffer));
+  }
+
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::FinishModelBuffer(builder,
+                            tflite::Model::Pack(builder, model_t.get()));
+  return std::vector<uint8_t>(builder.GetBufferPointer(),
+                              builder.GetBufferPointer() + builder.GetSize());
+}
+
+bool WriteHeader(const char* path, const char* name, const char* model_path,
+                 const InterpreterOptions& options, const int32_t* offsets,
+                 int offset_count, size_t arena_size) {
+  FILE* file = fopen(path, "w");
+  if (file == nullptr) {
+    fprintf(stderr, "Couldn't open %s for writing\n", path);
+    return false;
+  }
+  fprintf(file,
+          "// Generated by tensorflow/lite/micro/tools/plan_memory.cc from\n"
+          "// %s with --max_batch_size=%d%s%s.\n"
+          "// Do not edit.\n"
+          "// Offsets of the planned buffers for a PrecomputedMemoryPlanner.\n"
+          "// The size is exact for a 16 bytes aligned tensor arena.\n\n"
+          "#pragma once\n\n"
+          "#include <stdint.h>\n\n"
+          "constexpr int %sBufferCount = %d;\n"
+          "constexpr int32_t %s[] = {",
+          model_path, options.max_batch_size,
+          options.bind_inputs_outputs ? " --bind_inputs_outputs" : "",
+          options.fuse_graph ? " --fuse_graph" : "", name, offset_count, name);
+  for (int i = 0; i < offset_count; ++i) {
+    fprintf(file, "%s%d", i % 8 == 0 ? "\n    " : " ", offsets[i]);
+    if (i + 1 < offset_count) {
+      fprintf(file, ",");
+    }
+  }
+  fprintf(file, "\n};\nconstexpr uint32_t %sArenaSize = %zu;\n", name,
+          arena_size);
+  fclose(file);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr,
+            "Usage: %s <model.tflite> [--output=<path>] [--header=<path>] "
+            "[--name=<name>] [--time_budget_ms=<ms>]\n",
+            argv[0]);
+    return 1;
+  }
+  const char* output_path = nullptr;
+  const char* header_path = nullptr;
+  const char* constant_name = "kMemoryPlan";
+  int32_t time_budget_ms = 10000;
+  InterpreterOptions options;
+  for (int i = 2; i < argc; ++i) {
+    if (const char* value = tflite::tools::FlagValue(argv[i], "output")) {
+      output_path = value;
+    } else if (const char* value =
+                   tflite::tools::FlagValue(argv[i], "header")) {
+      header_path = value;
+    } else if (const char* value = tflite::tools::FlagValue(argv[i], "name")) {
+      constant_name = value;
+    } else if (const char* value =
+                   tflite::tools::FlagValue(argv[i], "time_budget_ms")) {
+      time_budget_ms = atoi(value);
+    } else if (!tflite::tools::ParseInterpreterFlag(argv[i], &options)) {
+      fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  size_t model_size = 0;
+  uint8_t* model_data = tflite::tools::ReadModelFile(argv[1], &model_size);
+  if (model_data == nullptr) {
+    return 1;
+  }
+  const tflite::Model* model =
+      tflite::tools::VerifyModel(model_data, model_size);
+  if (model == nullptr) {
+    return 1;
+  }
+
+  static tflite::ops::micro::AllOpsResolver resolver;
+  tflite::MicroErrorReporter error_reporter;
+  uint8_t* arena = static_cast<uint8_t*>(aligned_alloc(16, kDryRunArenaSize));
+
+  // The baseline is the GreedyMemoryPlanner, even if the model already has a
+  // plan.
+  std::vector<uint8_t> greedy_scratch(
+      kMaxBufferCount * tflite::GreedyMemoryPlanner::per_buffer_size());
+  tflite::GreedyMemoryPlanner greedy_planner(greedy_scratch.data(),
+                                             greedy_scratch.size());
+  tflite::MicroArenaUsage greedy_usage;
+  if (Allocate(model, resolver, arena, kDryRunArenaSize, options,
+               &greedy_planner, &error_reporter,
+               &greedy_usage) != kTfLiteOk) {
+    fprintf(stderr, "AllocateTensors() failed even with %zu bytes\n",
+            kDryRunArenaSize);
+    return 1;
+  }
+
+  std::vector<uint8_t> scratch(
+      kMaxBufferCount * tflite::OptimalMemoryPlanner::per_buffer_size());
+  tflite::OptimalMemoryPlanner planner(scratch.data(), scratch.size(),
+                                       time_budget_ms, INT64_MAX);
+  tflite::MicroArenaUsage optimal_usage;
+  if (Allocate(model, resolver, arena, kDryRunArenaSize, options, &planner,
+               &error_reporter, &optimal_usage) != kTfLiteOk) {
+    fprintf(stderr, "AllocateTensors() failed with the OptimalMemoryPlanner\n");
+    return 1;
+  }
+  std::vector<int32_t> offsets(planner.GetBufferCount());
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    int offset = 0;
+    planner.GetOffsetForBuffer(&error_reporter, i, &offset);
+    offsets[i] = offset;
+  }
+
+  printf("Buffers: %zu\n", offsets.size());
+  printf("Greedy plan:  %zu bytes\n", greedy_usage.planned_bytes);
+  printf("Optimal plan: %zu bytes (%s after %lld placements)\n",
+         optimal_usage.planned_bytes,
+         planner.IsOptimal() ? "proven optimal" : "time budget exceeded",
+         static_cast<long long>(planner.search_steps()));
+  printf("Lower bound:  %d bytes\n", planner.GetLowerBound());
+
+  const size_t arena_size =
+      MinimumArenaSize(model, resolver, arena, options, offsets.data(),
+                       offsets.size());
+  if (arena_size == 0) {
+    fprintf(stderr, "The plan doesn't load\n");
+    return 1;
+  }
+  printf("Minimum tensor arena size with the plan: %zu bytes\n", arena_size);
+  if (header_path != nullptr &&
+      !WriteHeader(header_path, constant_name, argv[1], options,
+                   offsets.data(), offsets.size(), arena_size)) {
+    return 1;
+  }
+
+  if (output_path != nullptr) {
+    const std::vector<uint8_t> planned =
+        AddOfflinePlan(model, offsets.data(), offsets.size());
+    // Checked from a 16 bytes aligned copy, like the firmware reads it.
+    uint8_t* planned_data = static_cast<uint8_t*>(
+        aligned_alloc(16, (planned.size() + 15) & ~static_cast<size_t>(15)));
+    memcpy(planned_data, planned.data(), planned.size());
+    const tflite::Model* planned_model =
+        tflite::tools::VerifyModel(planned_data, planned.size());
+    if (planned_model == nullptr) {
+      return 1;
+    }
+    // A plan that doesn't match is silently replaced by the greedy one.
+    tflite::MicroArenaUsage planned_usage;
+    if (Allocate(planned_model, resolver, arena, kDryRunArenaSize, options,
+                 nullptr, &error_reporter, &planned_usage) != kTfLiteOk ||
+        planned_usage.planned_bytes != optimal_usage.planned_bytes) {
+      fprintf(stderr, "The plan stored in the model isn't used\n");
+      return 1;
+    }
+    const size_t planned_arena_size = MinimumArenaSize(
+        planned_model, resolver, arena, options, nullptr, 0);
+    if (planned_arena_size == 0) {
+      fprintf(stderr, "The plan stored in the model doesn't load\n");
+      return 1;
+    }
+    printf("Minimum tensor arena size with the plan in the model: %zu bytes\n",
+           planned_arena_size);
+    if (!tflite::tools::WriteFile(output_path, planned.data(),
+                                  planned.size())) {
+      return 1;
+    }
+    free(planned_data);
+  }
+
+  free(arena);
+  free(model_data);
+  return 0;
+}
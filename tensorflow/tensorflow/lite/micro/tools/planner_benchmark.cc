@@ -0,0 +1,144 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that compares the planning time of the GreedyMemoryPlanner and
+// the IntervalMemoryPlanner on synthetic graphs of growing size, and checks
+// that both give the same offsets.
+//
+// The graphs look like the activations of a deep network: buffer i is
+// created by operator i and read by the next few operators, and some buffers
+// are kept alive for a long stretch like skip connections.
+//
+// Build it like tensorflow/lite/micro/tools/arena_size.cc, with
+// planner_benchmark.cc instead of arena_size.cc.
+//
+// Usage:
+//   planner_benchmark [--max_buffers=<n>] [--seed=<n>]
+//
+// --max_buffers is the size of the largest graph, 10000 by default. The
+// sizes double from 100 up to it.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/interval_memory_planner.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/tools/model_file.h"
+
+namespace {
+
+struct Buffer {
+  int size;
+  int first_time_used;
+  int last_time_used;
+};
+
+// A small deterministic generator, so runs are comparable across hosts.
+uint32_t NextRandom(uint32_t* state) {
+  *state = *state * 1664525u + 1013904223u;
+  return *state >> 8;
+}
+
+std::vector<Buffer> MakeGraph(int buffer_count, uint32_t seed) {
+  std::vector<Buffer> buffers(buffer_count);
+  uint32_t state = seed;
+  for (int i = 0; i < buffer_count; ++i) {
+    Buffer& buffer = buffers[i];
+    buffer.size = 16 * (1 + NextRandom(&state) % 1024);
+    buffer.first_time_used = i;
+    int lifetime = 1 + NextRandom(&state) % 3;
+    if (NextRandom(&state) % 20 == 0) {
+      lifetime += NextRandom(&state) % 50;
+    }
+    buffer.last_time_used = i + lifetime;
+  }
+  return buffers;
+}
+
+// Plans `buffers` with `planner` and returns the time in microseconds.
+double Plan(const std::vector<Buffer>& buffers, tflite::MemoryPlanner* planner,
+            std::vector<int>* offsets, size_t* arena_size) {
+  tflite::MicroErrorReporter error_reporter;
+  const auto start = std::chrono::steady_clock::now();
+  for (const Buffer& buffer : buffers) {
+    if (planner->AddBuffer(&error_reporter, buffer.size,
+                           buffer.first_time_used,
+                           buffer.last_time_used) != kTfLiteOk) {
+      return -1.0;
+    }
+  }
+  *arena_size = planner->GetMaximumMemorySize();
+  const auto end = std::chrono::steady_clock::now();
+  offsets->resize(buffers.size());
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    planner->GetOffsetForBuffer(&error_reporter, i, &(*offsets)[i]);
+  }
+  return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int max_buffers = 10000;
+  uint32_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (const char* value = tflite::tools::FlagValue(argv[i], "max_buffers")) {
+      max_buffers = atoi(value);
+    } else if (const char* value = tflite::tools::FlagValue(argv[i], "seed")) {
+      seed = strtoul(value, nullptr, 10);
+    } else {
+      fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  printf("%8s %14s %14s %12s %12s\n", "buffers", "greedy (us)", "interval (us)",
+         "greedy size", "interval size");
+  bool all_equal = true;
+  for (int count = 100; count <= max_buffers; count *= 2) {
+    const std::vector<Buffer> buffers = MakeGraph(count, seed);
+
+    std::vector<unsigned char> greedy_scratch(
+        count * tflite::GreedyMemoryPlanner::per_buffer_size());
+    tflite::GreedyMemoryPlanner greedy(greedy_scratch.data(),
+                                       greedy_scratch.size());
+    std::vector<int> greedy_offsets;
+    size_t greedy_size = 0;
+    const double greedy_time =
+        Plan(buffers, &greedy, &greedy_offsets, &greedy_size);
+
+    std::vector<unsigned char> interval_scratch(
+        count * tflite::IntervalMemoryPlanner::per_buffer_size());
+    tflite::IntervalMemoryPlanner interval(interval_scratch.data(),
+                                           interval_scratch.size());
+    std::vector<int> interval_offsets;
+    size_t interval_size = 0;
+    const double interval_time =
+        Plan(buffers, &interval, &interval_offsets, &interval_size);
+
+    printf("%8d %14.0f %14.0f %12zu %12zu\n", count, greedy_time,
+           interval_time, greedy_size, interval_size);
+    if (greedy_time < 0.0 || interval_time < 0.0 ||
+        greedy_offsets != interval_offsets) {
+      fprintf(stderr, "The plans differ for %d buffers\n", count);
+      all_equal = false;
+    }
+  }
+  return all_equal ? 0 : 1;
+}
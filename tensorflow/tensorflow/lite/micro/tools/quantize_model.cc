@@ -0,0 +1,486 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that converts a float model made of FULLY_CONNECTED operators,
+// such as the sine model, to a full int8 model, so the int8 kernels can be
+// run and benchmarked without the TensorFlow converter.
+//
+// It follows the TensorFlow Lite int8 quantization spec with per-tensor
+// parameters, which is what the micro FULLY_CONNECTED kernel supports:
+// weights are symmetric int8, biases int32 with the product of the input and
+// weight scales, and activations asymmetric int8 with ranges calibrated by
+// running the float model on inputs evenly spread over
+// [input_min, input_max]. The model has a single input, which is expected to
+// have one value per inference.
+//
+// The quantized model is compared with the float one over the same inputs,
+// and can be written as a .tflite file and as C++ source for the firmware.
+//
+// Build it like arena_size.cc, with quantize_model.cc in place of
+// arena_size.cc. Usage:
+//   quantize_model <model.tflite> --input_min=<value> --input_max=<value>
+//       [--samples=<n>] [--output=<int8.tflite>]
+//       [--header=<path.h> --source=<path.cpp> --name=<array name>]
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/micro/kernels/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_profiler.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+#include "tensorflow/lite/micro/tools/model_file.h"
+
+namespace {
+
+constexpr size_t kArenaSize = 1024 * 1024;
+alignas(16) uint8_t float_arena[kArenaSize];
+alignas(16) uint8_t int8_arena[kArenaSize];
+
+// The FULLY_CONNECTED version that handles int8.
+constexpr int kInt8FullyConnectedVersion = 4;
+
+struct Range {
+  float min = 0.0f;
+  float max = 0.0f;
+  bool seen = false;
+};
+
+// Records the range of every output right after its node ran. The memory
+// planner reuses buffers, so an intermediate tensor is only valid until
+// later nodes run.
+class CalibrationProfiler : public tflite::MicroProfiler {
+ public:
+  CalibrationProfiler(tflite::MicroInterpreter* interpreter,
+                      std::vector<Range>* ranges)
+      : interpreter_(interpreter), ranges_(ranges) {}
+
+  uint32_t BeginEvent(const char* tag, int node_index) override {
+    return node_index;
+  }
+
+  void EndEvent(uint32_t event_handle) override {
+    const TfLiteNode& node =
+        interpreter_->node_and_registration(event_handle).node;
+    for (int i = 0; i < node.outputs->size; ++i) {
+      Record(node.outputs->data[i]);
+    }
+  }
+
+  void Record(int tensor_index) {
+    const TfLiteTensor* tensor = interpreter_->tensor(tensor_index);
+    Range* range = &(*ranges_)[tensor_index];
+    const int count = tflite::ElementCount(*tensor->dims);
+    for (int i = 0; i < count; ++i) {
+      const float value = tensor->data.f[i];
+      if (!range->seen || value < range->min) {
+        range->min = value;
+      }
+      if (!range->seen || value > range->max) {
+        range->max = value;
+      }
+      range->seen = true;
+    }
+  }
+
+ private:
+  tflite::MicroInterpreter* interpreter_;
+  std::vector<Range>* ranges_;
+};
+
+float SampleInput(int sample, int samples, float input_min, float input_max) {
+  if (samples == 1) {
+    return input_min;
+  }
+  return input_min + (input_max - input_min) * sample / (samples - 1);
+}
+
+bool CheckModel(const tflite::ModelT& model) {
+  if (model.subgraphs.size() != 1) {
+    fprintf(stderr, "Only models with a single subgraph are supported\n");
+    return false;
+  }
+  const tflite::SubGraphT& subgraph = *model.subgraphs[0];
+  if (subgraph.inputs.size() != 1) {
+    fprintf(stderr, "Only models with a single input are supported\n");
+    return false;
+  }
+  for (const auto& tensor : subgraph.tensors) {
+    if (tensor->type != tflite::TensorType_FLOAT32) {
+      fprintf(stderr, "Tensor %s is not float32\n", tensor->name.c_str());
+      return false;
+    }
+  }
+  std::vector<int> buffer_users(model.buffers.size(), 0);
+  for (const auto& tensor : subgraph.tensors) {
+    if (tensor->buffer != 0) {
+      ++buffer_users[tensor->buffer];
+    }
+  }
+  for (size_t i = 0; i < subgraph.operators.size(); ++i) {
+    const tflite::OperatorT& op = *subgraph.operators[i];
+    const tflite::BuiltinOperator code =
+        model.operator_codes[op.opcode_index]->builtin_code;
+    if (code != tflite::BuiltinOperator_FULLY_CONNECTED) {
+      fprintf(stderr, "Node %zu: %s is not supported\n", i,
+              tflite::EnumNameBuiltinOperator(code));
+      return false;
+    }
+    for (size_t n = 1; n < op.inputs.size(); ++n) {
+      if (op.inputs[n] < 0) {
+        continue;
+      }
+      const int buffer = subgraph.tensors[op.inputs[n]]->buffer;
+      if (buffer == 0 || buffer_users[buffer] != 1) {
+        fprintf(stderr,
+                "Node %zu: weights and bias must be constants used once\n", i);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Runs the float model on all samples and returns the range of every tensor.
+bool Calibrate(const tflite::Model* model, const tflite::OpResolver& resolver,
+               int samples, float input_min, float input_max,
+               std::vector<Range>* ranges) {
+  tflite::MicroErrorReporter error_reporter;
+  tflite::MicroInterpreter interpreter(model, resolver, float_arena,
+                                       kArenaSize, &error_reporter);
+  if (interpreter.AllocateTensors() != kTfLiteOk) {
+    return false;
+  }
+  ranges->assign(interpreter.tensors_size(), Range());
+  CalibrationProfiler profiler(&interpreter, ranges);
+  interpreter.set_profiler(&profiler);
+  const int input_index = interpreter.inputs().Get(0);
+  for (int i = 0; i < samples; ++i) {
+    interpreter.input(0)->data.f[0] =
+        SampleInput(i, samples, input_min, input_max);
+    profiler.Record(input_index);
+    if (interpreter.Invoke() != kTfLiteOk) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::unique_ptr<tflite::QuantizationParametersT> QuantizationParameters(
+    float scale, int64_t zero_point) {
+  std::unique_ptr<tflite::QuantizationParametersT> params(
+      new tflite::QuantizationParametersT());
+  params->scale.push_back(scale);
+  params->zero_point.push_back(zero_point);
+  return params;
+}
+
+int32_t RoundAndClamp(double value, int32_t min, int32_t max) {
+  const double rounded = std::round(value);
+  if (rounded < min) {
+    return min;
+  }
+  if (rounded > max) {
+    return max;
+  }
+  return static_cast<int32_t>(rounded);
+}
+
+// Asymmetric int8 parameters for a calibrated range, which must contain 0
+// so that zero padding and ReLU are exact.
+void QuantizeActivation(const Range& range, tflite::TensorT* tensor) {
+  const float min = range.min < 0.0f ? range.min : 0.0f;
+  const float max = range.max > 0.0f ? range.max : 0.0f;
+  float scale = (max - min) / 255.0f;
+  if (scale == 0.0f) {
+    scale = 1.0f;
+  }
+  const int32_t zero_point = RoundAndClamp(-128.0 - min / scale, -128, 127);
+  tensor->type = tflite::TensorType_INT8;
+  tensor->quantization = QuantizationParameters(scale, zero_point);
+}
+
+// Replaces float values in `buffer` by symmetric int8 values and returns the
+// scale.
+float QuantizeWeights(tflite::BufferT* buffer, tflite::TensorT* tensor) {
+  const float* values = reinterpret_cast<const float*>(buffer->data.data());
+  const size_t count = buffer->data.size() / sizeof(float);
+  float max_abs = 0.0f;
+  for (size_t i = 0; i < count; ++i) {
+    max_abs = std::fmax(max_abs, std::fabs(values[i]));
+  }
+  const float scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+  std::vector<uint8_t> data(count);
+  for (size_t i = 0; i < count; ++i) {
+    data[i] = static_cast<uint8_t>(
+        static_cast<int8_t>(RoundAndClamp(values[i] / scale, -127, 127)));
+  }
+  buffer->data = data;
+  tensor->type = tflite::TensorType_INT8;
+  tensor->quantization = QuantizationParameters(scale, 0);
+  return scale;
+}
+
+void QuantizeBias(float scale, tflite::BufferT* buffer,
+                  tflite::TensorT* tensor) {
+  const float* values = reinterpret_cast<const float*>(buffer->data.data());
+  const size_t count = buffer->data.size() / sizeof(float);
+  std::vector<uint8_t> data(count * sizeof(int32_t));
+  for (size_t i = 0; i < count; ++i) {
+    const int32_t value =
+        RoundAndClamp(static_cast<double>(values[i]) / scale, INT32_MIN,
+                      INT32_MAX);
+    memcpy(&data[i * sizeof(int32_t)], &value, sizeof(value));
+  }
+  buffer->data = data;
+  tensor->type = tflite::TensorType_INT32;
+  tensor->quantization = QuantizationParameters(scale, 0);
+}
+
+void Quantize(const std::vector<Range>& ranges, tflite::ModelT* model) {
+  tflite::SubGraphT* subgraph = model->subgraphs[0].get();
+  std::vector<bool> is_constant(subgraph->tensors.size(), false);
+  for (const auto& op : subgraph->operators) {
+    for (size_t n = 1; n < op->inputs.size(); ++n) {
+      if (op->inputs[n] >= 0) {
+        is_constant[op->inputs[n]] = true;
+      }
+    }
+  }
+  for (size_t i = 0; i < subgraph->tensors.size(); ++i) {
+    if (!is_constant[i]) {
+      QuantizeActivation(ranges[i], subgraph->tensors[i].get());
+    }
+  }
+  for (const auto& op : subgraph->operators) {
+    tflite::TensorT* input = subgraph->tensors[op->inputs[0]].get();
+    tflite::TensorT* weights = subgraph->tensors[op->inputs[1]].get();
+    const float weights_scale =
+        QuantizeWeights(model->buffers[weights->buffer].get(), weights);
+    if (op->inputs.size() > 2 && op->inputs[2] >= 0) {
+      tflite::TensorT* bias = subgraph->tensors[op->inputs[2]].get();
+      QuantizeBias(input->quantization->scale[0] * weights_scale,
+                   model->buffers[bias->buffer].get(), bias);
+    }
+  }
+  for (auto& opcode : model->operator_codes) {
+    if (opcode->version < kInt8FullyConnectedVersion) {
+      opcode->version = kInt8FullyConnectedVersion;
+    }
+  }
+  model->description = "Quantized to int8 by quantize_model.cc";
+}
+
+// Runs both models on all samples and prints how far apart they are.
+bool Compare(const tflite::Model* float_model, const tflite::Model* int8_model,
+             const tflite::OpResolver& resolver, int samples,
+             float input_min, float input_max) {
+  tflite::MicroErrorReporter error_reporter;
+  tflite::MicroInterpreter float_interpreter(float_model, resolver,
+                                             float_arena, kArenaSize,
+                                             &error_reporter);
+  tflite::MicroInterpreter int8_interpreter(int8_model, resolver, int8_arena,
+                                            kArenaSize, &error_reporter);
+  if (float_interpreter.AllocateTensors() != kTfLiteOk ||
+      int8_interpreter.AllocateTensors() != kTfLiteOk) {
+    return false;
+  }
+  TfLiteTensor* input = int8_interpreter.input(0);
+  TfLiteTensor* output = int8_interpreter.output(0);
+  const int output_count = tflite::ElementCount(*output->dims);
+  float max_error = 0.0f;
+  double total_error = 0.0;
+  for (int i = 0; i < samples; ++i) {
+    const float x = SampleInput(i, samples, input_min, input_max);
+    float_interpreter.input(0)->data.f[0] = x;
+    input->data.int8[0] = static_cast<int8_t>(RoundAndClamp(
+        x / input->params.scale + input->params.zero_point, -128, 127));
+    if (float_interpreter.Invoke() != kTfLiteOk ||
+        int8_interpreter.Invoke() != kTfLiteOk) {
+      return false;
+    }
+    for (int n = 0; n < output_count; ++n) {
+      const float y = (output->data.int8[n] - output->params.zero_point) *
+                      output->params.scale;
+      const float error =
+          std::fabs(y - float_interpreter.output(0)->data.f[n]);
+      max_error = std::fmax(max_error, error);
+      total_error += error;
+    }
+  }
+  printf("Input: scale %g, zero point %d\n", input->params.scale,
+         input->params.zero_point);
+  printf("Output: scale %g, zero point %d\n", output->params.scale,
+         output->params.zero_point);
+  printf("Difference to the float model over %d inputs: max %g, mean %g\n",
+         samples, max_error, total_error / (samples * output_count));
+  return true;
+}
+
+// Writes the model as a C array in the same form as
+// tensorflow.lite.util.convert_bytes_to_c_source().
+bool WriteSource(const char* header_path, const char* source_path,
+                 const char* name, const char* model_path,
+                 const uint8_t* data, size_t size) {
+  FILE* header = fopen(header_path, "w");
+  if (header == nullptr) {
+    fprintf(stderr, "Couldn't open %s for writing\n", header_path);
+    return false;
+  }
+  fprintf(header,
+          "// Generated by tensorflow/lite/micro/tools/quantize_model.cc from\n"
+          "// %s. Do not edit.\n\n"
+          "#pragma once\n\n"
+          "extern const unsigned char %s[];\n"
+          "extern const int %s_len;\n",
+          model_path, name, name);
+  fclose(header);
+
+  FILE* source = fopen(source_path, "w");
+  if (source == nullptr) {
+    fprintf(stderr, "Couldn't open %s for writing\n", source_path);
+    return false;
+  }
+  const char* header_name = strrchr(header_path, '/');
+  header_name = header_name == nullptr ? header_path : header_name + 1;
+  fprintf(source,
+          "// Generated by tensorflow/lite/micro/tools/quantize_model.cc from\n"
+          "// %s. Do not edit.\n\n"
+          "#include \"%s\"\n\n"
+          "// The flatbuffer is read in place, so the array is aligned like "
+          "the\n"
+          "// tensor arena.\n"
+          "alignas(16) const unsigned char %s[] = {",
+          model_path, header_name, name);
+  for (size_t i = 0; i < size; ++i) {
+    fprintf(source, "%s0x%02x,", i % 12 == 0 ? "\n    " : " ", data[i]);
+  }
+  fprintf(source, "\n};\nconst int %s_len = %zu;\n", name, size);
+  fclose(source);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr,
+            "Usage: %s <model.tflite> --input_min=<value> "
+            "--input_max=<value> [--samples=<n>] [--output=<path>] "
+            "[--header=<path> --source=<path> --name=<name>]\n",
+            argv[0]);
+    return 1;
+  }
+  const char* input_min_flag = nullptr;
+  const char* input_max_flag = nullptr;
+  const char* output_path = nullptr;
+  const char* header_path = nullptr;
+  const char* source_path = nullptr;
+  const char* array_name = "model_int8";
+  int samples = 1000;
+  for (int i = 2; i < argc; ++i) {
+    if (const char* value = tflite::tools::FlagValue(argv[i], "input_min")) {
+      input_min_flag = value;
+    } else if (const char* value =
+                   tflite::tools::FlagValue(argv[i], "input_max")) {
+      input_max_flag = value;
+    } else if (const char* value =
+                   tflite::tools::FlagValue(argv[i], "samples")) {
+      samples = atoi(value);
+    } else if (const char* value =
+                   tflite::tools::FlagValue(argv[i], "output")) {
+      output_path = value;
+    } else if (const char* value =
+                   tflite::tools::FlagValue(argv[i], "header")) {
+      header_path = value;
+    } else if (const char* value =
+                   tflite::tools::FlagValue(argv[i], "source")) {
+      source_path = value;
+    } else if (const char* value = tflite::tools::FlagValue(argv[i], "name")) {
+      array_name = value;
+    } else {
+      fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+  if (input_min_flag == nullptr || input_max_flag == nullptr ||
+      samples < 1 || ((header_path == nullptr) != (source_path == nullptr))) {
+    fprintf(stderr,
+            "--input_min and --input_max are required, --samples must be "
+            "positive and --header and --source go together\n");
+    return 1;
+  }
+  const float input_min = atof(input_min_flag);
+  const float input_max = atof(input_max_flag);
+
+  size_t model_size = 0;
+  uint8_t* model_data = tflite::tools::ReadModelFile(argv[1], &model_size);
+  if (model_data == nullptr) {
+    return 1;
+  }
+  const tflite::Model* float_model =
+      tflite::tools::VerifyModel(model_data, model_size);
+  if (float_model == nullptr) {
+    return 1;
+  }
+  std::unique_ptr<tflite::ModelT> model(float_model->UnPack());
+  if (!CheckModel(*model)) {
+    return 1;
+  }
+
+  static tflite::ops::micro::AllOpsResolver resolver;
+  std::vector<Range> ranges;
+  if (!Calibrate(float_model, resolver, samples, input_min, input_max,
+                 &ranges)) {
+    fprintf(stderr, "Running the float model failed\n");
+    return 1;
+  }
+  Quantize(ranges, model.get());
+
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::FinishModelBuffer(builder,
+                            tflite::Model::Pack(builder, model.get()));
+  // The builder's buffer isn't aligned, the interpreter needs it to be.
+  const size_t int8_size = builder.GetSize();
+  uint8_t* int8_data = static_cast<uint8_t*>(aligned_alloc(16, int8_size + 16));
+  memcpy(int8_data, builder.GetBufferPointer(), int8_size);
+  const tflite::Model* int8_model =
+      tflite::tools::VerifyModel(int8_data, int8_size);
+  if (int8_model == nullptr ||
+      !Compare(float_model, int8_model, resolver, samples, input_min,
+               input_max)) {
+    fprintf(stderr, "Running the int8 model failed\n");
+    return 1;
+  }
+
+  if (output_path != nullptr &&
+      !tflite::tools::WriteFile(output_path, int8_data, int8_size)) {
+    return 1;
+  }
+  if (header_path != nullptr &&
+      !WriteSource(header_path, source_path, array_name, argv[1], int8_data,
+                   int8_size)) {
+    return 1;
+  }
+  free(int8_data);
+  free(model_data);
+  return 0;
+}
@@ -0,0 +1,226 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that compares the time per row of reference_ops::Softmax() and
+// of the quantized softmax with an exp table that the micro SOFTMAX kernel
+// calls, and checks that both give the same outputs. After the timed int8 rows
+// it checks --cases more random betas, input scales and shapes, each for
+// int8 to int8, int8 to int16 and uint8 to uint8.
+//
+// Build it like tensorflow/lite/micro/tools/arena_size.cc, with
+// softmax_benchmark.cc instead of arena_size.cc. With -msse4.1 or -mavx2,
+// plus -DTF_LITE_DISABLE_X86_NEON for the headers that would otherwise need
+// NEON_2_SSE.h, it checks the x86 code paths.
+//
+// Usage:
+//   softmax_benchmark [--cases=<n>] [--seed=<n>]
+//
+// --cases is 1000 by default.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/softmax.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/softmax.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/tools/model_file.h"
+
+namespace {
+
+constexpr int kDepths[] = {10, 100, 1000, 4000};
+
+// The micro SOFTMAX kernel uses the same number of integer bits.
+constexpr int kScaledDiffIntegerBits = 5;
+
+// Each measurement repeats the kernel for at least this long.
+constexpr double kMinMeasureUs = 50000.0;
+
+// A small deterministic generator, so runs are comparable across hosts.
+uint32_t NextRandom(uint32_t* state) {
+  *state = *state * 1664525u + 1013904223u;
+  return *state >> 8;
+}
+
+int RandomInt(uint32_t* state, int min, int max) {
+  return min + static_cast<int>(NextRandom(state) % (max - min + 1));
+}
+
+// Calls `run` until kMinMeasureUs have passed and returns the microseconds
+// per call.
+template <typename F>
+double Measure(F run) {
+  int calls = 0;
+  const auto start = std::chrono::steady_clock::now();
+  double elapsed_us = 0.0;
+  do {
+    run();
+    ++calls;
+    elapsed_us = std::chrono::duration<double, std::micro>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  } while (elapsed_us < kMinMeasureUs);
+  return elapsed_us / calls;
+}
+
+// The parameters and the exp table the way the micro SOFTMAX kernel computes
+// them in Prepare().
+struct SoftmaxData {
+  SoftmaxData(double beta, double input_scale) {
+    int input_left_shift;
+    tflite::PreprocessSoftmaxScaling(beta, input_scale, kScaledDiffIntegerBits,
+                                     &params.input_multiplier,
+                                     &input_left_shift);
+    params.input_left_shift = input_left_shift;
+    params.diff_min = -1.0 * tflite::CalculateInputRadius(
+                                 kScaledDiffIntegerBits, input_left_shift);
+    tflite::optimized_integer_ops::PopulateSoftmaxExpTable(params, exp_table);
+  }
+
+  tflite::SoftmaxParams params;
+  int32_t exp_table[tflite::optimized_integer_ops::kSoftmaxExpTableSize];
+};
+
+// Returns false for the rows where the sum of the exps is too large for the
+// reference kernel, which then fails a TFLITE_DCHECK instead of giving an
+// output to compare with.
+template <typename InputT, typename OutputT>
+bool ReferenceHandlesRows(const SoftmaxData& data, const InputT* input,
+                          int rows, int depth) {
+  namespace internal = tflite::optimized_integer_ops::softmax_internal;
+  for (int row = 0; row < rows; ++row) {
+    const InputT* row_input = input + row * depth;
+    const InputT max_in_row = internal::MaxInRow(row_input, depth);
+    const int32_t sum_of_exps =
+        internal::SumOfExps(data.exp_table, max_in_row, row_input, depth);
+    int num_bits_over_unit;
+    tflite::GetReciprocal(sum_of_exps, 12, &num_bits_over_unit);
+    if (num_bits_over_unit + 31 - static_cast<int>(sizeof(OutputT) * 8) >
+        31) {
+      return false;
+    }
+  }
+  return true;
+}
+
+enum class CheckResult { kEqual, kDifferent, kSkipped };
+
+// Checks rows x depth random inputs that are at most `spread` below the
+// largest input value, so the rows range from nearly one-hot to flat.
+template <typename InputT, typename OutputT>
+CheckResult CheckRandomRows(uint32_t* state, const SoftmaxData& data,
+                            int rows, int depth, int spread) {
+  const int max_input = std::numeric_limits<InputT>::max();
+  std::vector<InputT> input(rows * depth);
+  for (InputT& value : input) {
+    value = static_cast<InputT>(max_input - RandomInt(state, 0, spread));
+  }
+  if (!ReferenceHandlesRows<InputT, OutputT>(data, input.data(), rows,
+                                             depth)) {
+    return CheckResult::kSkipped;
+  }
+
+  const tflite::RuntimeShape shape({rows, depth});
+  std::vector<OutputT> reference_output(rows * depth);
+  std::vector<OutputT> optimized_output(rows * depth);
+  tflite::reference_ops::Softmax(data.params, shape, input.data(), shape,
+                                 reference_output.data());
+  tflite::optimized_integer_ops::Softmax(data.params, data.exp_table, shape,
+                                         input.data(), shape,
+                                         optimized_output.data());
+  return memcmp(reference_output.data(), optimized_output.data(),
+                reference_output.size() * sizeof(OutputT)) == 0
+             ? CheckResult::kEqual
+             : CheckResult::kDifferent;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int cases = 1000;
+  uint32_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (const char* value = tflite::tools::FlagValue(argv[i], "cases")) {
+      cases = atoi(value);
+    } else if (const char* value = tflite::tools::FlagValue(argv[i], "seed")) {
+      seed = strtoul(value, nullptr, 10);
+    } else {
+      fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  printf("%12s %16s %16s %8s\n", "depth", "reference (us)", "table (us)",
+         "speedup");
+  uint32_t state = seed;
+  const SoftmaxData timed_data(/*beta=*/1.0, /*input_scale=*/0.1);
+  for (int depth : kDepths) {
+    std::vector<int8_t> input(depth);
+    for (int8_t& value : input) value = RandomInt(&state, -128, 127);
+    std::vector<int8_t> output(depth);
+    const tflite::RuntimeShape shape({1, depth});
+    const double reference_us = Measure([&]() {
+      tflite::reference_ops::Softmax(timed_data.params, shape, input.data(),
+                                     shape, output.data());
+    });
+    const double table_us = Measure([&]() {
+      tflite::optimized_integer_ops::Softmax(timed_data.params,
+                                             timed_data.exp_table, shape,
+                                             input.data(), shape,
+                                             output.data());
+    });
+    printf("%12d %16.3f %16.3f %7.2fx\n", depth, reference_us, table_us,
+           reference_us / table_us);
+  }
+
+  int checked = 0;
+  int skipped = 0;
+  int mismatches = 0;
+  for (int i = 0; i < cases; ++i) {
+    const double beta = RandomInt(&state, 10, 1000) / 100.0;
+    const double input_scale = RandomInt(&state, 1, 1000) / 2000.0;
+    const SoftmaxData data(beta, input_scale);
+    const int rows = RandomInt(&state, 1, 3);
+    const int depth = RandomInt(&state, 1, 1200);
+    const int spread = RandomInt(&state, 0, 255);
+    const CheckResult results[] = {
+        CheckRandomRows<int8_t, int8_t>(&state, data, rows, depth, spread),
+        CheckRandomRows<int8_t, int16_t>(&state, data, rows, depth, spread),
+        CheckRandomRows<uint8_t, uint8_t>(&state, data, rows, depth, spread),
+    };
+    for (CheckResult result : results) {
+      if (result == CheckResult::kSkipped) {
+        ++skipped;
+        continue;
+      }
+      ++checked;
+      if (result == CheckResult::kDifferent) {
+        fprintf(stderr,
+                "The outputs differ for beta %g, input scale %g, %d rows of "
+                "%d\n",
+                beta, input_scale, rows, depth);
+        ++mismatches;
+      }
+    }
+  }
+  printf("%d random softmaxes, %d with different outputs, %d skipped\n",
+         checked, mismatches, skipped);
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,647 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that compares the micro SVDF kernel, which keeps its activation
+// state as a ring buffer, with the SVDF that shifts the whole state left by
+// one column on every invoke, as TFLite does. It times both for the float and
+// the int8 versions of a few layers, then checks --cases more layers of
+// random shapes, weights and quantization. Each layer runs for a few times
+// its memory size, so the ring wraps around, and the outputs of every invoke
+// must be equal bit for bit. The states themselves aren't compared, their
+// columns are in a different order. The ring times include the kernel's
+// tensor lookups, and copying the state is cheap on a host, so the speedups
+// are only a rough guide for a microcontroller.
+//
+// Build it like tensorflow/lite/micro/tools/arena_size.cc, with
+// svdf_benchmark.cc instead of arena_size.cc.
+//
+// Usage:
+//   svdf_benchmark [--cases=<n>] [--seed=<n>]
+//
+// --cases is 1000 by default.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/micro/kernels/activation_utils.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/tools/model_file.h"
+
+namespace {
+
+struct Layer {
+  int batches;
+  int input_size;
+  int num_units;
+  int rank;
+  int memory_size;
+};
+
+// Layers like the SVDF layers of a keyword spotting model.
+constexpr Layer kLayers[] = {
+    {1, 40, 64, 1, 8},
+    {1, 64, 128, 1, 32},
+    {1, 32, 32, 2, 64},
+};
+
+// Each measurement repeats the kernel for at least this long.
+constexpr double kMinMeasureUs = 50000.0;
+
+// A small deterministic generator, so runs are comparable across hosts.
+uint32_t NextRandom(uint32_t* state) {
+  *state = *state * 1664525u + 1013904223u;
+  return *state >> 8;
+}
+
+int RandomInt(uint32_t* state, int min, int max) {
+  return min + static_cast<int>(NextRandom(state) % (max - min + 1));
+}
+
+float RandomFloat(uint32_t* state, float min, float max) {
+  return min + (max - min) * (NextRandom(state) % 10001) / 10000.f;
+}
+
+// Calls `run` until kMinMeasureUs have passed and returns the microseconds
+// per call.
+template <typename F>
+double Measure(F run) {
+  int calls = 0;
+  const auto start = std::chrono::steady_clock::now();
+  double elapsed_us = 0.0;
+  do {
+    run();
+    ++calls;
+    elapsed_us = std::chrono::duration<double, std::micro>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  } while (elapsed_us < kMinMeasureUs);
+  return elapsed_us / calls;
+}
+
+// The tensor types of the float and the int8 SVDF.
+template <typename InputT>
+struct SvdfTypes;
+
+template <>
+struct SvdfTypes<float> {
+  using WeightsTimeT = float;
+  using BiasT = float;
+  using StateT = float;
+  static constexpr TfLiteType kInputType = kTfLiteFloat32;
+  static constexpr TfLiteType kWeightsTimeType = kTfLiteFloat32;
+  static constexpr TfLiteType kBiasType = kTfLiteFloat32;
+  static constexpr TfLiteType kStateType = kTfLiteFloat32;
+};
+
+template <>
+struct SvdfTypes<int8_t> {
+  using WeightsTimeT = int16_t;
+  using BiasT = int32_t;
+  using StateT = int16_t;
+  static constexpr TfLiteType kInputType = kTfLiteInt8;
+  static constexpr TfLiteType kWeightsTimeType = kTfLiteInt16;
+  static constexpr TfLiteType kBiasType = kTfLiteInt32;
+  static constexpr TfLiteType kStateType = kTfLiteInt16;
+};
+
+// The scales and zero points of the int8 SVDF. The weights and the state are
+// symmetric.
+struct Quantization {
+  float input_scale = 0.f;
+  float weights_feature_scale = 0.f;
+  float weights_time_scale = 0.f;
+  float state_scale = 0.f;
+  float output_scale = 0.f;
+  int input_zero_point = 0;
+  int output_zero_point = 0;
+};
+
+TfLiteStatus AllocatePersistentBuffer(TfLiteContext* context, size_t bytes,
+                                      void** ptr);
+TfLiteStatus RequestScratchBufferInArena(TfLiteContext* context, size_t bytes,
+                                         int* buffer_idx);
+void* GetScratchBuffer(TfLiteContext* context, int buffer_idx);
+void ReportError(TfLiteContext* context, const char* format, ...);
+
+// One SVDF layer with random data, run both through the micro kernel's
+// registration and through the shifting implementation below.
+template <typename InputT>
+class SvdfLayer {
+ public:
+  using Types = SvdfTypes<InputT>;
+  using WeightsTimeT = typename Types::WeightsTimeT;
+  using BiasT = typename Types::BiasT;
+  using StateT = typename Types::StateT;
+
+  SvdfLayer(uint32_t* state, const Layer& layer, bool has_bias,
+            TfLiteFusedActivation activation,
+            const Quantization& quantization)
+      : layer_(layer),
+        num_filters_(layer.num_units * layer.rank),
+        quantization_(quantization),
+        input_(layer.batches * layer.input_size),
+        weights_feature_(num_filters_ * layer.input_size),
+        weights_time_(num_filters_ * layer.memory_size),
+        bias_(has_bias ? layer.num_units : 0),
+        kernel_state_(layer.batches * layer.memory_size * num_filters_),
+        shifting_state_(kernel_state_.size()),
+        kernel_output_(layer.batches * layer.num_units),
+        shifting_output_(kernel_output_.size()) {
+    FillWeights(state);
+    params_.rank = layer.rank;
+    params_.activation = activation;
+
+    memset(tensors_, 0, sizeof(tensors_));
+    SetTensor(0, Types::kInputType, {layer.batches, layer.input_size},
+              input_.data(), sizeof(InputT), quantization.input_scale,
+              quantization.input_zero_point);
+    SetTensor(1, Types::kInputType, {num_filters_, layer.input_size},
+              weights_feature_.data(), sizeof(InputT),
+              quantization.weights_feature_scale, 0);
+    SetTensor(2, Types::kWeightsTimeType, {num_filters_, layer.memory_size},
+              weights_time_.data(), sizeof(WeightsTimeT),
+              quantization.weights_time_scale, 0);
+    SetTensor(3, Types::kBiasType, {layer.num_units}, bias_.data(),
+              sizeof(BiasT),
+              quantization.input_scale * quantization.weights_feature_scale,
+              0);
+    SetTensor(4, Types::kStateType,
+              {layer.batches, layer.memory_size * num_filters_},
+              kernel_state_.data(), sizeof(StateT), quantization.state_scale,
+              0);
+    tensors_[4].is_variable = true;
+    SetTensor(5, Types::kInputType, {layer.batches, layer.num_units},
+              kernel_output_.data(), sizeof(InputT), quantization.output_scale,
+              quantization.output_zero_point);
+
+    memset(&context_, 0, sizeof(context_));
+    context_.impl_ = this;
+    context_.tensors = tensors_;
+    context_.tensors_size = kTensorCount;
+    context_.AllocatePersistentBuffer = AllocatePersistentBuffer;
+    context_.RequestScratchBufferInArena = RequestScratchBufferInArena;
+    context_.GetScratchBuffer = GetScratchBuffer;
+    context_.ReportError = ReportError;
+
+    inputs_ = TfLiteIntArrayCreate(5);
+    inputs_->data[0] = 0;
+    inputs_->data[1] = 1;
+    inputs_->data[2] = 2;
+    inputs_->data[3] = has_bias ? 3 : kTfLiteOptionalTensor;
+    inputs_->data[4] = 4;
+    outputs_ = TfLiteIntArrayCreate(1);
+    outputs_->data[0] = 5;
+    memset(&node_, 0, sizeof(node_));
+    node_.inputs = inputs_;
+    node_.outputs = outputs_;
+    node_.builtin_data = &params_;
+
+    if (std::is_same<InputT, int8_t>::value) {
+      tflite::QuantizeMultiplier(
+          static_cast<double>(quantization.input_scale *
+                              quantization.weights_feature_scale /
+                              quantization.state_scale),
+          &effective_scale_1_a_, &effective_scale_1_b_);
+      tflite::QuantizeMultiplier(
+          static_cast<double>(quantization.state_scale *
+                              quantization.weights_time_scale /
+                              quantization.output_scale),
+          &effective_scale_2_a_, &effective_scale_2_b_);
+    }
+  }
+
+  ~SvdfLayer() {
+    for (TfLiteTensor& tensor : tensors_) {
+      TfLiteIntArrayFree(tensor.dims);
+      if (tensor.quantization.params != nullptr) {
+        auto* params = static_cast<TfLiteAffineQuantization*>(
+            tensor.quantization.params);
+        TfLiteFloatArrayFree(params->scale);
+        TfLiteIntArrayFree(params->zero_point);
+        delete params;
+      }
+    }
+    TfLiteIntArrayFree(inputs_);
+    TfLiteIntArrayFree(outputs_);
+    for (void* buffer : allocations_) {
+      free(buffer);
+    }
+  }
+
+  TfLiteStatus Prepare() {
+    TfLiteRegistration* registration = tflite::ops::micro::Register_SVDF();
+    node_.user_data = registration->init(&context_, nullptr, 0);
+    return registration->prepare(&context_, &node_);
+  }
+
+  TfLiteStatus InvokeKernel() {
+    return tflite::ops::micro::Register_SVDF()->invoke(&context_, &node_);
+  }
+
+  void InvokeShifting();
+
+  void FillInput(uint32_t* state) { Fill(state, &input_); }
+
+  bool OutputsMatch() const {
+    return memcmp(kernel_output_.data(), shifting_output_.data(),
+                  kernel_output_.size() * sizeof(InputT)) == 0;
+  }
+
+  void* Allocate(size_t bytes) {
+    allocations_.push_back(calloc(1, bytes));
+    return allocations_.back();
+  }
+
+  int AddScratchBuffer(size_t bytes) {
+    scratch_buffers_.push_back(Allocate(bytes));
+    return static_cast<int>(scratch_buffers_.size()) - 1;
+  }
+
+  void* ScratchBuffer(int index) const { return scratch_buffers_[index]; }
+
+ private:
+  static constexpr int kTensorCount = 6;
+
+  void FillWeights(uint32_t* state);
+  void Fill(uint32_t* state, std::vector<InputT>* values);
+
+  void SetTensor(int index, TfLiteType type, std::initializer_list<int> dims,
+                 void* data, size_t element_size, float scale,
+                 int zero_point) {
+    TfLiteTensor& tensor = tensors_[index];
+    tensor.type = type;
+    tensor.dims = TfLiteIntArrayCreate(dims.size());
+    int elements = 1;
+    int i = 0;
+    for (int dim : dims) {
+      tensor.dims->data[i++] = dim;
+      elements *= dim;
+    }
+    tensor.data.raw = static_cast<char*>(data);
+    tensor.bytes = elements * element_size;
+    tensor.allocation_type = kTfLiteArenaRw;
+    if (type == kTfLiteFloat32) {
+      return;
+    }
+    tensor.params.scale = scale;
+    tensor.params.zero_point = zero_point;
+    auto* params = new TfLiteAffineQuantization;
+    params->scale = TfLiteFloatArrayCreate(1);
+    params->scale->data[0] = scale;
+    params->zero_point = TfLiteIntArrayCreate(1);
+    params->zero_point->data[0] = zero_point;
+    params->quantized_dimension = 0;
+    tensor.quantization.type = kTfLiteAffineQuantization;
+    tensor.quantization.params = params;
+  }
+
+  // Moves every filter's state left by one column, so the last column is free
+  // for the newest activations.
+  void ShiftState() {
+    const int memory_size = layer_.memory_size;
+    for (int i = 0; i < layer_.batches * num_filters_; ++i) {
+      StateT* filter_state = &shifting_state_[i * memory_size];
+      std::copy(filter_state + 1, filter_state + memory_size, filter_state);
+    }
+  }
+
+  const Layer layer_;
+  const int num_filters_;
+  const Quantization quantization_;
+  std::vector<InputT> input_;
+  std::vector<InputT> weights_feature_;
+  std::vector<WeightsTimeT> weights_time_;
+  std::vector<BiasT> bias_;
+  std::vector<StateT> kernel_state_;
+  std::vector<StateT> shifting_state_;
+  std::vector<InputT> kernel_output_;
+  std::vector<InputT> shifting_output_;
+  int32_t effective_scale_1_a_ = 0;
+  int effective_scale_1_b_ = 0;
+  int32_t effective_scale_2_a_ = 0;
+  int effective_scale_2_b_ = 0;
+
+  TfLiteSVDFParams params_;
+  TfLiteTensor tensors_[kTensorCount];
+  TfLiteIntArray* inputs_;
+  TfLiteIntArray* outputs_;
+  TfLiteContext context_;
+  TfLiteNode node_;
+  std::vector<void*> allocations_;
+  std::vector<void*> scratch_buffers_;
+};
+
+template <>
+void SvdfLayer<float>::Fill(uint32_t* state, std::vector<float>* values) {
+  for (float& value : *values) value = RandomFloat(state, -2.f, 2.f);
+}
+
+template <>
+void SvdfLayer<int8_t>::Fill(uint32_t* state, std::vector<int8_t>* values) {
+  for (int8_t& value : *values) value = RandomInt(state, -128, 127);
+}
+
+template <>
+void SvdfLayer<float>::FillWeights(uint32_t* state) {
+  Fill(state, &weights_feature_);
+  for (float& value : weights_time_) value = RandomFloat(state, -1.f, 1.f);
+  for (float& value : bias_) value = RandomFloat(state, -1.f, 1.f);
+}
+
+template <>
+void SvdfLayer<int8_t>::FillWeights(uint32_t* state) {
+  for (int8_t& value : weights_feature_) value = RandomInt(state, -127, 127);
+  // Small enough that the sums over the memory and the rank fit in 32 bits.
+  for (int16_t& value : weights_time_) value = RandomInt(state, -512, 512);
+  for (int32_t& value : bias_) value = RandomInt(state, -20000, 20000);
+}
+
+// The float SVDF with a shifted state, in the same order of operations as
+// the kernel, so the sums are rounded the same way.
+template <>
+void SvdfLayer<float>::InvokeShifting() {
+  const int memory_size = layer_.memory_size;
+  ShiftState();
+  for (int b = 0; b < layer_.batches; ++b) {
+    const float* batch_input = &input_[b * layer_.input_size];
+    for (int f = 0; f < num_filters_; ++f) {
+      const float* filter = &weights_feature_[f * layer_.input_size];
+      float dot_product = 0.0f;
+      for (int i = 0; i < layer_.input_size; ++i) {
+        dot_product += filter[i] * batch_input[i];
+      }
+      shifting_state_[(b * num_filters_ + f) * memory_size + memory_size -
+                      1] = dot_product;
+    }
+  }
+
+  for (int b = 0; b < layer_.batches; ++b) {
+    float* batch_output = &shifting_output_[b * layer_.num_units];
+    for (int u = 0; u < layer_.num_units; ++u) {
+      batch_output[u] = bias_.empty() ? 0.0f : bias_[u];
+    }
+    for (int f = 0; f < num_filters_; ++f) {
+      const float* time_weights = &weights_time_[f * memory_size];
+      const float* filter_state =
+          &shifting_state_[(b * num_filters_ + f) * memory_size];
+      float dot_product = 0.0f;
+      for (int j = 0; j < memory_size; ++j) {
+        dot_product += time_weights[j] * filter_state[j];
+      }
+      batch_output[f / layer_.rank] += dot_product;
+    }
+    for (int u = 0; u < layer_.num_units; ++u) {
+      batch_output[u] =
+          tflite::ops::micro::ActivationValFloat(params_.activation,
+                                                 batch_output[u]);
+    }
+  }
+}
+
+// The int8 SVDF with a shifted state. Like the kernel, it clamps the output
+// to int8 but applies no other activation.
+template <>
+void SvdfLayer<int8_t>::InvokeShifting() {
+  const int memory_size = layer_.memory_size;
+  ShiftState();
+  for (int b = 0; b < layer_.batches; ++b) {
+    const int8_t* batch_input = &input_[b * layer_.input_size];
+    for (int f = 0; f < num_filters_; ++f) {
+      const int8_t* filter = &weights_feature_[f * layer_.input_size];
+      int32_t dot_product = 0;
+      for (int i = 0; i < layer_.input_size; ++i) {
+        dot_product +=
+            filter[i] * (batch_input[i] - quantization_.input_zero_point);
+      }
+      dot_product = tflite::MultiplyByQuantizedMultiplier(
+          dot_product, effective_scale_1_a_, effective_scale_1_b_);
+      dot_product = std::min<int32_t>(
+          std::max<int32_t>(dot_product, std::numeric_limits<int16_t>::min()),
+          std::numeric_limits<int16_t>::max());
+      shifting_state_[(b * num_filters_ + f) * memory_size + memory_size -
+                      1] = dot_product;
+    }
+  }
+
+  std::vector<int32_t> sums(layer_.num_units);
+  for (int b = 0; b < layer_.batches; ++b) {
+    for (int u = 0; u < layer_.num_units; ++u) {
+      sums[u] = bias_.empty() ? 0 : bias_[u];
+    }
+    for (int f = 0; f < num_filters_; ++f) {
+      const int16_t* time_weights = &weights_time_[f * memory_size];
+      const int16_t* filter_state =
+          &shifting_state_[(b * num_filters_ + f) * memory_size];
+      int32_t dot_product = 0;
+      for (int j = 0; j < memory_size; ++j) {
+        dot_product += time_weights[j] * filter_state[j];
+      }
+      sums[f / layer_.rank] += dot_product;
+    }
+    for (int u = 0; u < layer_.num_units; ++u) {
+      const int32_t output =
+          tflite::MultiplyByQuantizedMultiplier(
+              sums[u], effective_scale_2_a_, effective_scale_2_b_) +
+          quantization_.output_zero_point;
+      shifting_output_[b * layer_.num_units + u] = std::min<int32_t>(
+          std::max<int32_t>(output, std::numeric_limits<int8_t>::min()),
+          std::numeric_limits<int8_t>::max());
+    }
+  }
+}
+
+template <typename InputT>
+SvdfLayer<InputT>* LayerOf(TfLiteContext* context) {
+  return static_cast<SvdfLayer<InputT>*>(context->impl_);
+}
+
+// The callbacks only need the buffers of the layer, whose type is known from
+// the tensors.
+TfLiteStatus AllocatePersistentBuffer(TfLiteContext* context, size_t bytes,
+                                      void** ptr) {
+  *ptr = context->tensors[0].type == kTfLiteFloat32
+             ? LayerOf<float>(context)->Allocate(bytes)
+             : LayerOf<int8_t>(context)->Allocate(bytes);
+  return *ptr != nullptr ? kTfLiteOk : kTfLiteError;
+}
+
+TfLiteStatus RequestScratchBufferInArena(TfLiteContext* context, size_t bytes,
+                                         int* buffer_idx) {
+  *buffer_idx = context->tensors[0].type == kTfLiteFloat32
+                    ? LayerOf<float>(context)->AddScratchBuffer(bytes)
+                    : LayerOf<int8_t>(context)->AddScratchBuffer(bytes);
+  return kTfLiteOk;
+}
+
+void* GetScratchBuffer(TfLiteContext* context, int buffer_idx) {
+  return context->tensors[0].type == kTfLiteFloat32
+             ? LayerOf<float>(context)->ScratchBuffer(buffer_idx)
+             : LayerOf<int8_t>(context)->ScratchBuffer(buffer_idx);
+}
+
+void ReportError(TfLiteContext* context, const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fprintf(stderr, "\n");
+}
+
+// Random int8 quantization whose effective scales keep most of the state and
+// the outputs in range.
+Quantization RandomQuantization(uint32_t* state, const Layer& layer) {
+  Quantization quantization;
+  quantization.input_scale = RandomFloat(state, 0.01f, 0.1f);
+  quantization.weights_feature_scale = RandomFloat(state, 0.005f, 0.05f);
+  quantization.weights_time_scale = RandomFloat(state, 0.0001f, 0.001f);
+  quantization.input_zero_point = RandomInt(state, -128, 127);
+  quantization.output_zero_point = RandomInt(state, -128, 127);
+  quantization.state_scale = quantization.input_scale *
+                             quantization.weights_feature_scale *
+                             layer.input_size * RandomInt(state, 1, 64);
+  quantization.output_scale = quantization.state_scale *
+                              quantization.weights_time_scale *
+                              layer.memory_size * layer.rank *
+                              RandomInt(state, 64, 1024);
+  return quantization;
+}
+
+// Runs `layer` for a few times its memory size with random inputs and
+// returns whether all the outputs were equal.
+template <typename InputT>
+bool OutputsMatch(uint32_t* state, SvdfLayer<InputT>* layer,
+                  int memory_size) {
+  bool all_equal = true;
+  for (int step = 0; step < 3 * memory_size + 5; ++step) {
+    layer->FillInput(state);
+    layer->InvokeKernel();
+    layer->InvokeShifting();
+    all_equal = all_equal && layer->OutputsMatch();
+  }
+  return all_equal;
+}
+
+// Times both versions of `layer` and checks their outputs. Returns false if
+// they differ.
+template <typename InputT>
+bool TimeLayer(uint32_t* state, const char* type_name, const Layer& layer,
+               const Quantization& quantization) {
+  SvdfLayer<InputT> data(state, layer, /*has_bias=*/true, kTfLiteActRelu,
+                         quantization);
+  if (data.Prepare() != kTfLiteOk) {
+    return false;
+  }
+  data.FillInput(state);
+  const double shifting_us = Measure([&]() { data.InvokeShifting(); });
+  const double ring_us = Measure([&]() { data.InvokeKernel(); });
+
+  char name[48];
+  snprintf(name, sizeof(name), "%s %dx%dx%d", type_name, layer.input_size,
+           layer.num_units * layer.rank, layer.memory_size);
+  printf("%16s %16.3f %16.3f %7.2fx\n", name, shifting_us, ring_us,
+         shifting_us / ring_us);
+
+  // The timing runs left the states apart, start over.
+  SvdfLayer<InputT> fresh(state, layer, /*has_bias=*/true, kTfLiteActRelu,
+                          quantization);
+  if (fresh.Prepare() != kTfLiteOk ||
+      !OutputsMatch(state, &fresh, layer.memory_size)) {
+    fprintf(stderr, "The outputs differ for %s\n", name);
+    return false;
+  }
+  return true;
+}
+
+template <typename InputT>
+bool CheckRandomLayer(uint32_t* state) {
+  Layer layer;
+  layer.batches = RandomInt(state, 1, 3);
+  layer.input_size = RandomInt(state, 1, 40);
+  layer.num_units = RandomInt(state, 1, 8);
+  layer.rank = RandomInt(state, 1, 3);
+  layer.memory_size = RandomInt(state, 1, 16);
+  const bool has_bias = NextRandom(state) % 2;
+  static constexpr TfLiteFusedActivation kActivations[] = {
+      kTfLiteActNone, kTfLiteActRelu, kTfLiteActRelu6};
+  // The int8 kernel only supports RELU.
+  const TfLiteFusedActivation activation =
+      std::is_same<InputT, int8_t>::value ? kTfLiteActRelu
+                                          : kActivations[NextRandom(state) % 3];
+  const Quantization quantization = RandomQuantization(state, layer);
+
+  SvdfLayer<InputT> data(state, layer, has_bias, activation, quantization);
+  if (data.Prepare() != kTfLiteOk ||
+      !OutputsMatch(state, &data, layer.memory_size)) {
+    fprintf(stderr,
+            "The outputs differ for %d batches, input %d, %d units of rank "
+            "%d, memory %d\n",
+            layer.batches, layer.input_size, layer.num_units, layer.rank,
+            layer.memory_size);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int cases = 1000;
+  uint32_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (const char* value = tflite::tools::FlagValue(argv[i], "cases")) {
+      cases = atoi(value);
+    } else if (const char* value = tflite::tools::FlagValue(argv[i], "seed")) {
+      seed = strtoul(value, nullptr, 10);
+    } else {
+      fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  printf("%16s %16s %16s %8s\n", "layer", "shifting (us)", "ring (us)",
+         "speedup");
+  bool all_equal = true;
+  uint32_t state = seed;
+  for (const Layer& layer : kLayers) {
+    all_equal = TimeLayer<float>(&state, "float", layer, Quantization()) &&
+                all_equal;
+  }
+  for (const Layer& layer : kLayers) {
+    const Quantization quantization = RandomQuantization(&state, layer);
+    all_equal =
+        TimeLayer<int8_t>(&state, "int8", layer, quantization) && all_equal;
+  }
+
+  int mismatches = 0;
+  for (int i = 0; i < cases; ++i) {
+    if (!CheckRandomLayer<float>(&state)) ++mismatches;
+    if (!CheckRandomLayer<int8_t>(&state)) ++mismatches;
+  }
+  printf("%d random layers, %d with different outputs\n", 2 * cases,
+         mismatches);
+  return all_equal && mismatches == 0 ? 0 : 1;
+}